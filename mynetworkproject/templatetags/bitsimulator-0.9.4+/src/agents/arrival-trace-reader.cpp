@@ -0,0 +1,174 @@
+/*
+ * Copyright (C) 2017-2019 Dominique Dhoutaut, Thierry Arrabal, Eugen Dedu.
+ *
+ * This file is part of BitSimulator.
+ *
+ * BitSimulator is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * BitSimulator is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with BitSimulator.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "arrival-trace-reader.h"
+
+
+//==============================================================================
+//
+//          ArrivalTraceReader  (class)
+//
+//==============================================================================
+
+const char ArrivalTraceReader::BINARY_MAGIC[8] = {'B','S','T','R','A','C','E','1'};
+
+typedef struct __attribute__((packed)) {
+  int64_t time;
+  int32_t srcId;
+  int32_t dstId;
+  int32_t size;
+  int32_t beta;
+} BinaryTraceRecord_t;
+
+ArrivalTraceReader::ArrivalTraceReader(string _fileName) {
+  fileName = _fileName;
+  data = nullptr;
+  length = 0;
+  position = 0;
+  lineNumber = 0;
+  lastTime = 0;
+
+  fd = open(fileName.c_str(), O_RDONLY);
+  struct stat st;
+  if (fd < 0 || fstat(fd, &st) != 0) {
+    cerr << "*** ERROR *** cannot open arrival trace " << fileName << ": " << strerror(errno) << endl;
+    exit(EXIT_FAILURE);
+  }
+  length = st.st_size;
+  if (length > 0) {
+    void *map = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (map == MAP_FAILED) {
+      cerr << "*** ERROR *** cannot map arrival trace " << fileName << ": " << strerror(errno) << endl;
+      exit(EXIT_FAILURE);
+    }
+    madvise(map, length, MADV_SEQUENTIAL);
+    data = (const char *)map;
+  }
+
+  binary = length >= sizeof(BINARY_MAGIC) && memcmp(data, BINARY_MAGIC, sizeof(BINARY_MAGIC)) == 0;
+  if (binary) {
+    position = sizeof(BINARY_MAGIC);
+    if ((length - position) % sizeof(BinaryTraceRecord_t) != 0)
+      formatError("truncated binary record");
+  }
+}
+
+ArrivalTraceReader::~ArrivalTraceReader() {
+  if (data != nullptr)
+    munmap((void *)data, length);
+  if (fd >= 0)
+    close(fd);
+}
+
+void ArrivalTraceReader::formatError(string _message) {
+  cerr << "*** ERROR *** arrival trace " << fileName;
+  if (!binary)
+    cerr << " line " << lineNumber;
+  cerr << ": " << _message << endl;
+  exit(EXIT_FAILURE);
+}
+
+bool ArrivalTraceReader::next(TraceArrival_t &_arrival) {
+  if (!(binary ? nextBinary(_arrival) : nextCSV(_arrival)))
+    return false;
+  if (_arrival.time < lastTime)
+    formatError("arrivals are not sorted by time");
+  lastTime = _arrival.time;
+  return true;
+}
+
+bool ArrivalTraceReader::nextBinary(TraceArrival_t &_arrival) {
+  if (position >= length)
+    return false;
+  BinaryTraceRecord_t record;
+  memcpy(&record, data + position, sizeof(record));
+  position += sizeof(record);
+
+  _arrival.time = record.time;
+  _arrival.srcId = record.srcId;
+  _arrival.dstId = record.dstId;
+  _arrival.size = record.size;
+  _arrival.beta = record.beta;
+  return true;
+}
+
+// Parses an integer followed by a comma, the end of the line or of the file
+bool ArrivalTraceReader::parseField(const char *&_p, const char *_end, long long &_value) {
+  while (_p < _end && (*_p == ' ' || *_p == '\t'))
+    _p++;
+  bool negative = (_p < _end && *_p == '-');
+  if (negative)
+    _p++;
+  if (_p >= _end || *_p < '0' || *_p > '9')
+    return false;
+  _value = 0;
+  while (_p < _end && *_p >= '0' && *_p <= '9')
+    _value = 10 * _value + (*_p++ - '0');
+  if (negative)
+    _value = -_value;
+  while (_p < _end && (*_p == ' ' || *_p == '\t' || *_p == '\r'))
+    _p++;
+  if (_p < _end && *_p == ',')
+    _p++;
+  else if (_p < _end && *_p != '\n')
+    return false;
+  return true;
+}
+
+bool ArrivalTraceReader::nextCSV(TraceArrival_t &_arrival) {
+  while (position < length) {
+    const char *p = data + position;
+    const char *end = (const char *)memchr(p, '\n', length - position);
+    if (end == nullptr)
+      end = data + length;
+    position = end - data + 1;
+    lineNumber++;
+
+    const char *q = p;
+    while (q < end && (*q == ' ' || *q == '\t' || *q == '\r'))
+      q++;
+    if (q == end || *q == '#')
+      continue;
+    if (lineNumber == 1 && (*q < '0' || *q > '9') && *q != '-')
+      continue;  // header
+
+    long long fields[5];
+    for (int i = 0; i < 5; i++) {
+      if (!parseField(p, end, fields[i]))
+        formatError("expected \"time_fs,srcId,dstId,size,beta\"");
+    }
+    if (p < end)
+      formatError("too many fields");
+
+    _arrival.time = fields[0];
+    _arrival.srcId = fields[1];
+    _arrival.dstId = fields[2];
+    _arrival.size = fields[3];
+    _arrival.beta = fields[4];
+    return true;
+  }
+  return false;
+}
@@ -0,0 +1,82 @@
+/*
+ * Copyright (C) 2017-2019 Dominique Dhoutaut, Thierry Arrabal, Eugen Dedu.
+ *
+ * This file is part of BitSimulator.
+ *
+ * BitSimulator is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * BitSimulator is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with BitSimulator.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef AGENTS_ARRIVAL_TRACE_READER_H_
+#define AGENTS_ARRIVAL_TRACE_READER_H_
+
+#include <cstdint>
+#include <string>
+
+#include "utils.h"
+
+using namespace std;
+
+typedef struct {
+  simulationTime_t time;  // fs, from the start of the trace
+  int srcId;
+  int dstId;              // -1 for broadcast
+  int size;
+  int beta;               // 0 for the default beta
+} TraceArrival_t;
+
+
+//===========================================================================================================
+//
+//          ArrivalTraceReader  (class)
+//
+//===========================================================================================================
+
+// Sequential reader of a packet arrival trace, sorted by time.  The file is
+// mapped in memory and decoded one record at a time, so only the current
+// position is kept whatever the size of the trace.
+//
+// Two formats are accepted:
+// - CSV: one "time_fs,srcId,dstId,size,beta" line per arrival; empty lines,
+//   lines starting with '#' and a non numerical header line are skipped
+// - binary: the 8 bytes "BSTRACE1" followed by packed records of one int64
+//   (time_fs) and four int32 (srcId, dstId, size, beta), in host byte order
+
+class ArrivalTraceReader {
+private:
+  string fileName;
+  int fd;
+  const char *data;
+  size_t length;
+  size_t position;
+  bool binary;
+  long lineNumber;
+  simulationTime_t lastTime;
+
+  bool nextBinary(TraceArrival_t &_arrival);
+  bool nextCSV(TraceArrival_t &_arrival);
+  bool parseField(const char *&_p, const char *_end, long long &_value);
+  void formatError(string _message);
+
+public:
+  static const char BINARY_MAGIC[8];
+
+  ArrivalTraceReader(string _fileName);
+  ~ArrivalTraceReader();
+
+  // false at the end of the trace; exits on a malformed or unsorted trace
+  bool next(TraceArrival_t &_arrival);
+};
+
+
+#endif /* AGENTS_ARRIVAL_TRACE_READER_H_ */
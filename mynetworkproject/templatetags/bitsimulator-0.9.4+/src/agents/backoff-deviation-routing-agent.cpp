@@ -22,6 +22,7 @@
 #include "world.h"
 #include "utils.h"
 #include "backoff-deviation-routing-agent.h"
+#include "slr-coordinates-cache.h"
 
 
 int PACKETSEND =0;
@@ -40,7 +41,6 @@ using BackoffDeviationSendEvent = CallMethodArgEvent<BackoffDeviationRoutingAgen
   EventType::BACKOFF_DEVIATION_DELAYED_SEND_EVENT>;
 
 
-mt19937_64 BackoffDeviationRoutingAgent::forwardDelayRnd(9004);
 ofstream BackoffDeviationRoutingAgent::slrPositionsFile;
 int BackoffDeviationRoutingAgent::redundancy(1);
 int BackoffDeviationRoutingAgent::deviateThresh(0.5);
@@ -93,7 +93,12 @@ BackoffDeviationRoutingAgent::BackoffDeviationRoutingAgent(Node* host)
     }
   }
 
-  if (iAmAnchor && host->getId() == 0) {
+  // cached coordinates: no beacon phase, anchors must not start one either
+  if (SLRCoordinatesCache::lookup(host->getId(), slrx, slry, slrz)) {
+    beaconPhaseStarted = true;
+  }
+
+  if (iAmAnchor && host->getId() == 0 && !beaconPhaseStarted) {
     auto startTime = Scheduler::now() + 4e11;
     Scheduler::getScheduler().schedule(
       new StartPropagationPhaseEvent(startTime, this));
@@ -106,6 +111,7 @@ BackoffDeviationRoutingAgent::~BackoffDeviationRoutingAgent() {
     slrPositionsFile << hostNode->getId() << " " << slrx << " " << slry <<
       " " << slrz << endl;
   }
+  SLRCoordinatesCache::store(hostNode->getId(), slrx, slry, slrz);
 
 
   cout << " PACKETSEND " << PACKETSEND << endl;
@@ -245,11 +251,9 @@ void BackoffDeviationRoutingAgent::receivePacketFromNetwork(PacketPtr packet) {
     //bool slrForward = shouldSlrForward(packet, packet->deviation);
     bool slrForward = shouldSlrForward(packet, packet->deviation) && !shouldSlrForward(packet, (packet->deviation)-1) ;
 
-    auto v = alreadyForwardedPackets;
-    std::pair<int,int> flowIdent(packet->flowId, packet->flowSequenceNumber);
-    bool alreadyForwarded = std::find(v.begin(), v.end(), flowIdent) != v.end();
+    bool alreadyForwarded = alreadyForwardedPackets.contains(packet->flowId, packet->flowSequenceNumber);
     if (!alreadyForwarded) {
-      alreadyForwardedPackets.push_back(flowIdent);
+      alreadyForwardedPackets.insert(packet->flowId, packet->flowSequenceNumber);
     }
 
     bool forward = slrForward && !alreadyForwarded;
@@ -291,6 +295,7 @@ void BackoffDeviationRoutingAgent::resendPacket(PacketPtr packet, bool inBeaconP
     ScenarioParameters::getCommunicationRange() / PROPAGATIONSPEED);
 
   uniform_int_distribution<unsigned int> backoffDist(0, backoffWindow);
+  CounterRNG forwardDelayRnd = getForwardingRNG(forwardDelayRNGSeed);
   simulationTime_t backoffDelay = backoffDist(forwardDelayRnd);
 
   delayedPackets[fwdPacket->packetId] = { fwdPacket, 1 };
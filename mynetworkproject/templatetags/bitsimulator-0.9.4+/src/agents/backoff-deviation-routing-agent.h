@@ -43,7 +43,7 @@ public:
 
 private:
   static ofstream slrPositionsFile;
-  static mt19937_64 forwardDelayRnd;
+  static const int forwardDelayRNGSeed = 9004;
 
   static int redundancy;
   static int deviateThresh;
@@ -55,9 +55,7 @@ private:
   // store packetID -> (packet, backoffCount)
   map<int, std::pair<PacketPtr, int>> delayedPackets;
 
-  // note: this is rather unrealistic, in that it stores much more
-  // than probably possible for nanobots.
-  vector<std::pair<int,int>> alreadyForwardedPackets;
+  DuplicateFilter alreadyForwardedPackets;
 
   bool slrUpdate(PacketPtr packet);
   bool shouldSlrForward(PacketPtr packet, int m);
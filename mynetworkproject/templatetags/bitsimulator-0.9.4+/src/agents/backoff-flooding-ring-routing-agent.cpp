@@ -27,7 +27,6 @@
 //
 //==============================================================================
 set<int> BackoffFloodingRingRoutingAgent::reachability = set<int>();
-mt19937_64 *BackoffFloodingRingRoutingAgent::forwardingRNG;
 int BackoffFloodingRingRoutingAgent::redundancy;
 float BackoffFloodingRingRoutingAgent::dataBackoffMultiplier;
 
@@ -59,7 +58,6 @@ BackoffFloodingRingRoutingAgent::~BackoffFloodingRingRoutingAgent () {
 }
 
 void BackoffFloodingRingRoutingAgent::initializeAgent() {
-  forwardingRNG =  new mt19937_64(ScenarioParameters::getBackoffFloodingRNGSeed());
   redundancy = ScenarioParameters::getSlrBackoffredundancy();
   dataBackoffMultiplier = ScenarioParameters::getSlrBackoffMultiplier();
 }
@@ -111,16 +109,14 @@ void BackoffFloodingRingRoutingAgent::receivePacketFromNetwork(PacketPtr _packet
   // Also further copies of this packet will not be retransmitted either, as
   // alreadySeen list should prevent it.
   //
-  for (auto it = waitingPacket.begin(); it!=waitingPacket.end();it++){
-    if ( (it->second.p)->flowId == _packet->flowId && (it->second.p)->flowSequenceNumber == _packet->flowSequenceNumber) {
-      if (_packet->type == PacketType::DATA && it->second.counter >= 2){ //redundancy
-        it = waitingPacket.erase(it);
-        // erasedPackets=true;
-        // LogSystem::EventsLogOutput.log( LogSystem::memoryTrace, Scheduler::now(),hostNode->getId(),"-",_packet->flowId,_packet->flowSequenceNumber);
-      } else {
-        it->second.counter++;
-      }
-      break;
+  PendingForwards::PendingForward_t *pending = waitingPacket.findByFlow(_packet->flowId, _packet->flowSequenceNumber);
+  if (pending != nullptr) {
+    if (_packet->type == PacketType::DATA && pending->counter >= 2){ //redundancy
+      waitingPacket.erase(pending->p->packetId);
+      // erasedPackets=true;
+      // LogSystem::EventsLogOutput.log( LogSystem::memoryTrace, Scheduler::now(),hostNode->getId(),"-",_packet->flowId,_packet->flowSequenceNumber);
+    } else {
+      pending->counter++;
     }
   }
   simulationTime_t effectiveBackoffWindow = 2*((Node::getPulseDuration() * _packet->beta * (_packet->size-1) + Node::getPulseDuration()) + ScenarioParameters::getCommunicationRange()/300 );
@@ -133,27 +129,15 @@ void BackoffFloodingRingRoutingAgent::receivePacketFromNetwork(PacketPtr _packet
     effectiveBackoffWindow *= dataBackoffMultiplier;
   }
   uniform_int_distribution<time_t> distrib(0, effectiveBackoffWindow);
-  simulationTime_t backoffTime = distrib(*forwardingRNG);
+  CounterRNG forwardingRNG = getForwardingRNG(ScenarioParameters::getBackoffFloodingRNGSeed());
+  simulationTime_t backoffTime = distrib(forwardingRNG);
 
   bool fw = false;
-  auto srcIt = alreadySeenPackets.find(_packet->flowId);
-  if (srcIt != alreadySeenPackets.end()) {
-    // I already received a packet from this source
-    if (_packet->flowSequenceNumber > srcIt->second && _packet->type == PacketType::DATA) {
-        // The source sequence number of this packet is higher than the highest already seen from this source.
-        // I will update my data and forward this packet
-        srcIt->second = _packet->flowSequenceNumber;
-        fw = true;
-      }
-    
-  } else {
-    // First time I receive a packet from this source
-    // I will forward this packet
-    //
-    if (_packet->type == PacketType::DATA) {
-      alreadySeenPackets.insert(pair<int,int>(_packet->flowId, _packet->flowSequenceNumber));
-      fw = true;
-    }
+  // First time I receive a packet from this flow, or its sequence number is
+  // higher than the highest already seen: I will forward this packet
+  if (alreadySeenPackets.isNewer(_packet->flowId, _packet->flowSequenceNumber) && _packet->type == PacketType::DATA) {
+    alreadySeenPackets.insert(_packet->flowId, _packet->flowSequenceNumber);
+    fw = true;
   }
 
  if (_packet->type == PacketType::CONTROL_1 || _packet->type == PacketType::CONTROL_2) {
@@ -197,12 +181,8 @@ void BackoffFloodingRingRoutingAgent::receivePacketFromNetwork(PacketPtr _packet
         nodeIt->second.control2 = true;
       } else if ( nodeIt->second.control1 && !nodeIt->second.control2 ) {
         PacketPtr packetClone(_packet->clone());
-        struct backoffRoutingCounter info;
-        info.p = packetClone;
-        info.counter = 1;
-        waitingPacket.insert(pair<int,backoffRoutingCounter>(packetClone->packetId,info));
+        waitingPacket.insert(packetClone, Scheduler::getScheduler().schedule(new backoffRingSendingEvent(Scheduler::now() + backoffTime, hostNode,packetClone->packetId)));
         //             insertedPackets = true;
-        Scheduler::getScheduler().schedule(new backoffRingSendingEvent(Scheduler::now() + backoffTime, hostNode,packetClone->packetId));
         //             LogSystem::EventsLogOutput.log( LogSystem::memoryTrace, Scheduler::now(),hostNode->getId(),"+",_packet->flowId,_packet->flowSequenceNumber);
       }
     }
@@ -232,14 +212,14 @@ void BackoffFloodingRingRoutingAgent::receivePacketFromApplication(PacketPtr _pa
 
 
 void BackoffFloodingRingRoutingAgent::processBackoffSending(int packetId){
-  auto it = waitingPacket.find(packetId);
-  if ( it != waitingPacket.end() && it->second.p->type == PacketType::DATA ) {
+  PendingForwards::PendingForward_t *pending = waitingPacket.find(packetId);
+  if ( pending != nullptr && pending->p->type == PacketType::DATA ) {
     //
     // if the packet is still in the waiting list
     // i.e. I have not see more than REDUNDANCY copies
     // then I send it now
     //
-    //cout << " ++ forward seq " << it->second.p->flowSequenceNumber << " by node " << hostNode->getId()<< " at " << Scheduler::getScheduler().now() << endl;
+    //cout << " ++ forward seq " << pending->p->flowSequenceNumber << " by node " << hostNode->getId()<< " at " << Scheduler::getScheduler().now() << endl;
 
     if (!alreadySent1and2) { //1 and 2 before the very first data transmission
       PacketPtr control1(new Packet(PacketType::CONTROL_1, 101,hostNode->getId(),-1,-1,-1,-1));
@@ -254,12 +234,12 @@ void BackoffFloodingRingRoutingAgent::processBackoffSending(int packetId){
       alreadySent1and2 = true;
     }
 
-    hostNode->enqueueOutgoingPacket(it->second.p);
-    LogSystem::EventsLogOutput.log( LogSystem::routingSND, Scheduler::now(),hostNode->getId(),(int) it->second.p->type,it->second.p->flowId,it->second.p->flowSequenceNumber);
-//         LogSystem::EventsLogOutput.log( LogSystem::memoryTrace, Scheduler::now(),hostNode->getId(),"-",it->second.p->flowId,it->second.p->flowSequenceNumber);
+    hostNode->enqueueOutgoingPacket(pending->p);
+    LogSystem::EventsLogOutput.log( LogSystem::routingSND, Scheduler::now(),hostNode->getId(),(int) pending->p->type,pending->p->flowId,pending->p->flowSequenceNumber);
+//         LogSystem::EventsLogOutput.log( LogSystem::memoryTrace, Scheduler::now(),hostNode->getId(),"-",pending->p->flowId,pending->p->flowSequenceNumber);
 
     forwardedDataPackets++;
-    waitingPacket.erase(it);
+    waitingPacket.erase(packetId);
     //       string filename = ScenarioParameters::getScenarioDirectory()+"/dataSent.data";
     //       ofstream dataSent(filename,std::ofstream::app);
     //       dataSent<< ScenarioParameters::getDefaultBeta() << " " <<hostNode->getId() << " "<< Scheduler::now() << endl;
@@ -27,7 +27,6 @@
 //
 //==============================================================================
 set<int> BackoffFloodingRoutingAgent::reachability = set<int>();
-mt19937_64 *BackoffFloodingRoutingAgent::forwardingRNG;
 int BackoffFloodingRoutingAgent::redundancy;
 float BackoffFloodingRoutingAgent::dataBackoffMultiplier;
 
@@ -54,7 +53,6 @@ BackoffFloodingRoutingAgent::~BackoffFloodingRoutingAgent () {
 }
 
 void BackoffFloodingRoutingAgent::initializeAgent() {
-  forwardingRNG =  new mt19937_64(ScenarioParameters::getBackoffFloodingRNGSeed());
   redundancy = ScenarioParameters::getSlrBackoffredundancy();
   dataBackoffMultiplier = ScenarioParameters::getSlrBackoffMultiplier();
 }
@@ -101,16 +99,14 @@ void BackoffFloodingRoutingAgent::receivePacketFromNetwork(PacketPtr _packet){
   // Also further copies of this packet will not be retransmitted either, as
   // alreadySeen list should prevent it.
   //
-  for (auto it = waitingPacket.begin(); it!=waitingPacket.end();it++){
-    if ( (it->second.p)->flowId == _packet->flowId && (it->second.p)->flowSequenceNumber == _packet->flowSequenceNumber) {
-      if (_packet->type == PacketType::DATA && it->second.counter >= 2){ //redundancy
-        it = waitingPacket.erase(it);
-        // erasedPackets=true;
-        // LogSystem::EventsLogOutput.log( LogSystem::memoryTrace, Scheduler::now(),hostNode->getId(),"-",_packet->flowId,_packet->flowSequenceNumber);
-      } else {
-        it->second.counter++;
-      }
-      break;
+  PendingForwards::PendingForward_t *pending = waitingPacket.findByFlow(_packet->flowId, _packet->flowSequenceNumber);
+  if (pending != nullptr) {
+    if (_packet->type == PacketType::DATA && pending->counter >= 2){ //redundancy
+      waitingPacket.erase(pending->p->packetId);
+      // erasedPackets=true;
+      // LogSystem::EventsLogOutput.log( LogSystem::memoryTrace, Scheduler::now(),hostNode->getId(),"-",_packet->flowId,_packet->flowSequenceNumber);
+    } else {
+      pending->counter++;
     }
   }
   simulationTime_t effectiveBackoffWindow = 2*((Node::getPulseDuration() * _packet->beta * (_packet->size-1) + Node::getPulseDuration()) + ScenarioParameters::getCommunicationRange()/300 );
@@ -123,42 +119,17 @@ void BackoffFloodingRoutingAgent::receivePacketFromNetwork(PacketPtr _packet){
     effectiveBackoffWindow *= dataBackoffMultiplier;
   }
   uniform_int_distribution<time_t> distrib(0, effectiveBackoffWindow);
-  simulationTime_t backoffTime = distrib(*forwardingRNG);
-
-  auto srcIt = alreadySeenPackets.find(_packet->flowId);
-  if (srcIt != alreadySeenPackets.end()) {
-    // I already received a packet from this source
-    if (_packet->flowSequenceNumber > srcIt->second && _packet->type == PacketType::DATA) {
-      // The source sequence number of this packet is higher than the highest already seen from this source.
-      // I will update my data and forward this packet
-
-      srcIt->second = _packet->flowSequenceNumber;
-
-      PacketPtr packetClone(_packet->clone());
-      struct backoffRoutingCounter info;
-      info.p = packetClone;
-      info.counter = 1;
-      waitingPacket.insert(pair<int,backoffRoutingCounter>(packetClone->packetId,info));
-      //             insertedPackets = true;
-      Scheduler::getScheduler().schedule(new backoffSendingEvent(Scheduler::now() + backoffTime, hostNode,packetClone->packetId));
-//             LogSystem::EventsLogOutput.log( LogSystem::memoryTrace, Scheduler::now(),hostNode->getId(),"+",_packet->flowId,_packet->flowSequenceNumber);
-    }
-  } else {
-    // First time I receive a packet from this source
-    // I will forward this packet
-    //
-    if (_packet->type == PacketType::DATA) {
-      alreadySeenPackets.insert(pair<int,int>(_packet->flowId, _packet->flowSequenceNumber));
-      PacketPtr packetClone(_packet->clone());
-      struct backoffRoutingCounter info;
-      info.p = packetClone;
-      info.counter = 1;
-      waitingPacket.insert(pair<int,backoffRoutingCounter>(packetClone->packetId,info));
-      //             insertedPackets=true;
-      //             cout << " node id " << hostNode->getId() << endl;
-      Scheduler::getScheduler().schedule(new backoffSendingEvent(Scheduler::now() + backoffTime, hostNode,packetClone->packetId));
-//             LogSystem::EventsLogOutput.log( LogSystem::memoryTrace, Scheduler::now(),hostNode->getId(),"+",_packet->flowId,_packet->flowSequenceNumber);
-    }
+  CounterRNG forwardingRNG = getForwardingRNG(ScenarioParameters::getBackoffFloodingRNGSeed());
+  simulationTime_t backoffTime = distrib(forwardingRNG);
+
+  // First time I receive a packet from this flow, or its sequence number is
+  // higher than the highest already seen: I will forward this packet
+  if (alreadySeenPackets.isNewer(_packet->flowId, _packet->flowSequenceNumber) && _packet->type == PacketType::DATA) {
+    alreadySeenPackets.insert(_packet->flowId, _packet->flowSequenceNumber);
+
+    PacketPtr packetClone(_packet->clone());
+    waitingPacket.insert(packetClone, Scheduler::getScheduler().schedule(new backoffSendingEvent(Scheduler::now() + backoffTime, hostNode,packetClone->packetId)));
+//           LogSystem::EventsLogOutput.log( LogSystem::memoryTrace, Scheduler::now(),hostNode->getId(),"+",_packet->flowId,_packet->flowSequenceNumber);
   }
 
 
@@ -184,30 +155,27 @@ void BackoffFloodingRoutingAgent::receivePacketFromApplication(PacketPtr _packet
   if (_packet->type == PacketType::D1_DENSITY_INIT){
   }
 
-  auto srcIt = alreadySeenPackets.find(_packet->srcId);   // source must not resend the packet
-  if (srcIt != alreadySeenPackets.end()  && _packet->type == PacketType::DATA) {
-    srcIt->second = _packet->srcSequenceNumber;
-  } else if (_packet->type == PacketType::DATA){
-    alreadySeenPackets.insert(pair<int,int>(_packet->srcId, _packet->srcSequenceNumber));
+  if (_packet->type == PacketType::DATA) {   // source must not resend the packet
+    alreadySeenPackets.insert(_packet->srcId, _packet->srcSequenceNumber);
   }
 }
 
 
 void BackoffFloodingRoutingAgent::processBackoffSending(int packetId){
-  auto it = waitingPacket.find(packetId);
-  if ( it != waitingPacket.end() && it->second.p->type == PacketType::DATA ) {
+  PendingForwards::PendingForward_t *pending = waitingPacket.find(packetId);
+  if ( pending != nullptr && pending->p->type == PacketType::DATA ) {
     //
     // if the packet is still in the waiting list
     // i.e. I have not see more than REDUNDANCY copies
     // then I send it now
     //
-    //cout << " ++ forward seq " << it->second.p->flowSequenceNumber << " by node " << hostNode->getId()<< " at " << Scheduler::getScheduler().now() << endl;
-    hostNode->enqueueOutgoingPacket(it->second.p);
-    LogSystem::EventsLogOutput.log( LogSystem::routingSND, Scheduler::now(),hostNode->getId(),(int) it->second.p->type,it->second.p->flowId,it->second.p->flowSequenceNumber);
-//         LogSystem::EventsLogOutput.log( LogSystem::memoryTrace, Scheduler::now(),hostNode->getId(),"-",it->second.p->flowId,it->second.p->flowSequenceNumber);
+    //cout << " ++ forward seq " << pending->p->flowSequenceNumber << " by node " << hostNode->getId()<< " at " << Scheduler::getScheduler().now() << endl;
+    hostNode->enqueueOutgoingPacket(pending->p);
+    LogSystem::EventsLogOutput.log( LogSystem::routingSND, Scheduler::now(),hostNode->getId(),(int) pending->p->type,pending->p->flowId,pending->p->flowSequenceNumber);
+//         LogSystem::EventsLogOutput.log( LogSystem::memoryTrace, Scheduler::now(),hostNode->getId(),"-",pending->p->flowId,pending->p->flowSequenceNumber);
 
     forwardedDataPackets++;
-    waitingPacket.erase(it);
+    waitingPacket.erase(packetId);
     //       string filename = ScenarioParameters::getScenarioDirectory()+"/dataSent.data";
     //       ofstream dataSent(filename,std::ofstream::app);
     //       dataSent<< ScenarioParameters::getDefaultBeta() << " " <<hostNode->getId() << " "<< Scheduler::now() << endl;
@@ -33,18 +33,12 @@
 
 class BackoffFloodingRoutingAgent  : public RoutingAgent {
 protected:
-  static mt19937_64 *forwardingRNG;
-  map<int,int> alreadySeenPackets;
+  DuplicateFilter alreadySeenPackets;
   //         time_t backoffWindow = 5000000000 ;
   time_t backoffWindow;
   bool initialisationStarted;
 
-  struct backoffRoutingCounter {
-    PacketPtr p;
-    int counter;
-  };
-
-  map<int,backoffRoutingCounter> waitingPacket;
+  PendingForwards waitingPacket;
   static set<int> reachability;
 
   static float dataBackoffMultiplier;
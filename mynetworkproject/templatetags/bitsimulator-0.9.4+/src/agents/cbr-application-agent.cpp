@@ -67,7 +67,7 @@ void CBRApplicationAgent::processPacketGenerationEvent() {
   hostNode->getRoutingAgent()->receivePacketFromApplication(p);
 
   simulationTime_t t = Scheduler::now() + interval;
-  Scheduler::getScheduler().schedule(new CBRPacketGenerationEvent(t,this));
+  Scheduler::getScheduler().scheduleTimer(new CBRPacketGenerationEvent(t,this));
 
   flowSequenceNumber++;
 }
@@ -151,7 +151,7 @@ void CBRApplicationAgent::initializeAgent() {
 
         }
 
-        Scheduler::getScheduler().schedule(new CBRPacketGenerationEvent(Scheduler::getScheduler().now() + startTime, cbr));
+        Scheduler::getScheduler().scheduleTimer(new CBRPacketGenerationEvent(Scheduler::getScheduler().now() + startTime, cbr));
         flow = flow->NextSiblingElement("flow");
       }
       cout << endl;
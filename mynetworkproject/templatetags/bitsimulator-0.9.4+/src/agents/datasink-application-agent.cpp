@@ -40,11 +40,15 @@ int DataSinkApplicationAgent::aliveAgents = 0;
 map<int,int> DataSinkApplicationAgent::globalIdReceived = map<int,int>();
 set<int> DataSinkApplicationAgent::reachability= set<int>();
 int DataSinkApplicationAgent::maxAliveAgents =0;
-map<int,int> DataSinkApplicationAgent::histoBitsCollisions = map<int,int>();
+DelayStatistics DataSinkApplicationAgent::globalPacketsDelay = DelayStatistics();
+vector<int> DataSinkApplicationAgent::histoBitsCollisions = vector<int>();
 
 DataSinkApplicationAgent::DataSinkApplicationAgent(Node *_hostNode) : ServerApplicationAgent(_hostNode) {
   //  cout << "DataSinkApplicationAgent constructor on node " << _hostNode->getId() << endl;
   nbPacketsReceived = 0;
+  nbPacketsCollisions = 0;
+  receivedCorruptedBits = 0;
+  nbDistinctPacketsReceived = 0;
   loggingInterval = 0;
 
   packetsReceivedDuringInterval = 0;
@@ -59,13 +63,14 @@ DataSinkApplicationAgent::DataSinkApplicationAgent(Node *_hostNode) : ServerAppl
 }
 
 DataSinkApplicationAgent::~DataSinkApplicationAgent() {
-//     cout << "DataSinkApplicationAgent destructor on node " << hostNode->getId() << " id received "<< idPacketReceived.size() << " number of receptions " << nbPacketsReceived << endl;
+//     cout << "DataSinkApplicationAgent destructor on node " << hostNode->getId() << " id received "<< nbDistinctPacketsReceived << " number of receptions " << nbPacketsReceived << endl;
   //  cout << "DataSinkApplicationAgent destructor on node " << hostNode->getId() << " " << nbPacketsReceived << " packets have been received  total:" << totalPacketsReceived << endl;
 
   aliveAgents--;
   //         cout << " aliveAgents " << aliveAgents << endl;
 
-  globalIdReceived.insert(pair<int,int>(hostNode->getId(),idPacketReceived.size()));
+  globalIdReceived.insert(pair<int,int>(hostNode->getId(),nbDistinctPacketsReceived));
+  globalPacketsDelay.merge(packetsDelay);
 
   if (aliveAgents == 0 ){
     // file << endl;
@@ -78,6 +83,13 @@ DataSinkApplicationAgent::~DataSinkApplicationAgent() {
     cout << " Total packets received: " << totalPacketsReceived << endl;
     cout << " Total packets collided: " << totalPacketsCollisions<< endl;
     cout << " Total bits corrupted  : " << totalCorruptedBits << endl;
+    if (globalPacketsDelay.getCount() > 0) {
+      cout << " Delivery delay (fs)   : mean " << (simulationTime_t)globalPacketsDelay.getMean();
+      cout << " min " << globalPacketsDelay.getMin();
+      cout << " median " << globalPacketsDelay.getQuantile(0.5);
+      cout << " 95% " << globalPacketsDelay.getQuantile(0.95);
+      cout << " max " << globalPacketsDelay.getMax() << endl;
+    }
 
     //       file << ScenarioParameters::getGenericNodesRNGSeed() << "\t" << ScenarioParameters::getDefaultBeta() << "\t" << totalPacketsReceived << "\t" << totalPacketsCollisions << "\t" << totalCorruptedBits;
     //       file << endl;
@@ -91,17 +103,9 @@ void DataSinkApplicationAgent::receivePacket(PacketPtr _packet) {
   //  packetsReceivedDuringIdatanterval++;
   bitsReceivedDuringInterval += _packet->size;
 
-  bool add = true;
-  for (auto it = idPacketReceived.begin(); it != idPacketReceived.end() ; it++) {
-    if (it->first == _packet->flowId && it->second == _packet->flowSequenceNumber) {
-      add = false;
-      break;
-    }
-  }
-
-  if (add) {
-    idPacketReceived.push_back(pair<int,int>(_packet->flowId,_packet->flowSequenceNumber));
-    packetsDelay.insert(pair<int,simulationTime_t>(_packet->flowSequenceNumber,Scheduler::now()-_packet->creationTime));
+  if (markReceived(_packet->flowId, _packet->flowSequenceNumber)) {
+    nbDistinctPacketsReceived++;
+    packetsDelay.add(Scheduler::now()-_packet->creationTime);
     reachability.insert(hostNode->getId());
   }
 
@@ -115,13 +119,10 @@ void DataSinkApplicationAgent::receivePacket(PacketPtr _packet) {
       totalCorruptedBits += nbCorruptedBits ;
     }
 
-    auto it = histoBitsCollisions.find(nbCorruptedBits);
-    if ( it != histoBitsCollisions.end() ){
-      histoBitsCollisions[nbCorruptedBits]++;
-    }
-    else{
-      histoBitsCollisions.insert(pair<int,int>(nbCorruptedBits,1));
+    if (nbCorruptedBits >= (int)histoBitsCollisions.size()) {
+      histoBitsCollisions.resize(nbCorruptedBits + 1, 0);
     }
+    histoBitsCollisions[nbCorruptedBits]++;
   }
 
   //  if (_packet->flowId == 1) {
@@ -129,9 +130,26 @@ void DataSinkApplicationAgent::receivePacket(PacketPtr _packet) {
   //  }
 }
 
+// Returns true the first time this (flow, sequence number) is received
+bool DataSinkApplicationAgent::markReceived(int _flowId, int _sequenceNumber) {
+  if (_sequenceNumber < 0) {
+    // packets outside of any flow sequence (e.g. control packets)
+    return unsequencedReceived.insert(pair<int,int>(_flowId, _sequenceNumber)).second;
+  }
+  vector<bool> &received = receivedSequences[_flowId];
+  if (_sequenceNumber >= (int)received.size()) {
+    received.resize(max((size_t)_sequenceNumber + 1, 2 * received.size()), false);
+  }
+  if (received[_sequenceNumber]) {
+    return false;
+  }
+  received[_sequenceNumber] = true;
+  return true;
+}
+
 void DataSinkApplicationAgent:: startLogging(simulationTime_t _interval) {
   loggingInterval = _interval;
-  Scheduler::getScheduler().schedule(new DataSinkLogEvent(Scheduler::now() + loggingInterval, this));
+  Scheduler::getScheduler().scheduleTimer(new DataSinkLogEvent(Scheduler::now() + loggingInterval, this));
 }
 
 void DataSinkApplicationAgent::stopLogging() {
@@ -144,7 +162,7 @@ void DataSinkApplicationAgent::processDataSinkLogEvent() {
   //     cout << bitsReceivedDuringInterval << " bits / ";
   //     cout << channelUsage << "% channel usage" << endl;
   if ( loggingInterval > 0 ) {
-    Scheduler::getScheduler().schedule(new DataSinkLogEvent(Scheduler::now() + loggingInterval, this));
+    Scheduler::getScheduler().scheduleTimer(new DataSinkLogEvent(Scheduler::now() + loggingInterval, this));
   }
   if (Scheduler::now() > 1000000000) loggingInterval = 0;
   packetsReceivedDuringInterval = 0;
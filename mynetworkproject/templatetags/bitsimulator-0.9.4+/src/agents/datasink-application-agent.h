@@ -20,7 +20,10 @@
 #ifndef AGENTS_DATASINK_APPLICATION_AGENT_H_
 #define AGENTS_DATASINK_APPLICATION_AGENT_H_
 
+#include <unordered_map>
+
 #include "server-application-agent.h"
+#include "delay-statistics.h"
 
 
 //===========================================================================================================
@@ -44,15 +47,21 @@ protected:
   int packetsReceivedDuringInterval;
   int bitsReceivedDuringInterval;
 
-  vector<pair<int,int>> idPacketReceived;
-  map <int,simulationTime_t> packetsDelay;
+  // flowId -> bit i set when sequence number i has been received
+  unordered_map<int,vector<bool>> receivedSequences;
+  set<pair<int,int>> unsequencedReceived;
+  int nbDistinctPacketsReceived;
+  DelayStatistics packetsDelay;
 
   static map <int,int> globalIdReceived;
   static int aliveAgents;
   static int maxAliveAgents;
 
   static set<int> reachability;
-  static map<int,int> histoBitsCollisions;
+  static DelayStatistics globalPacketsDelay;
+  static vector<int> histoBitsCollisions;  // indexed by number of corrupted bits
+
+  bool markReceived(int _flowId, int _sequenceNumber);
 
   //  static int nodeCompletion;
   //  static simulationTime_t completionTime;
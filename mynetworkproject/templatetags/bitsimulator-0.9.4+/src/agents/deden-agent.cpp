@@ -346,18 +346,22 @@ int D11DensityEstimatorAgent::aliveAgents = 0;
 vector<int> D11DensityEstimatorAgent::vectEstimationErrorDistribution;
 ofstream D11DensityEstimatorAgent::estimationErrorFile;
 
-map <double,int> D11DensityEstimatorAgent::probaThrsldGrowthRate2Error5;
-map <double,int> D11DensityEstimatorAgent::probaThrsldGrowthRate2Error10;
-map <double,int> D11DensityEstimatorAgent::probaThrsldGrowthRate2Error20;
-map <double,int> D11DensityEstimatorAgent::probaThrsldGrowthRate2Error30;
-map <double,int> D11DensityEstimatorAgent::probaThrsldGrowthRate1_6Error5;
-map <double,int> D11DensityEstimatorAgent::probaThrsldGrowthRate1_6Error10;
-map <double,int> D11DensityEstimatorAgent::probaThrsldGrowthRate1_6Error20;
-map <double,int> D11DensityEstimatorAgent::probaThrsldGrowthRate1_6Error30;
-map <double,int> D11DensityEstimatorAgent::probaThrsldGrowthRate1_2Error5;
-map <double,int> D11DensityEstimatorAgent::probaThrsldGrowthRate1_2Error10;
-map <double,int> D11DensityEstimatorAgent::probaThrsldGrowthRate1_2Error20;
-map <double,int> D11DensityEstimatorAgent::probaThrsldGrowthRate1_2Error30;
+const DedenThreshold_t *D11DensityEstimatorAgent::thresholds = nullptr;
+mt19937_64 *D11DensityEstimatorAgent::oracleRandomGenerator = nullptr;
+
+// Out-of-line definitions of the constexpr tables (needed in C++11 as they are odr-used)
+constexpr DedenThreshold_t DedenThresholdTable<20, 5>::thresholds[];
+constexpr DedenThreshold_t DedenThresholdTable<20, 10>::thresholds[];
+constexpr DedenThreshold_t DedenThresholdTable<20, 20>::thresholds[];
+constexpr DedenThreshold_t DedenThresholdTable<20, 30>::thresholds[];
+constexpr DedenThreshold_t DedenThresholdTable<16, 5>::thresholds[];
+constexpr DedenThreshold_t DedenThresholdTable<16, 10>::thresholds[];
+constexpr DedenThreshold_t DedenThresholdTable<16, 20>::thresholds[];
+constexpr DedenThreshold_t DedenThresholdTable<16, 30>::thresholds[];
+constexpr DedenThreshold_t DedenThresholdTable<12, 5>::thresholds[];
+constexpr DedenThreshold_t DedenThresholdTable<12, 10>::thresholds[];
+constexpr DedenThreshold_t DedenThresholdTable<12, 20>::thresholds[];
+constexpr DedenThreshold_t DedenThresholdTable<12, 30>::thresholds[];
 
 D11DensityEstimatorAgent::D11DensityEstimatorAgent(Node *_hostNode, int _flowId, int _port, PacketType _packetType, simulationTime_t _interval, int _repetition, int _seed) : ServerApplicationAgent(_hostNode) {
   //cout << "D11DensityEstimatorAgent constructor" << endl;
@@ -401,61 +405,8 @@ D11DensityEstimatorAgent::D11DensityEstimatorAgent(Node *_hostNode, int _flowId,
 
   vectEstimationErrorDistribution = vector<int>(100,0);
 
-  if ( ScenarioParameters::getD1GrowRate() == (float)2) {
-    if ( ScenarioParameters::getD1ErrorMax() == 30 ) {
-      current = probaThrsldGrowthRate2Error30.begin();
-      computedMaxRound = probaThrsldGrowthRate2Error30.size();
-    } else if ( ScenarioParameters::getD1ErrorMax() == 20 ) {
-      current = probaThrsldGrowthRate2Error20.begin();
-      computedMaxRound = probaThrsldGrowthRate2Error20.size();
-    } else if ( ScenarioParameters::getD1ErrorMax() == 10 ) {
-      current = probaThrsldGrowthRate2Error10.begin();
-      computedMaxRound = probaThrsldGrowthRate2Error10.size();
-    } else if ( ScenarioParameters::getD1ErrorMax() == 5 ) {
-      current = probaThrsldGrowthRate2Error5.begin();
-      computedMaxRound = probaThrsldGrowthRate2Error5.size();
-    } else {
-      cout << "*** ERROR: invalid D1ErrorMax:" << ScenarioParameters::getD1ErrorMax() << endl;
-    }
-  } else if ( ScenarioParameters::getD1GrowRate() == (float)1.6 ) {
-    if ( ScenarioParameters::getD1ErrorMax() == 30 ) {
-      current = probaThrsldGrowthRate1_6Error30.begin();
-      computedMaxRound = probaThrsldGrowthRate1_6Error30.size();
-    } else if ( ScenarioParameters::getD1ErrorMax() == 20 ) {
-      current = probaThrsldGrowthRate1_6Error20.begin();
-      computedMaxRound = probaThrsldGrowthRate1_6Error20.size();
-    } else if ( ScenarioParameters::getD1ErrorMax() == 10 ) {
-      current = probaThrsldGrowthRate1_6Error10.begin();
-      computedMaxRound = probaThrsldGrowthRate1_6Error10.size();
-    } else if ( ScenarioParameters::getD1ErrorMax() == 5 ) {
-      current = probaThrsldGrowthRate1_6Error5.begin();
-      computedMaxRound = probaThrsldGrowthRate1_6Error5.size();
-    } else {
-      cout << "*** ERROR: invalid D1ErrorMax:" << ScenarioParameters::getD1ErrorMax() << endl;
-    }
-  } else if ( ScenarioParameters::getD1GrowRate() == (float)1.2 ) {
-    if ( ScenarioParameters::getD1ErrorMax() == 30 ) {
-      current = probaThrsldGrowthRate1_2Error30.begin();
-      computedMaxRound = probaThrsldGrowthRate1_2Error30.size();
-    } else if ( ScenarioParameters::getD1ErrorMax() == 20 ) {
-      current = probaThrsldGrowthRate1_2Error20.begin();
-      computedMaxRound = probaThrsldGrowthRate1_2Error20.size();
-    } else if ( ScenarioParameters::getD1ErrorMax() == 10 ) {
-      current = probaThrsldGrowthRate1_2Error10.begin();
-      computedMaxRound = probaThrsldGrowthRate1_2Error10.size();
-    } else if ( ScenarioParameters::getD1ErrorMax() == 5 ) {
-      current = probaThrsldGrowthRate1_2Error5.begin();
-      computedMaxRound = probaThrsldGrowthRate1_2Error5.size();
-    } else {
-      cout << "*** ERROR: invalid D1ErrorMax:" << ScenarioParameters::getD1ErrorMax() << endl;
-    }
-  } else {
-    cout << "*** ERROR: invalid D1GrowthRate:" << ScenarioParameters::getD1GrowRate() << endl;
-    exit(EXIT_FAILURE);
-  }
-
-  probability=current->first;
-  minPacketsForTermination=current->second;
+  probability = thresholds[roundNumber].probability;
+  minPacketsForTermination = thresholds[roundNumber].minPacketsForTermination;
 }
 
 D11DensityEstimatorAgent::~D11DensityEstimatorAgent() {
@@ -619,397 +570,92 @@ void D11DensityEstimatorAgent::initialize() {
 
   estimationErrorFile.open(estimationErrorFileName, ofstream::out);
 
-  //
-  // growthRate 2
-  //  5% error threshold
-  //
-  probaThrsldGrowthRate2Error5.insert(pair<double,int>(0.000003814697265625,1542));
-  probaThrsldGrowthRate2Error5.insert(pair<double,int>(0.00000762939453125,1542));
-  probaThrsldGrowthRate2Error5.insert(pair<double,int>(0.0000152587890625,1542));
-  probaThrsldGrowthRate2Error5.insert(pair<double,int>(0.000030517578125,1542));
-  probaThrsldGrowthRate2Error5.insert(pair<double,int>(0.00006103515625,1542));
-  probaThrsldGrowthRate2Error5.insert(pair<double,int>(0.0001220703125,1542));
-  probaThrsldGrowthRate2Error5.insert(pair<double,int>(0.000244140625,1542));
-  probaThrsldGrowthRate2Error5.insert(pair<double,int>(0.00048828125,1542));
-  probaThrsldGrowthRate2Error5.insert(pair<double,int>(0.0009765625,1542));
-  probaThrsldGrowthRate2Error5.insert(pair<double,int>(0.001953125,1540));
-  probaThrsldGrowthRate2Error5.insert(pair<double,int>(0.00390625,1535));
-  probaThrsldGrowthRate2Error5.insert(pair<double,int>(0.0078125,1530));
-  probaThrsldGrowthRate2Error5.insert(pair<double,int>(0.015625,1520));
-  probaThrsldGrowthRate2Error5.insert(pair<double,int>(0.03125,1500));
-  probaThrsldGrowthRate2Error5.insert(pair<double,int>(0.0625,1450));
-  probaThrsldGrowthRate2Error5.insert(pair<double,int>(0.125,1350));
-  probaThrsldGrowthRate2Error5.insert(pair<double,int>(0.25,1150));
-  probaThrsldGrowthRate2Error5.insert(pair<double,int>(0.5,760));
-  probaThrsldGrowthRate2Error5.insert(pair<double,int>(1,-1));
-
-  //
-  // growthRate 2
-  //  10% error threshold
-  //
-  probaThrsldGrowthRate2Error10.insert(pair<double,int>(0.000003814697265625,387));
-  probaThrsldGrowthRate2Error10.insert(pair<double,int>(0.00000762939453125,387));
-  probaThrsldGrowthRate2Error10.insert(pair<double,int>(0.0000152587890625,387));
-  probaThrsldGrowthRate2Error10.insert(pair<double,int>(0.000030517578125,386));
-  probaThrsldGrowthRate2Error10.insert(pair<double,int>(0.00006103515625,386));
-  probaThrsldGrowthRate2Error10.insert(pair<double,int>(0.0001220703125,386));
-  probaThrsldGrowthRate2Error10.insert(pair<double,int>(0.000244140625,386));
-  probaThrsldGrowthRate2Error10.insert(pair<double,int>(0.00048828125,386));
-  probaThrsldGrowthRate2Error10.insert(pair<double,int>(0.0009765625,386));
-  probaThrsldGrowthRate2Error10.insert(pair<double,int>(0.001953125,386));
-  probaThrsldGrowthRate2Error10.insert(pair<double,int>(0.00390625,385));
-  probaThrsldGrowthRate2Error10.insert(pair<double,int>(0.0078125,384));
-  probaThrsldGrowthRate2Error10.insert(pair<double,int>(0.015625,380));
-  probaThrsldGrowthRate2Error10.insert(pair<double,int>(0.03125,375));
-  probaThrsldGrowthRate2Error10.insert(pair<double,int>(0.0625,362));
-  probaThrsldGrowthRate2Error10.insert(pair<double,int>(0.125,338));
-  probaThrsldGrowthRate2Error10.insert(pair<double,int>(0.25,288));
-  probaThrsldGrowthRate2Error10.insert(pair<double,int>(0.5,190));
-  probaThrsldGrowthRate2Error10.insert(pair<double,int>(1,-1));
-
-  //
-  // growthRate 2
-  //  20% error threshold
-  //
-  probaThrsldGrowthRate2Error20.insert(pair<double,int>(0.000003814697265625,99));
-  probaThrsldGrowthRate2Error20.insert(pair<double,int>(0.00000762939453125,99));
-  probaThrsldGrowthRate2Error20.insert(pair<double,int>(0.0000152587890625,99));
-  probaThrsldGrowthRate2Error20.insert(pair<double,int>(0.000030517578125,99));
-  probaThrsldGrowthRate2Error20.insert(pair<double,int>(0.00006103515625,99));
-  probaThrsldGrowthRate2Error20.insert(pair<double,int>(0.0001220703125,99));
-  probaThrsldGrowthRate2Error20.insert(pair<double,int>(0.000244140625,99));
-  probaThrsldGrowthRate2Error20.insert(pair<double,int>(0.00048828125,99));
-  probaThrsldGrowthRate2Error20.insert(pair<double,int>(0.0009765625,98));
-  probaThrsldGrowthRate2Error20.insert(pair<double,int>(0.001953125,98));
-  probaThrsldGrowthRate2Error20.insert(pair<double,int>(0.00390625,98));
-  probaThrsldGrowthRate2Error20.insert(pair<double,int>(0.0078125,98));
-  probaThrsldGrowthRate2Error20.insert(pair<double,int>(0.015625,97));
-  probaThrsldGrowthRate2Error20.insert(pair<double,int>(0.03125,95));
-  probaThrsldGrowthRate2Error20.insert(pair<double,int>(0.0625,92));
-  probaThrsldGrowthRate2Error20.insert(pair<double,int>(0.125,86));
-  probaThrsldGrowthRate2Error20.insert(pair<double,int>(0.25,73));
-  probaThrsldGrowthRate2Error20.insert(pair<double,int>(0.5,48));
-  probaThrsldGrowthRate2Error20.insert(pair<double,int>(1,-1));
-
-  //
-  // growthRate 2
-  //  30% error threshold
-  //
-  probaThrsldGrowthRate2Error30.insert(pair<double,int>(0.000003814697265625,45));
-  probaThrsldGrowthRate2Error30.insert(pair<double,int>(0.00000762939453125,45));
-  probaThrsldGrowthRate2Error30.insert(pair<double,int>(0.0000152587890625,45));
-  probaThrsldGrowthRate2Error30.insert(pair<double,int>(0.000030517578125,45));
-  probaThrsldGrowthRate2Error30.insert(pair<double,int>(0.00006103515625,45));
-  probaThrsldGrowthRate2Error30.insert(pair<double,int>(0.0001220703125,45));
-  probaThrsldGrowthRate2Error30.insert(pair<double,int>(0.000244140625,45));
-  probaThrsldGrowthRate2Error30.insert(pair<double,int>(0.00048828125,45));
-  probaThrsldGrowthRate2Error30.insert(pair<double,int>(0.0009765625,45));
-  probaThrsldGrowthRate2Error30.insert(pair<double,int>(0.001953125,45));
-  probaThrsldGrowthRate2Error30.insert(pair<double,int>(0.00390625,45));
-  probaThrsldGrowthRate2Error30.insert(pair<double,int>(0.0078125,45));
-  probaThrsldGrowthRate2Error30.insert(pair<double,int>(0.015625,45));
-  probaThrsldGrowthRate2Error30.insert(pair<double,int>(0.03125,44));
-  probaThrsldGrowthRate2Error30.insert(pair<double,int>(0.0625,42));
-  probaThrsldGrowthRate2Error30.insert(pair<double,int>(0.125,40));
-  probaThrsldGrowthRate2Error30.insert(pair<double,int>(0.25,34));
-  probaThrsldGrowthRate2Error30.insert(pair<double,int>(0.5,22));
-  probaThrsldGrowthRate2Error30.insert(pair<double,int>(1,-1));
-
-  //      
-  // growthRate 1.6
-  //  5% error threshold
-  //
-  probaThrsldGrowthRate1_6Error5.insert(pair<double,int>(0.00000308148791101958, 1548));
-  probaThrsldGrowthRate1_6Error5.insert(pair<double,int>(0.00000493038065763132, 1548));
-  probaThrsldGrowthRate1_6Error5.insert(pair<double,int>(0.00000788860905221012, 1548));
-  probaThrsldGrowthRate1_6Error5.insert(pair<double,int>(0.0000126217744835362, 1548));
-  probaThrsldGrowthRate1_6Error5.insert(pair<double,int>(0.0000201948391736579, 1457));
-  probaThrsldGrowthRate1_6Error5.insert(pair<double,int>(0.0000323117426778526, 1547));
-  probaThrsldGrowthRate1_6Error5.insert(pair<double,int>(0.0000516987882845642, 1546));
-  probaThrsldGrowthRate1_6Error5.insert(pair<double,int>(0.0000827180612553028, 1546));
-  probaThrsldGrowthRate1_6Error5.insert(pair<double,int>(0.000132348898008, 1546));
-  probaThrsldGrowthRate1_6Error5.insert(pair<double,int>(0.000211758236814, 1546));
-  probaThrsldGrowthRate1_6Error5.insert(pair<double,int>(0.000338813178902, 1546));
-  probaThrsldGrowthRate1_6Error5.insert(pair<double,int>(0.000542101086243, 1545));
-  probaThrsldGrowthRate1_6Error5.insert(pair<double,int>(0.000867361737988, 1545));
-  probaThrsldGrowthRate1_6Error5.insert(pair<double,int>(0.0013877788, 1545));
-  probaThrsldGrowthRate1_6Error5.insert(pair<double,int>(0.002220446, 1544));
-  probaThrsldGrowthRate1_6Error5.insert(pair<double,int>(0.0035527137, 1544));
-  probaThrsldGrowthRate1_6Error5.insert(pair<double,int>(0.0056843419, 1543));
-  probaThrsldGrowthRate1_6Error5.insert(pair<double,int>(0.009094947, 1542 ));
-  probaThrsldGrowthRate1_6Error5.insert(pair<double,int>(0.0145519152, 1540));
-  probaThrsldGrowthRate1_6Error5.insert(pair<double,int>(0.0232830644, 1535));
-  probaThrsldGrowthRate1_6Error5.insert(pair<double,int>(0.037252903, 1530));
-  probaThrsldGrowthRate1_6Error5.insert(pair<double,int>(0.0596046448, 1520));
-  probaThrsldGrowthRate1_6Error5.insert(pair<double,int>(0.0953674316, 1500));
-  probaThrsldGrowthRate1_6Error5.insert(pair<double,int>(0.1525878906, 1450));
-  probaThrsldGrowthRate1_6Error5.insert(pair<double,int>(0.244140625, 1342 ));
-  probaThrsldGrowthRate1_6Error5.insert(pair<double,int>(0.390625, 1150));
-  probaThrsldGrowthRate1_6Error5.insert(pair<double,int>(0.625, 760));
-  probaThrsldGrowthRate1_6Error5.insert(pair<double,int>(1, -1));
-
-  //
-  // growthRate 1.6
-  //  10% error threshold
-  //
-  probaThrsldGrowthRate1_6Error10.insert(pair<double,int>(0.00000308148791101958, 387));
-  probaThrsldGrowthRate1_6Error10.insert(pair<double,int>(0.00000493038065763132, 387));
-  probaThrsldGrowthRate1_6Error10.insert(pair<double,int>(0.00000788860905221012, 387));
-  probaThrsldGrowthRate1_6Error10.insert(pair<double,int>(0.0000126217744835362, 387));
-  probaThrsldGrowthRate1_6Error10.insert(pair<double,int>(0.0000201948391736579, 387));
-  probaThrsldGrowthRate1_6Error10.insert(pair<double,int>(0.0000323117426778526, 387));
-  probaThrsldGrowthRate1_6Error10.insert(pair<double,int>(0.0000516987882845642, 387));
-  probaThrsldGrowthRate1_6Error10.insert(pair<double,int>(0.0000827180612553028, 387));
-  probaThrsldGrowthRate1_6Error10.insert(pair<double,int>(0.000132348898008, 387));
-  probaThrsldGrowthRate1_6Error10.insert(pair<double,int>(0.000211758236814, 387));
-  probaThrsldGrowthRate1_6Error10.insert(pair<double,int>(0.000338813178902, 387));
-  probaThrsldGrowthRate1_6Error10.insert(pair<double,int>(0.000542101086243, 387));
-  probaThrsldGrowthRate1_6Error10.insert(pair<double,int>(0.000867361737988, 387));
-  probaThrsldGrowthRate1_6Error10.insert(pair<double,int>(0.0013877788, 386));
-  probaThrsldGrowthRate1_6Error10.insert(pair<double,int>(0.002220446, 386));
-  probaThrsldGrowthRate1_6Error10.insert(pair<double,int>(0.0035527137, 385));
-  probaThrsldGrowthRate1_6Error10.insert(pair<double,int>(0.0056843419, 384));
-  probaThrsldGrowthRate1_6Error10.insert(pair<double,int>(0.009094947, 383 ));
-  probaThrsldGrowthRate1_6Error10.insert(pair<double,int>(0.0145519152, 381));
-  probaThrsldGrowthRate1_6Error10.insert(pair<double,int>(0.0232830644, 377));
-  probaThrsldGrowthRate1_6Error10.insert(pair<double,int>(0.037252903, 372));
-  probaThrsldGrowthRate1_6Error10.insert(pair<double,int>(0.0596046448, 364));
-  probaThrsldGrowthRate1_6Error10.insert(pair<double,int>(0.0953674316, 350));
-  probaThrsldGrowthRate1_6Error10.insert(pair<double,int>(0.1525878906, 327));
-  probaThrsldGrowthRate1_6Error10.insert(pair<double,int>(0.244140625, 291 ));
-  probaThrsldGrowthRate1_6Error10.insert(pair<double,int>(0.390625, 235));
-  probaThrsldGrowthRate1_6Error10.insert(pair<double,int>(0.625, 139));
-  probaThrsldGrowthRate1_6Error10.insert(pair<double,int>(1, -1));
-
-  //
-  // growthRate 1.6
-  //  20% error threshold
-  //
-  probaThrsldGrowthRate1_6Error20.insert(pair<double,int>(0.00000308148791101958, 99));
-  probaThrsldGrowthRate1_6Error20.insert(pair<double,int>(0.00000493038065763132, 99));
-  probaThrsldGrowthRate1_6Error20.insert(pair<double,int>(0.00000788860905221012, 99));
-  probaThrsldGrowthRate1_6Error20.insert(pair<double,int>(0.0000126217744835362, 99));
-  probaThrsldGrowthRate1_6Error20.insert(pair<double,int>(0.0000201948391736579, 99));
-  probaThrsldGrowthRate1_6Error20.insert(pair<double,int>(0.0000323117426778526, 99));
-  probaThrsldGrowthRate1_6Error20.insert(pair<double,int>(0.0000516987882845642, 99));
-  probaThrsldGrowthRate1_6Error20.insert(pair<double,int>(0.0000827180612553028, 99));
-  probaThrsldGrowthRate1_6Error20.insert(pair<double,int>(0.000132348898008, 99));
-  probaThrsldGrowthRate1_6Error20.insert(pair<double,int>(0.000211758236814, 99));
-  probaThrsldGrowthRate1_6Error20.insert(pair<double,int>(0.000338813178902, 99));
-  probaThrsldGrowthRate1_6Error20.insert(pair<double,int>(0.000542101086243, 99));
-  probaThrsldGrowthRate1_6Error20.insert(pair<double,int>(0.000867361737988, 98));
-  probaThrsldGrowthRate1_6Error20.insert(pair<double,int>(0.0013877788, 98));
-  probaThrsldGrowthRate1_6Error20.insert(pair<double,int>(0.002220446, 98));
-  probaThrsldGrowthRate1_6Error20.insert(pair<double,int>(0.0035527137, 98));
-  probaThrsldGrowthRate1_6Error20.insert(pair<double,int>(0.0056843419, 98));
-  probaThrsldGrowthRate1_6Error20.insert(pair<double,int>(0.009094947, 98 ));
-  probaThrsldGrowthRate1_6Error20.insert(pair<double,int>(0.0145519152, 97));
-  probaThrsldGrowthRate1_6Error20.insert(pair<double,int>(0.0232830644, 96));
-  probaThrsldGrowthRate1_6Error20.insert(pair<double,int>(0.037252903, 95));
-  probaThrsldGrowthRate1_6Error20.insert(pair<double,int>(0.0596046448, 93));
-  probaThrsldGrowthRate1_6Error20.insert(pair<double,int>(0.0953674316, 89));
-  probaThrsldGrowthRate1_6Error20.insert(pair<double,int>(0.1525878906, 84));
-  probaThrsldGrowthRate1_6Error20.insert(pair<double,int>(0.244140625, 74 ));
-  probaThrsldGrowthRate1_6Error20.insert(pair<double,int>(0.390625, 59));
-  probaThrsldGrowthRate1_6Error20.insert(pair<double,int>(0.625, 35));
-  probaThrsldGrowthRate1_6Error20.insert(pair<double,int>(1, -1));
-
-  //
-  // growthRate 1.6
-  //  30% error threshold
-  //
-  probaThrsldGrowthRate1_6Error30.insert(pair<double,int>(0.00000308148791101958, 45));
-  probaThrsldGrowthRate1_6Error30.insert(pair<double,int>(0.00000493038065763132, 45));
-  probaThrsldGrowthRate1_6Error30.insert(pair<double,int>(0.00000788860905221012, 45));
-  probaThrsldGrowthRate1_6Error30.insert(pair<double,int>(0.0000126217744835362, 45));
-  probaThrsldGrowthRate1_6Error30.insert(pair<double,int>(0.0000201948391736579, 45));
-  probaThrsldGrowthRate1_6Error30.insert(pair<double,int>(0.0000323117426778526, 45));
-  probaThrsldGrowthRate1_6Error30.insert(pair<double,int>(0.0000516987882845642, 45));
-  probaThrsldGrowthRate1_6Error30.insert(pair<double,int>(0.0000827180612553028, 45));
-  probaThrsldGrowthRate1_6Error30.insert(pair<double,int>(0.000132348898008, 45));
-  probaThrsldGrowthRate1_6Error30.insert(pair<double,int>(0.000211758236814, 45));
-  probaThrsldGrowthRate1_6Error30.insert(pair<double,int>(0.000338813178902, 45));
-  probaThrsldGrowthRate1_6Error30.insert(pair<double,int>(0.000542101086243, 45));
-  probaThrsldGrowthRate1_6Error30.insert(pair<double,int>(0.000867361737988, 45));
-  probaThrsldGrowthRate1_6Error30.insert(pair<double,int>(0.0013877788, 45));
-  probaThrsldGrowthRate1_6Error30.insert(pair<double,int>(0.002220446, 45));
-  probaThrsldGrowthRate1_6Error30.insert(pair<double,int>(0.0035527137, 45));
-  probaThrsldGrowthRate1_6Error30.insert(pair<double,int>(0.0056843419, 45));
-  probaThrsldGrowthRate1_6Error30.insert(pair<double,int>(0.009094947, 45 ));
-  probaThrsldGrowthRate1_6Error30.insert(pair<double,int>(0.0145519152, 45));
-  probaThrsldGrowthRate1_6Error30.insert(pair<double,int>(0.0232830644, 44));
-  probaThrsldGrowthRate1_6Error30.insert(pair<double,int>(0.037252903, 44));
-  probaThrsldGrowthRate1_6Error30.insert(pair<double,int>(0.0596046448, 43));
-  probaThrsldGrowthRate1_6Error30.insert(pair<double,int>(0.0953674316, 41));
-  probaThrsldGrowthRate1_6Error30.insert(pair<double,int>(0.1525878906, 38));
-  probaThrsldGrowthRate1_6Error30.insert(pair<double,int>(0.244140625, 35 ));
-  probaThrsldGrowthRate1_6Error30.insert(pair<double,int>(0.390625, 28));
-  probaThrsldGrowthRate1_6Error30.insert(pair<double,int>(0.625, 17));
-  probaThrsldGrowthRate1_6Error30.insert(pair<double,int>(1, -1));
-
-  // growthRate 1.2
-  //  5% error threshold
-  //
-  probaThrsldGrowthRate1_2Error5.insert(pair<double,int>(0.0014108315,1550));
-  probaThrsldGrowthRate1_2Error5.insert(pair<double,int>(0.0016929978,1549));
-  probaThrsldGrowthRate1_2Error5.insert(pair<double,int>(0.0020315973,1549));
-  probaThrsldGrowthRate1_2Error5.insert(pair<double,int>(0.0024379168,1548));
-  probaThrsldGrowthRate1_2Error5.insert(pair<double,int>(0.0029255002,1547));
-  probaThrsldGrowthRate1_2Error5.insert(pair<double,int>(0.0035106002,1546));
-  probaThrsldGrowthRate1_2Error5.insert(pair<double,int>(0.0042127202,1545));
-  probaThrsldGrowthRate1_2Error5.insert(pair<double,int>(0.0050552643,1544));
-  probaThrsldGrowthRate1_2Error5.insert(pair<double,int>(0.0060663171,1542));
-  probaThrsldGrowthRate1_2Error5.insert(pair<double,int>(0.0072795806,1541));
-  probaThrsldGrowthRate1_2Error5.insert(pair<double,int>(0.0087354967,1540));
-  probaThrsldGrowthRate1_2Error5.insert(pair<double,int>(0.010482596,1539));
-  probaThrsldGrowthRate1_2Error5.insert(pair<double,int>(0.0125791152,1537));
-  probaThrsldGrowthRate1_2Error5.insert(pair<double,int>(0.0150949383,1535));
-  probaThrsldGrowthRate1_2Error5.insert(pair<double,int>(0.0181139259,1530));
-  probaThrsldGrowthRate1_2Error5.insert(pair<double,int>(0.0217367111,1525));
-  probaThrsldGrowthRate1_2Error5.insert(pair<double,int>(0.0260840533,1520));
-  probaThrsldGrowthRate1_2Error5.insert(pair<double,int>(0.031300864,1510));
-  probaThrsldGrowthRate1_2Error5.insert(pair<double,int>(0.0375610368,1500));
-  probaThrsldGrowthRate1_2Error5.insert(pair<double,int>(0.0450732441,1490));
-  probaThrsldGrowthRate1_2Error5.insert(pair<double,int>(0.0540878929,1480));
-  probaThrsldGrowthRate1_2Error5.insert(pair<double,int>(0.0649054715,1460));
-  probaThrsldGrowthRate1_2Error5.insert(pair<double,int>(0.0778865658,1440));
-  probaThrsldGrowthRate1_2Error5.insert(pair<double,int>(0.093463879,1420));
-  probaThrsldGrowthRate1_2Error5.insert(pair<double,int>(0.1121566548,1380));
-  probaThrsldGrowthRate1_2Error5.insert(pair<double,int>(0.1345879857,1350));
-  probaThrsldGrowthRate1_2Error5.insert(pair<double,int>(0.1615055829,1300));
-  probaThrsldGrowthRate1_2Error5.insert(pair<double,int>(0.1938066995,1250));
-  probaThrsldGrowthRate1_2Error5.insert(pair<double,int>(0.2325680394,1180));
-  probaThrsldGrowthRate1_2Error5.insert(pair<double,int>(0.2790816472,1100));
-  probaThrsldGrowthRate1_2Error5.insert(pair<double,int>(0.3348979767,1019));
-  probaThrsldGrowthRate1_2Error5.insert(pair<double,int>(0.401877572,917));
-  probaThrsldGrowthRate1_2Error5.insert(pair<double,int>(0.4822530864,791));
-  probaThrsldGrowthRate1_2Error5.insert(pair<double,int>(0.5787037037,640));
-  probaThrsldGrowthRate1_2Error5.insert(pair<double,int>(0.6944444444,471));
-  probaThrsldGrowthRate1_2Error5.insert(pair<double,int>(0.8333333333,235));
-  probaThrsldGrowthRate1_2Error5.insert(pair<double,int>(1.0,-1));
-
-  // growthRate 1.2
-  //  10% error threshold
-  //
-  probaThrsldGrowthRate1_2Error10.insert(pair<double,int>(0.0014108315, 386));
-  probaThrsldGrowthRate1_2Error10.insert(pair<double,int>(0.0016929978, 386));
-  probaThrsldGrowthRate1_2Error10.insert(pair<double,int>(0.0020315973, 386));
-  probaThrsldGrowthRate1_2Error10.insert(pair<double,int>(0.0024379168, 386));
-  probaThrsldGrowthRate1_2Error10.insert(pair<double,int>(0.0029255002, 385));
-  probaThrsldGrowthRate1_2Error10.insert(pair<double,int>(0.0035106002, 385));
-  probaThrsldGrowthRate1_2Error10.insert(pair<double,int>(0.0042127202, 385));
-  probaThrsldGrowthRate1_2Error10.insert(pair<double,int>(0.0050552643, 385));
-  probaThrsldGrowthRate1_2Error10.insert(pair<double,int>(0.0060663171, 384));
-  probaThrsldGrowthRate1_2Error10.insert(pair<double,int>(0.0072795806, 384));
-  probaThrsldGrowthRate1_2Error10.insert(pair<double,int>(0.0087354967, 383));
-  probaThrsldGrowthRate1_2Error10.insert(pair<double,int>(0.010482596, 382));
-  probaThrsldGrowthRate1_2Error10.insert(pair<double,int>(0.0125791152, 382));
-  probaThrsldGrowthRate1_2Error10.insert(pair<double,int>(0.0150949383, 381));
-  probaThrsldGrowthRate1_2Error10.insert(pair<double,int>(0.0181139259, 379));
-  probaThrsldGrowthRate1_2Error10.insert(pair<double,int>(0.0217367111, 378));
-  probaThrsldGrowthRate1_2Error10.insert(pair<double,int>(0.0260840533, 376));
-  probaThrsldGrowthRate1_2Error10.insert(pair<double,int>(0.031300864,  375));
-  probaThrsldGrowthRate1_2Error10.insert(pair<double,int>(0.0375610368, 372));
-  probaThrsldGrowthRate1_2Error10.insert(pair<double,int>(0.0450732441, 369));
-  probaThrsldGrowthRate1_2Error10.insert(pair<double,int>(0.0540878929, 366));
-  probaThrsldGrowthRate1_2Error10.insert(pair<double,int>(0.0649054715, 366));
-  probaThrsldGrowthRate1_2Error10.insert(pair<double,int>(0.0778865658, 356));
-  probaThrsldGrowthRate1_2Error10.insert(pair<double,int>(0.093463879, 350));
-  probaThrsldGrowthRate1_2Error10.insert(pair<double,int>(0.1121566548, 343));
-  probaThrsldGrowthRate1_2Error10.insert(pair<double,int>(0.1345879857, 333));
-  probaThrsldGrowthRate1_2Error10.insert(pair<double,int>(0.1615055829, 324));
-  probaThrsldGrowthRate1_2Error10.insert(pair<double,int>(0.1938066995, 311));
-  probaThrsldGrowthRate1_2Error10.insert(pair<double,int>(0.2325680394, 296));
-  probaThrsldGrowthRate1_2Error10.insert(pair<double,int>(0.2790816472, 277));
-  probaThrsldGrowthRate1_2Error10.insert(pair<double,int>(0.3348979767, 255));
-  probaThrsldGrowthRate1_2Error10.insert(pair<double,int>(0.401877572, 230));
-  probaThrsldGrowthRate1_2Error10.insert(pair<double,int>(0.4822530864, 198));
-  probaThrsldGrowthRate1_2Error10.insert(pair<double,int>(0.5787037037, 157));
-  probaThrsldGrowthRate1_2Error10.insert(pair<double,int>(0.6944444444, 112));
-  probaThrsldGrowthRate1_2Error10.insert(pair<double,int>(0.8333333333, 60));
-  probaThrsldGrowthRate1_2Error10.insert(pair<double,int>(1, -1));
-
-  // growthRate 1.2
-  //  20% error threshold
-  //
-  probaThrsldGrowthRate1_2Error20.insert(pair<double,int>(0.0014108315, 98));
-  probaThrsldGrowthRate1_2Error20.insert(pair<double,int>(0.0016929978, 98));
-  probaThrsldGrowthRate1_2Error20.insert(pair<double,int>(0.0020315973, 98));
-  probaThrsldGrowthRate1_2Error20.insert(pair<double,int>(0.0024379168, 98));
-  probaThrsldGrowthRate1_2Error20.insert(pair<double,int>(0.0029255002, 98));
-  probaThrsldGrowthRate1_2Error20.insert(pair<double,int>(0.0035106002, 98));
-  probaThrsldGrowthRate1_2Error20.insert(pair<double,int>(0.0042127202, 98));
-  probaThrsldGrowthRate1_2Error20.insert(pair<double,int>(0.0050552643, 98));
-  probaThrsldGrowthRate1_2Error20.insert(pair<double,int>(0.0060663171, 98));
-  probaThrsldGrowthRate1_2Error20.insert(pair<double,int>(0.0072795806, 98));
-  probaThrsldGrowthRate1_2Error20.insert(pair<double,int>(0.0087354967, 98));
-  probaThrsldGrowthRate1_2Error20.insert(pair<double,int>(0.010482596, 98));
-  probaThrsldGrowthRate1_2Error20.insert(pair<double,int>(0.0125791152, 97));
-  probaThrsldGrowthRate1_2Error20.insert(pair<double,int>(0.0150949383, 97));
-  probaThrsldGrowthRate1_2Error20.insert(pair<double,int>(0.0181139259, 97));
-  probaThrsldGrowthRate1_2Error20.insert(pair<double,int>(0.0217367111, 96));
-  probaThrsldGrowthRate1_2Error20.insert(pair<double,int>(0.0260840533, 96));
-  probaThrsldGrowthRate1_2Error20.insert(pair<double,int>(0.031300864,  95));
-  probaThrsldGrowthRate1_2Error20.insert(pair<double,int>(0.0375610368, 95));
-  probaThrsldGrowthRate1_2Error20.insert(pair<double,int>(0.0450732441, 94));
-  probaThrsldGrowthRate1_2Error20.insert(pair<double,int>(0.0540878929, 93));
-  probaThrsldGrowthRate1_2Error20.insert(pair<double,int>(0.0649054715, 92));
-  probaThrsldGrowthRate1_2Error20.insert(pair<double,int>(0.0778865658, 91));
-  probaThrsldGrowthRate1_2Error20.insert(pair<double,int>(0.093463879, 89));
-  probaThrsldGrowthRate1_2Error20.insert(pair<double,int>(0.1121566548, 87));
-  probaThrsldGrowthRate1_2Error20.insert(pair<double,int>(0.1345879857, 85));
-  probaThrsldGrowthRate1_2Error20.insert(pair<double,int>(0.1615055829, 83));
-  probaThrsldGrowthRate1_2Error20.insert(pair<double,int>(0.1938066995, 79));
-  probaThrsldGrowthRate1_2Error20.insert(pair<double,int>(0.2325680394, 75));
-  probaThrsldGrowthRate1_2Error20.insert(pair<double,int>(0.2790816472, 72));
-  probaThrsldGrowthRate1_2Error20.insert(pair<double,int>(0.3348979767, 64));
-  probaThrsldGrowthRate1_2Error20.insert(pair<double,int>(0.401877572, 59));
-  probaThrsldGrowthRate1_2Error20.insert(pair<double,int>(0.4822530864, 51));
-  probaThrsldGrowthRate1_2Error20.insert(pair<double,int>(0.5787037037, 42));
-  probaThrsldGrowthRate1_2Error20.insert(pair<double,int>(0.6944444444, 32));
-  probaThrsldGrowthRate1_2Error20.insert(pair<double,int>(0.8333333333, 17));
-  probaThrsldGrowthRate1_2Error20.insert(pair<double,int>(1, -1));
-
-  // growthRate 1.2
-  //  30% error threshold
-  //
-  probaThrsldGrowthRate1_2Error30.insert(pair<double,int>(0.0014108315, 45));
-  probaThrsldGrowthRate1_2Error30.insert(pair<double,int>(0.0016929978, 45));
-  probaThrsldGrowthRate1_2Error30.insert(pair<double,int>(0.0020315973, 45));
-  probaThrsldGrowthRate1_2Error30.insert(pair<double,int>(0.0024379168, 45));
-  probaThrsldGrowthRate1_2Error30.insert(pair<double,int>(0.0029255002, 45));
-  probaThrsldGrowthRate1_2Error30.insert(pair<double,int>(0.0035106002, 45));
-  probaThrsldGrowthRate1_2Error30.insert(pair<double,int>(0.0042127202, 45));
-  probaThrsldGrowthRate1_2Error30.insert(pair<double,int>(0.0050552643, 45));
-  probaThrsldGrowthRate1_2Error30.insert(pair<double,int>(0.0060663171, 45));
-  probaThrsldGrowthRate1_2Error30.insert(pair<double,int>(0.0072795806, 45));
-  probaThrsldGrowthRate1_2Error30.insert(pair<double,int>(0.0087354967, 45));
-  probaThrsldGrowthRate1_2Error30.insert(pair<double,int>(0.010482596, 45));
-  probaThrsldGrowthRate1_2Error30.insert(pair<double,int>(0.0125791152, 45));
-  probaThrsldGrowthRate1_2Error30.insert(pair<double,int>(0.0150949383, 45));
-  probaThrsldGrowthRate1_2Error30.insert(pair<double,int>(0.0181139259, 44));
-  probaThrsldGrowthRate1_2Error30.insert(pair<double,int>(0.0217367111, 44));
-  probaThrsldGrowthRate1_2Error30.insert(pair<double,int>(0.0260840533, 44));
-  probaThrsldGrowthRate1_2Error30.insert(pair<double,int>(0.031300864,  44));
-  probaThrsldGrowthRate1_2Error30.insert(pair<double,int>(0.0375610368, 44));
-  probaThrsldGrowthRate1_2Error30.insert(pair<double,int>(0.0450732441, 43));
-  probaThrsldGrowthRate1_2Error30.insert(pair<double,int>(0.0540878929, 43));
-  probaThrsldGrowthRate1_2Error30.insert(pair<double,int>(0.0649054715, 42));
-  probaThrsldGrowthRate1_2Error30.insert(pair<double,int>(0.0778865658, 42));
-  probaThrsldGrowthRate1_2Error30.insert(pair<double,int>(0.093463879, 41));
-  probaThrsldGrowthRate1_2Error30.insert(pair<double,int>(0.1121566548, 41));
-  probaThrsldGrowthRate1_2Error30.insert(pair<double,int>(0.1345879857, 40));
-  probaThrsldGrowthRate1_2Error30.insert(pair<double,int>(0.1615055829, 38));
-  probaThrsldGrowthRate1_2Error30.insert(pair<double,int>(0.1938066995, 37));
-  probaThrsldGrowthRate1_2Error30.insert(pair<double,int>(0.2325680394, 35));
-  probaThrsldGrowthRate1_2Error30.insert(pair<double,int>(0.2790816472, 33));
-  probaThrsldGrowthRate1_2Error30.insert(pair<double,int>(0.3348979767, 31));
-  probaThrsldGrowthRate1_2Error30.insert(pair<double,int>(0.401877572, 27));
-  probaThrsldGrowthRate1_2Error30.insert(pair<double,int>(0.4822530864, 25));
-  probaThrsldGrowthRate1_2Error30.insert(pair<double,int>(0.5787037037, 20));
-  probaThrsldGrowthRate1_2Error30.insert(pair<double,int>(0.6944444444, 14));
-  probaThrsldGrowthRate1_2Error30.insert(pair<double,int>(0.8333333333, 10));
-  probaThrsldGrowthRate1_2Error30.insert(pair<double,int>(1, -1));
+  if ( !ScenarioParameters::getDeden() ) {
+    return;
+  }
+
+  DedenThresholdSet_t selected = { nullptr, 0 };
+  if ( ScenarioParameters::getD1GrowRate() == (float)2) {
+    if ( ScenarioParameters::getD1ErrorMax() == 30 ) {
+      selected = dedenThresholdSet<20, 30>();
+    } else if ( ScenarioParameters::getD1ErrorMax() == 20 ) {
+      selected = dedenThresholdSet<20, 20>();
+    } else if ( ScenarioParameters::getD1ErrorMax() == 10 ) {
+      selected = dedenThresholdSet<20, 10>();
+    } else if ( ScenarioParameters::getD1ErrorMax() == 5 ) {
+      selected = dedenThresholdSet<20, 5>();
+    }
+  } else if ( ScenarioParameters::getD1GrowRate() == (float)1.6 ) {
+    if ( ScenarioParameters::getD1ErrorMax() == 30 ) {
+      selected = dedenThresholdSet<16, 30>();
+    } else if ( ScenarioParameters::getD1ErrorMax() == 20 ) {
+      selected = dedenThresholdSet<16, 20>();
+    } else if ( ScenarioParameters::getD1ErrorMax() == 10 ) {
+      selected = dedenThresholdSet<16, 10>();
+    } else if ( ScenarioParameters::getD1ErrorMax() == 5 ) {
+      selected = dedenThresholdSet<16, 5>();
+    }
+  } else if ( ScenarioParameters::getD1GrowRate() == (float)1.2 ) {
+    if ( ScenarioParameters::getD1ErrorMax() == 30 ) {
+      selected = dedenThresholdSet<12, 30>();
+    } else if ( ScenarioParameters::getD1ErrorMax() == 20 ) {
+      selected = dedenThresholdSet<12, 20>();
+    } else if ( ScenarioParameters::getD1ErrorMax() == 10 ) {
+      selected = dedenThresholdSet<12, 10>();
+    } else if ( ScenarioParameters::getD1ErrorMax() == 5 ) {
+      selected = dedenThresholdSet<12, 5>();
+    }
+  } else {
+    cout << "*** ERROR: invalid D1GrowthRate:" << ScenarioParameters::getD1GrowRate() << endl;
+    exit(EXIT_FAILURE);
+  }
+  if ( selected.thresholds == nullptr ) {
+    cout << "*** ERROR: invalid D1ErrorMax:" << ScenarioParameters::getD1ErrorMax() << endl;
+    exit(EXIT_FAILURE);
+  }
+
+  thresholds = selected.thresholds;
+  computedMaxRound = selected.rounds;
+
+  if ( ScenarioParameters::getDedenOracle() ) {
+    string error = ScenarioParameters::getDedenOracleError();
+    if ( error != "none" && error != "uniform" && error != "normal" ) {
+      cout << "*** ERROR: invalid DEDeN oracle error:" << error << " (none, uniform or normal)" << endl;
+      exit(EXIT_FAILURE);
+    }
+    oracleRandomGenerator = new mt19937_64(ScenarioParameters::getDedenRNGSeed());
+  }
+}
+
+// Hands the final estimation over to the node, as if the probing had just concluded
+void D11DensityEstimatorAgent::publishEstimation() {
+  hostNode->setEstimatedNeighbours((int)estimated);
+  // Uncomment to plug deden to the sleeping node system
+  if(SleepingNode* sleepingHostNode = dynamic_cast<SleepingNode*>(hostNode) ){
+    simulationTime_t t = 500000000000;
+    Scheduler::getScheduler().schedule(new sleepingSetUpEvent(t,sleepingHostNode));
+  }
+}
+
+// Oracle mode: no probe is sent, the estimation is the real neighbours count
+// with a relative error drawn within D1ErrorMax, the bound the threshold
+// tables are built for (uniform over [-e,e], or normal with e as 95% bound)
+void D11DensityEstimatorAgent::estimateFromOracle() {
+  alreadyWorking = true;
+  double errorMax = ScenarioParameters::getD1ErrorMax() / 100.0;
+  double relativeError = 0;
+
+  if ( ScenarioParameters::getDedenOracleError() == "uniform" ) {
+    uniform_real_distribution<double> errorRNG(-errorMax, errorMax);
+    relativeError = errorRNG(*oracleRandomGenerator);
+  } else if ( ScenarioParameters::getDedenOracleError() == "normal" ) {
+    normal_distribution<double> errorRNG(0, errorMax / 1.96);
+    relativeError = errorRNG(*oracleRandomGenerator);
+  }
+
+  estimated = round(hostNode->getNeighboursCount() * (1 + relativeError));
+  if (estimated < 0) estimated = 0;
+  publishEstimation();
 }
 
 void D11DensityEstimatorAgent::processPacketGenerationEvent() {
@@ -1029,12 +675,7 @@ void D11DensityEstimatorAgent::processPacketGenerationEvent() {
         //                                if (hostNode->getId() == nodeDisplayed) {
         //                                    cout << "=== node " << nodeDisplayed << " final estimation: " << estimated << " at round " << roundNumber << endl;
         //                                }
-        hostNode->setEstimatedNeighbours((int)estimated);
-        // Uncomment to plug deden to the sleeping node system
-        if(SleepingNode* sleepingHostNode = dynamic_cast<SleepingNode*>(hostNode) ){
-          simulationTime_t t = 500000000000;
-          Scheduler::getScheduler().schedule(new sleepingSetUpEvent(t,sleepingHostNode));
-        }
+        publishEstimation();
       }
     } //else {
     //      remainingFreeRounds--;
@@ -1045,10 +686,11 @@ void D11DensityEstimatorAgent::processPacketGenerationEvent() {
     }
     roundNumber++;
     ticInRound = 0;
-    current++;
-    probability=current->first;
-    minPacketsForTermination=current->second;
-    //                 if (hostNode->getId() == 22) LogSystem::SummarizeLog << "Node " << hostNode->getId() << " at " << Scheduler::now() << " changing to round " << roundNumber << " probability: " << current->first << endl;
+    if (roundNumber < maxRound) {
+      probability = thresholds[roundNumber].probability;
+      minPacketsForTermination = thresholds[roundNumber].minPacketsForTermination;
+    }
+    //                 if (hostNode->getId() == 22) LogSystem::SummarizeLog << "Node " << hostNode->getId() << " at " << Scheduler::now() << " changing to round " << roundNumber << " probability: " << probability << endl;
   }
   //if (roundNumber < maxRound && (remainingFreeRounds > 0) ) {
   if (roundNumber < maxRound && (estimated == -1 || remainingFreeRounds > 0) ) {
@@ -1071,7 +713,7 @@ void D11DensityEstimatorAgent::processPacketGenerationEvent() {
     }
     if (estimated != -1) remainingFreeRounds--;
     simulationTime_t t = Scheduler::now() + interval;
-    Scheduler::getScheduler().schedule(new D11DensityEstimatorGenerationEvent(t,this));
+    Scheduler::getScheduler().scheduleTimer(new D11DensityEstimatorGenerationEvent(t,this));
   }
         
   if ( remainingFreeRounds == 0 ){
@@ -1097,7 +739,7 @@ void D11DensityEstimatorAgent::receivePacket(PacketPtr _packet) {
     //cout << "Node " << hostNode->getId() << " initialization neighbours density estimation" << endl;
     alreadyWorking = true;
     simulationTime_t t = Scheduler::now();
-    Scheduler::getScheduler().schedule(new D11DensityEstimatorGenerationEvent(t,this));
+    Scheduler::getScheduler().scheduleTimer(new D11DensityEstimatorGenerationEvent(t,this));
   }
 
   int size = (int)vectProbesReceived.size();
@@ -22,6 +22,7 @@
 
 #include "events.h"
 #include "server-application-agent.h"
+#include "deden-thresholds.h"
 
 class D1DensityEstimatorAgent;
 class D11DensityEstimatorAgent;
@@ -180,26 +181,15 @@ protected:
         
   static ofstream estimationErrorFile;
 
+  static mt19937_64 *oracleRandomGenerator;
+
+  void publishEstimation();
+
 public:
   
   static int computedMaxRound;
 
-  static map <double,int> probaThrsldGrowthRate2Error5;
-  static map <double,int> probaThrsldGrowthRate2Error10;
-  static map <double,int> probaThrsldGrowthRate2Error20;
-  static map <double,int> probaThrsldGrowthRate2Error30;
-  static map <double,int> probaThrsldGrowthRate1_6Error5;
-  static map <double,int> probaThrsldGrowthRate1_6Error10;
-  static map <double,int> probaThrsldGrowthRate1_6Error20;
-  static map <double,int> probaThrsldGrowthRate1_6Error30;
-  static map <double,int> probaThrsldGrowthRate1_2Error5;
-  static map <double,int> probaThrsldGrowthRate1_2Error10;
-  static map <double,int> probaThrsldGrowthRate1_2Error20;
-  static map <double,int> probaThrsldGrowthRate1_2Error30;
-
-
-  map <double,int> probaThrsld;
-  map<double,int>::iterator current;
+  static const DedenThreshold_t *thresholds;  // indexed by round number, computedMaxRound entries
         
   D11DensityEstimatorAgent(Node *_hostNode, int _flowId, int _port, PacketType _packetType, simulationTime_t _interval, int _repetition, int _seed);
   virtual ~D11DensityEstimatorAgent();
@@ -210,6 +200,7 @@ public:
 
   virtual void receivePacket(PacketPtr _packet);
   void processPacketGenerationEvent();
+  void estimateFromOracle();
 };
 
 
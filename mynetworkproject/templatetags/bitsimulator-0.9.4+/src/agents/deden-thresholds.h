@@ -0,0 +1,533 @@
+/*
+ * Copyright (C) 2017-2019 Dominique Dhoutaut, Thierry Arrabal, Eugen Dedu.
+ *
+ * This file is part of BitSimulator.
+ *
+ * BitSimulator is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * BitSimulator is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with BitSimulator.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef DEDEN_THRESHOLDS_H_
+#define DEDEN_THRESHOLDS_H_
+
+//==============================================================================
+//
+//          DedenThreshold_t  (struct)
+//
+//==============================================================================
+
+// Parameters of one DEDeN round: probability for a node to send a probe, and
+// number of probes received above which the round estimation is kept as final
+// (-1 for the last round, which always concludes)
+typedef struct {
+  double probability;
+  int minPacketsForTermination;
+} DedenThreshold_t;
+
+//==============================================================================
+//
+//          DedenThresholdTable  (class template)
+//
+//==============================================================================
+
+// Thresholds indexed by round number, selected at compile time by the growth
+// rate (in tenths, i.e. 20 for 2.0) and the maximum estimation error (in %)
+template <int growthRateTenths, int errorMax>
+struct DedenThresholdTable;
+
+//
+// growthRate 2
+//  5% error threshold
+//
+template <>
+struct DedenThresholdTable<20, 5> {
+  static constexpr int rounds = 19;
+  static constexpr DedenThreshold_t thresholds[rounds] = {
+    { 0.000003814697265625, 1542 },
+    { 0.00000762939453125, 1542 },
+    { 0.0000152587890625, 1542 },
+    { 0.000030517578125, 1542 },
+    { 0.00006103515625, 1542 },
+    { 0.0001220703125, 1542 },
+    { 0.000244140625, 1542 },
+    { 0.00048828125, 1542 },
+    { 0.0009765625, 1542 },
+    { 0.001953125, 1540 },
+    { 0.00390625, 1535 },
+    { 0.0078125, 1530 },
+    { 0.015625, 1520 },
+    { 0.03125, 1500 },
+    { 0.0625, 1450 },
+    { 0.125, 1350 },
+    { 0.25, 1150 },
+    { 0.5, 760 },
+    { 1, -1 }
+  };
+};
+
+//
+// growthRate 2
+//  10% error threshold
+//
+template <>
+struct DedenThresholdTable<20, 10> {
+  static constexpr int rounds = 19;
+  static constexpr DedenThreshold_t thresholds[rounds] = {
+    { 0.000003814697265625, 387 },
+    { 0.00000762939453125, 387 },
+    { 0.0000152587890625, 387 },
+    { 0.000030517578125, 386 },
+    { 0.00006103515625, 386 },
+    { 0.0001220703125, 386 },
+    { 0.000244140625, 386 },
+    { 0.00048828125, 386 },
+    { 0.0009765625, 386 },
+    { 0.001953125, 386 },
+    { 0.00390625, 385 },
+    { 0.0078125, 384 },
+    { 0.015625, 380 },
+    { 0.03125, 375 },
+    { 0.0625, 362 },
+    { 0.125, 338 },
+    { 0.25, 288 },
+    { 0.5, 190 },
+    { 1, -1 }
+  };
+};
+
+//
+// growthRate 2
+//  20% error threshold
+//
+template <>
+struct DedenThresholdTable<20, 20> {
+  static constexpr int rounds = 19;
+  static constexpr DedenThreshold_t thresholds[rounds] = {
+    { 0.000003814697265625, 99 },
+    { 0.00000762939453125, 99 },
+    { 0.0000152587890625, 99 },
+    { 0.000030517578125, 99 },
+    { 0.00006103515625, 99 },
+    { 0.0001220703125, 99 },
+    { 0.000244140625, 99 },
+    { 0.00048828125, 99 },
+    { 0.0009765625, 98 },
+    { 0.001953125, 98 },
+    { 0.00390625, 98 },
+    { 0.0078125, 98 },
+    { 0.015625, 97 },
+    { 0.03125, 95 },
+    { 0.0625, 92 },
+    { 0.125, 86 },
+    { 0.25, 73 },
+    { 0.5, 48 },
+    { 1, -1 }
+  };
+};
+
+//
+// growthRate 2
+//  30% error threshold
+//
+template <>
+struct DedenThresholdTable<20, 30> {
+  static constexpr int rounds = 19;
+  static constexpr DedenThreshold_t thresholds[rounds] = {
+    { 0.000003814697265625, 45 },
+    { 0.00000762939453125, 45 },
+    { 0.0000152587890625, 45 },
+    { 0.000030517578125, 45 },
+    { 0.00006103515625, 45 },
+    { 0.0001220703125, 45 },
+    { 0.000244140625, 45 },
+    { 0.00048828125, 45 },
+    { 0.0009765625, 45 },
+    { 0.001953125, 45 },
+    { 0.00390625, 45 },
+    { 0.0078125, 45 },
+    { 0.015625, 45 },
+    { 0.03125, 44 },
+    { 0.0625, 42 },
+    { 0.125, 40 },
+    { 0.25, 34 },
+    { 0.5, 22 },
+    { 1, -1 }
+  };
+};
+
+//
+// growthRate 1.6
+//  5% error threshold
+//
+template <>
+struct DedenThresholdTable<16, 5> {
+  static constexpr int rounds = 28;
+  static constexpr DedenThreshold_t thresholds[rounds] = {
+    { 0.00000308148791101958, 1548 },
+    { 0.00000493038065763132, 1548 },
+    { 0.00000788860905221012, 1548 },
+    { 0.0000126217744835362, 1548 },
+    { 0.0000201948391736579, 1457 },
+    { 0.0000323117426778526, 1547 },
+    { 0.0000516987882845642, 1546 },
+    { 0.0000827180612553028, 1546 },
+    { 0.000132348898008, 1546 },
+    { 0.000211758236814, 1546 },
+    { 0.000338813178902, 1546 },
+    { 0.000542101086243, 1545 },
+    { 0.000867361737988, 1545 },
+    { 0.0013877788, 1545 },
+    { 0.002220446, 1544 },
+    { 0.0035527137, 1544 },
+    { 0.0056843419, 1543 },
+    { 0.009094947, 1542 },
+    { 0.0145519152, 1540 },
+    { 0.0232830644, 1535 },
+    { 0.037252903, 1530 },
+    { 0.0596046448, 1520 },
+    { 0.0953674316, 1500 },
+    { 0.1525878906, 1450 },
+    { 0.244140625, 1342 },
+    { 0.390625, 1150 },
+    { 0.625, 760 },
+    { 1, -1 }
+  };
+};
+
+//
+// growthRate 1.6
+//  10% error threshold
+//
+template <>
+struct DedenThresholdTable<16, 10> {
+  static constexpr int rounds = 28;
+  static constexpr DedenThreshold_t thresholds[rounds] = {
+    { 0.00000308148791101958, 387 },
+    { 0.00000493038065763132, 387 },
+    { 0.00000788860905221012, 387 },
+    { 0.0000126217744835362, 387 },
+    { 0.0000201948391736579, 387 },
+    { 0.0000323117426778526, 387 },
+    { 0.0000516987882845642, 387 },
+    { 0.0000827180612553028, 387 },
+    { 0.000132348898008, 387 },
+    { 0.000211758236814, 387 },
+    { 0.000338813178902, 387 },
+    { 0.000542101086243, 387 },
+    { 0.000867361737988, 387 },
+    { 0.0013877788, 386 },
+    { 0.002220446, 386 },
+    { 0.0035527137, 385 },
+    { 0.0056843419, 384 },
+    { 0.009094947, 383 },
+    { 0.0145519152, 381 },
+    { 0.0232830644, 377 },
+    { 0.037252903, 372 },
+    { 0.0596046448, 364 },
+    { 0.0953674316, 350 },
+    { 0.1525878906, 327 },
+    { 0.244140625, 291 },
+    { 0.390625, 235 },
+    { 0.625, 139 },
+    { 1, -1 }
+  };
+};
+
+//
+// growthRate 1.6
+//  20% error threshold
+//
+template <>
+struct DedenThresholdTable<16, 20> {
+  static constexpr int rounds = 28;
+  static constexpr DedenThreshold_t thresholds[rounds] = {
+    { 0.00000308148791101958, 99 },
+    { 0.00000493038065763132, 99 },
+    { 0.00000788860905221012, 99 },
+    { 0.0000126217744835362, 99 },
+    { 0.0000201948391736579, 99 },
+    { 0.0000323117426778526, 99 },
+    { 0.0000516987882845642, 99 },
+    { 0.0000827180612553028, 99 },
+    { 0.000132348898008, 99 },
+    { 0.000211758236814, 99 },
+    { 0.000338813178902, 99 },
+    { 0.000542101086243, 99 },
+    { 0.000867361737988, 98 },
+    { 0.0013877788, 98 },
+    { 0.002220446, 98 },
+    { 0.0035527137, 98 },
+    { 0.0056843419, 98 },
+    { 0.009094947, 98 },
+    { 0.0145519152, 97 },
+    { 0.0232830644, 96 },
+    { 0.037252903, 95 },
+    { 0.0596046448, 93 },
+    { 0.0953674316, 89 },
+    { 0.1525878906, 84 },
+    { 0.244140625, 74 },
+    { 0.390625, 59 },
+    { 0.625, 35 },
+    { 1, -1 }
+  };
+};
+
+//
+// growthRate 1.6
+//  30% error threshold
+//
+template <>
+struct DedenThresholdTable<16, 30> {
+  static constexpr int rounds = 28;
+  static constexpr DedenThreshold_t thresholds[rounds] = {
+    { 0.00000308148791101958, 45 },
+    { 0.00000493038065763132, 45 },
+    { 0.00000788860905221012, 45 },
+    { 0.0000126217744835362, 45 },
+    { 0.0000201948391736579, 45 },
+    { 0.0000323117426778526, 45 },
+    { 0.0000516987882845642, 45 },
+    { 0.0000827180612553028, 45 },
+    { 0.000132348898008, 45 },
+    { 0.000211758236814, 45 },
+    { 0.000338813178902, 45 },
+    { 0.000542101086243, 45 },
+    { 0.000867361737988, 45 },
+    { 0.0013877788, 45 },
+    { 0.002220446, 45 },
+    { 0.0035527137, 45 },
+    { 0.0056843419, 45 },
+    { 0.009094947, 45 },
+    { 0.0145519152, 45 },
+    { 0.0232830644, 44 },
+    { 0.037252903, 44 },
+    { 0.0596046448, 43 },
+    { 0.0953674316, 41 },
+    { 0.1525878906, 38 },
+    { 0.244140625, 35 },
+    { 0.390625, 28 },
+    { 0.625, 17 },
+    { 1, -1 }
+  };
+};
+
+//
+// growthRate 1.2
+//  5% error threshold
+//
+template <>
+struct DedenThresholdTable<12, 5> {
+  static constexpr int rounds = 37;
+  static constexpr DedenThreshold_t thresholds[rounds] = {
+    { 0.0014108315, 1550 },
+    { 0.0016929978, 1549 },
+    { 0.0020315973, 1549 },
+    { 0.0024379168, 1548 },
+    { 0.0029255002, 1547 },
+    { 0.0035106002, 1546 },
+    { 0.0042127202, 1545 },
+    { 0.0050552643, 1544 },
+    { 0.0060663171, 1542 },
+    { 0.0072795806, 1541 },
+    { 0.0087354967, 1540 },
+    { 0.010482596, 1539 },
+    { 0.0125791152, 1537 },
+    { 0.0150949383, 1535 },
+    { 0.0181139259, 1530 },
+    { 0.0217367111, 1525 },
+    { 0.0260840533, 1520 },
+    { 0.031300864, 1510 },
+    { 0.0375610368, 1500 },
+    { 0.0450732441, 1490 },
+    { 0.0540878929, 1480 },
+    { 0.0649054715, 1460 },
+    { 0.0778865658, 1440 },
+    { 0.093463879, 1420 },
+    { 0.1121566548, 1380 },
+    { 0.1345879857, 1350 },
+    { 0.1615055829, 1300 },
+    { 0.1938066995, 1250 },
+    { 0.2325680394, 1180 },
+    { 0.2790816472, 1100 },
+    { 0.3348979767, 1019 },
+    { 0.401877572, 917 },
+    { 0.4822530864, 791 },
+    { 0.5787037037, 640 },
+    { 0.6944444444, 471 },
+    { 0.8333333333, 235 },
+    { 1.0, -1 }
+  };
+};
+
+//
+// growthRate 1.2
+//  10% error threshold
+//
+template <>
+struct DedenThresholdTable<12, 10> {
+  static constexpr int rounds = 37;
+  static constexpr DedenThreshold_t thresholds[rounds] = {
+    { 0.0014108315, 386 },
+    { 0.0016929978, 386 },
+    { 0.0020315973, 386 },
+    { 0.0024379168, 386 },
+    { 0.0029255002, 385 },
+    { 0.0035106002, 385 },
+    { 0.0042127202, 385 },
+    { 0.0050552643, 385 },
+    { 0.0060663171, 384 },
+    { 0.0072795806, 384 },
+    { 0.0087354967, 383 },
+    { 0.010482596, 382 },
+    { 0.0125791152, 382 },
+    { 0.0150949383, 381 },
+    { 0.0181139259, 379 },
+    { 0.0217367111, 378 },
+    { 0.0260840533, 376 },
+    { 0.031300864, 375 },
+    { 0.0375610368, 372 },
+    { 0.0450732441, 369 },
+    { 0.0540878929, 366 },
+    { 0.0649054715, 366 },
+    { 0.0778865658, 356 },
+    { 0.093463879, 350 },
+    { 0.1121566548, 343 },
+    { 0.1345879857, 333 },
+    { 0.1615055829, 324 },
+    { 0.1938066995, 311 },
+    { 0.2325680394, 296 },
+    { 0.2790816472, 277 },
+    { 0.3348979767, 255 },
+    { 0.401877572, 230 },
+    { 0.4822530864, 198 },
+    { 0.5787037037, 157 },
+    { 0.6944444444, 112 },
+    { 0.8333333333, 60 },
+    { 1, -1 }
+  };
+};
+
+//
+// growthRate 1.2
+//  20% error threshold
+//
+template <>
+struct DedenThresholdTable<12, 20> {
+  static constexpr int rounds = 37;
+  static constexpr DedenThreshold_t thresholds[rounds] = {
+    { 0.0014108315, 98 },
+    { 0.0016929978, 98 },
+    { 0.0020315973, 98 },
+    { 0.0024379168, 98 },
+    { 0.0029255002, 98 },
+    { 0.0035106002, 98 },
+    { 0.0042127202, 98 },
+    { 0.0050552643, 98 },
+    { 0.0060663171, 98 },
+    { 0.0072795806, 98 },
+    { 0.0087354967, 98 },
+    { 0.010482596, 98 },
+    { 0.0125791152, 97 },
+    { 0.0150949383, 97 },
+    { 0.0181139259, 97 },
+    { 0.0217367111, 96 },
+    { 0.0260840533, 96 },
+    { 0.031300864, 95 },
+    { 0.0375610368, 95 },
+    { 0.0450732441, 94 },
+    { 0.0540878929, 93 },
+    { 0.0649054715, 92 },
+    { 0.0778865658, 91 },
+    { 0.093463879, 89 },
+    { 0.1121566548, 87 },
+    { 0.1345879857, 85 },
+    { 0.1615055829, 83 },
+    { 0.1938066995, 79 },
+    { 0.2325680394, 75 },
+    { 0.2790816472, 72 },
+    { 0.3348979767, 64 },
+    { 0.401877572, 59 },
+    { 0.4822530864, 51 },
+    { 0.5787037037, 42 },
+    { 0.6944444444, 32 },
+    { 0.8333333333, 17 },
+    { 1, -1 }
+  };
+};
+
+//
+// growthRate 1.2
+//  30% error threshold
+//
+template <>
+struct DedenThresholdTable<12, 30> {
+  static constexpr int rounds = 37;
+  static constexpr DedenThreshold_t thresholds[rounds] = {
+    { 0.0014108315, 45 },
+    { 0.0016929978, 45 },
+    { 0.0020315973, 45 },
+    { 0.0024379168, 45 },
+    { 0.0029255002, 45 },
+    { 0.0035106002, 45 },
+    { 0.0042127202, 45 },
+    { 0.0050552643, 45 },
+    { 0.0060663171, 45 },
+    { 0.0072795806, 45 },
+    { 0.0087354967, 45 },
+    { 0.010482596, 45 },
+    { 0.0125791152, 45 },
+    { 0.0150949383, 45 },
+    { 0.0181139259, 44 },
+    { 0.0217367111, 44 },
+    { 0.0260840533, 44 },
+    { 0.031300864, 44 },
+    { 0.0375610368, 44 },
+    { 0.0450732441, 43 },
+    { 0.0540878929, 43 },
+    { 0.0649054715, 42 },
+    { 0.0778865658, 42 },
+    { 0.093463879, 41 },
+    { 0.1121566548, 41 },
+    { 0.1345879857, 40 },
+    { 0.1615055829, 38 },
+    { 0.1938066995, 37 },
+    { 0.2325680394, 35 },
+    { 0.2790816472, 33 },
+    { 0.3348979767, 31 },
+    { 0.401877572, 27 },
+    { 0.4822530864, 25 },
+    { 0.5787037037, 20 },
+    { 0.6944444444, 14 },
+    { 0.8333333333, 10 },
+    { 1, -1 }
+  };
+};
+
+//==============================================================================
+//
+//          DedenThresholdSet_t  (struct)
+//
+//==============================================================================
+
+// Runtime view of one of the tables above
+typedef struct {
+  const DedenThreshold_t *thresholds;
+  int rounds;
+} DedenThresholdSet_t;
+
+template <int growthRateTenths, int errorMax>
+constexpr DedenThresholdSet_t dedenThresholdSet() {
+  return { DedenThresholdTable<growthRateTenths, errorMax>::thresholds, DedenThresholdTable<growthRateTenths, errorMax>::rounds };
+}
+
+#endif /* DEDEN_THRESHOLDS_H_ */
@@ -0,0 +1,112 @@
+/*
+ * Copyright (C) 2017-2019 Dominique Dhoutaut, Thierry Arrabal, Eugen Dedu.
+ *
+ * This file is part of BitSimulator.
+ *
+ * BitSimulator is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * BitSimulator is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with BitSimulator.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <cmath>
+
+#include "delay-statistics.h"
+
+
+//==============================================================================
+//
+//          DelayStatistics  (class)
+//
+//==============================================================================
+
+static const double relativeAccuracy = 0.01;
+static const double bucketGamma = (1 + relativeAccuracy) / (1 - relativeAccuracy);
+static const double logBucketGamma = log(bucketGamma);
+
+DelayStatistics::DelayStatistics() {
+  count = 0;
+  sum = 0;
+  min = 0;
+  max = 0;
+  zeroCount = 0;
+  firstBucket = 0;
+}
+
+int DelayStatistics::bucketIndex(simulationTime_t _delay) {
+  return (int)ceil(log((double)_delay) / logBucketGamma);
+}
+
+simulationTime_t DelayStatistics::bucketValue(int _index) {
+  // middle of ]gamma^(i-1), gamma^i], relative error below relativeAccuracy
+  return (simulationTime_t)llround(2 * pow(bucketGamma, _index) / (bucketGamma + 1));
+}
+
+void DelayStatistics::addToBucket(int _index, uint64_t _n) {
+  if (buckets.empty()) {
+    firstBucket = _index;
+    buckets.push_back(0);
+  } else if (_index < firstBucket) {
+    buckets.insert(buckets.begin(), firstBucket - _index, 0);
+    firstBucket = _index;
+  } else if (_index >= firstBucket + (int)buckets.size()) {
+    buckets.resize(_index - firstBucket + 1, 0);
+  }
+  buckets[_index - firstBucket] += _n;
+}
+
+void DelayStatistics::add(simulationTime_t _delay) {
+  if (count == 0 || _delay < min)
+    min = _delay;
+  if (count == 0 || _delay > max)
+    max = _delay;
+  count++;
+  sum += _delay;
+
+  if (_delay <= 0)
+    zeroCount++;
+  else
+    addToBucket(bucketIndex(_delay), 1);
+}
+
+void DelayStatistics::merge(const DelayStatistics &_other) {
+  if (_other.count == 0)
+    return;
+  if (count == 0 || _other.min < min)
+    min = _other.min;
+  if (count == 0 || _other.max > max)
+    max = _other.max;
+  count += _other.count;
+  sum += _other.sum;
+
+  zeroCount += _other.zeroCount;
+  for (size_t i = 0; i < _other.buckets.size(); i++)
+    if (_other.buckets[i] != 0)
+      addToBucket(_other.firstBucket + (int)i, _other.buckets[i]);
+}
+
+simulationTime_t DelayStatistics::getQuantile(double _q) const {
+  if (count == 0)
+    return 0;
+  uint64_t rank = (uint64_t)(_q * (count - 1));
+  if (rank < zeroCount)
+    return 0;
+  uint64_t seen = zeroCount;
+  for (size_t i = 0; i < buckets.size(); i++) {
+    seen += buckets[i];
+    if (seen > rank) {
+      simulationTime_t value = bucketValue(firstBucket + (int)i);
+      // the extreme buckets are bounded by the exact min and max
+      return value < min ? min : (value > max ? max : value);
+    }
+  }
+  return max;
+}
@@ -0,0 +1,73 @@
+/*
+ * Copyright (C) 2017-2019 Dominique Dhoutaut, Thierry Arrabal, Eugen Dedu.
+ *
+ * This file is part of BitSimulator.
+ *
+ * BitSimulator is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * BitSimulator is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with BitSimulator.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef AGENTS_DELAY_STATISTICS_H_
+#define AGENTS_DELAY_STATISTICS_H_
+
+#include <cstdint>
+#include <vector>
+
+#include "utils.h"
+
+using namespace std;
+
+
+//===========================================================================================================
+//
+//          DelayStatistics  (class)
+//
+//===========================================================================================================
+
+// Streaming summary of packet delays: count, mean, min and max, plus a
+// quantile sketch.  The sketch counts delays in logarithmic buckets, so any
+// quantile is returned with a relative error below 1%.  Two
+// summaries can be merged, the cost depends on the number of buckets and
+// not on the number of delays.
+
+class DelayStatistics {
+private:
+  uint64_t count;
+  double sum;
+  simulationTime_t min;
+  simulationTime_t max;
+
+  uint64_t zeroCount;          // delays equal to 0, they have no bucket
+  int firstBucket;             // bucket index of buckets[0]
+  vector<uint64_t> buckets;
+
+  static int bucketIndex(simulationTime_t _delay);
+  static simulationTime_t bucketValue(int _index);
+  void addToBucket(int _index, uint64_t _n);
+
+public:
+  DelayStatistics();
+
+  void add(simulationTime_t _delay);
+  void merge(const DelayStatistics &_other);
+
+  uint64_t getCount() const { return count; }
+  double getMean() const { return count == 0 ? 0 : sum / count; }
+  simulationTime_t getMin() const { return min; }
+  simulationTime_t getMax() const { return max; }
+  // _q in [0,1]
+  simulationTime_t getQuantile(double _q) const;
+};
+
+
+#endif /* AGENTS_DELAY_STATISTICS_H_ */
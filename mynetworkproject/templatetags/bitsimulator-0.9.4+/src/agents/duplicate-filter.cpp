@@ -0,0 +1,124 @@
+/*
+ * Copyright (C) 2017-2019 Dominique Dhoutaut, Thierry Arrabal, Eugen Dedu.
+ *
+ * This file is part of BitSimulator.
+ *
+ * BitSimulator is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * BitSimulator is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with BitSimulator.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "duplicate-filter.h"
+
+
+//==============================================================================
+//
+//          DuplicateFilter  (class)
+//
+//==============================================================================
+
+DuplicateFilter::DuplicateFilter() {
+  shift = 32;
+  count = 0;
+}
+
+size_t DuplicateFilter::slotIndex(int _key) const {
+  // Fibonacci hashing, flow ids and node ids are small and often consecutive:
+  // the top log2(slots.size()) bits of key * 2^32/phi
+  return (size_t)(((uint32_t)_key * 2654435769u) >> shift);
+}
+
+const DuplicateFilter::DuplicateFilterEntry_t *DuplicateFilter::find(int _key) const {
+  if (count == 0)
+    return nullptr;
+  for (size_t i = slotIndex(_key); ; i = (i + 1) & (slots.size() - 1)) {
+    if (slots[i].window == 0)
+      return nullptr;
+    if (slots[i].key == _key)
+      return &slots[i];
+  }
+}
+
+DuplicateFilter::DuplicateFilterEntry_t &DuplicateFilter::findOrAdd(int _key, bool &_added) {
+  // keep the load factor under 1/2
+  if (2 * (count + 1) > slots.size())
+    grow();
+  size_t i = slotIndex(_key);
+  while (slots[i].window != 0) {
+    if (slots[i].key == _key) {
+      _added = false;
+      return slots[i];
+    }
+    i = (i + 1) & (slots.size() - 1);
+  }
+  _added = true;
+  count++;
+  slots[i].key = _key;
+  return slots[i];
+}
+
+void DuplicateFilter::grow() {
+  vector<DuplicateFilterEntry_t> oldSlots(slots.size() == 0 ? 8 : 2 * slots.size(), {0, 0, 0});
+  oldSlots.swap(slots);
+  shift = 32;
+  for (size_t n = slots.size(); n > 1; n >>= 1)
+    shift--;
+  for (auto &entry : oldSlots) {
+    if (entry.window == 0)
+      continue;
+    size_t i = slotIndex(entry.key);
+    while (slots[i].window != 0)
+      i = (i + 1) & (slots.size() - 1);
+    slots[i] = entry;
+  }
+}
+
+bool DuplicateFilter::isNewer(int _key, int _sequenceNumber) const {
+  const DuplicateFilterEntry_t *entry = find(_key);
+  return entry == nullptr || _sequenceNumber > entry->latest;
+}
+
+bool DuplicateFilter::contains(int _key, int _sequenceNumber) const {
+  const DuplicateFilterEntry_t *entry = find(_key);
+  if (entry == nullptr || _sequenceNumber > entry->latest)
+    return false;
+  int64_t age = (int64_t)entry->latest - _sequenceNumber;
+  if (age >= WINDOW_SIZE)
+    return true;
+  return (entry->window >> age) & 1;
+}
+
+void DuplicateFilter::insert(int _key, int _sequenceNumber) {
+  bool added;
+  DuplicateFilterEntry_t &entry = findOrAdd(_key, added);
+  if (added) {
+    entry.latest = _sequenceNumber;
+    entry.window = 1;
+  } else if (_sequenceNumber > entry.latest) {
+    int64_t shift = (int64_t)_sequenceNumber - entry.latest;
+    entry.window = (shift >= WINDOW_SIZE) ? 1 : (entry.window << shift) | 1;
+    entry.latest = _sequenceNumber;
+  } else {
+    int64_t age = (int64_t)entry.latest - _sequenceNumber;
+    if (age < WINDOW_SIZE)
+      entry.window |= (uint64_t)1 << age;
+  }
+}
+
+void DuplicateFilter::insertIfAbsent(int _key, int _sequenceNumber) {
+  bool added;
+  DuplicateFilterEntry_t &entry = findOrAdd(_key, added);
+  if (added) {
+    entry.latest = _sequenceNumber;
+    entry.window = 1;
+  }
+}
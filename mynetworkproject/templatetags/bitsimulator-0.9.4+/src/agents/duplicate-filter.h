@@ -0,0 +1,76 @@
+/*
+ * Copyright (C) 2017-2019 Dominique Dhoutaut, Thierry Arrabal, Eugen Dedu.
+ *
+ * This file is part of BitSimulator.
+ *
+ * BitSimulator is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * BitSimulator is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with BitSimulator.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef AGENTS_DUPLICATE_FILTER_H_
+#define AGENTS_DUPLICATE_FILTER_H_
+
+#include <cstdint>
+#include <vector>
+
+using namespace std;
+
+
+//===========================================================================================================
+//
+//          DuplicateFilter  (class)
+//
+//===========================================================================================================
+
+// Per-node record of already seen packets, keyed by (srcId or flowId,
+// sequence number).  Keys are stored in an open-addressing table; for each
+// key, the highest sequence number seen and a bitmap of the previous
+// WINDOW_SIZE ones are kept.  Sequence numbers older than the window are
+// considered as already seen.
+
+class DuplicateFilter {
+private:
+  static const int WINDOW_SIZE = 64;
+
+  typedef struct {
+    int key;
+    int latest;       // highest sequence number seen
+    uint64_t window;  // bit i set: latest-i seen; 0 for an empty slot
+  } DuplicateFilterEntry_t;
+
+  vector<DuplicateFilterEntry_t> slots;  // size is 2^(32-shift)
+  int shift;
+  size_t count;
+
+  size_t slotIndex(int _key) const;
+  const DuplicateFilterEntry_t *find(int _key) const;
+  DuplicateFilterEntry_t &findOrAdd(int _key, bool &_added);
+  void grow();
+
+public:
+  DuplicateFilter();
+
+  // true if nothing was seen for this key, or only lower sequence numbers
+  bool isNewer(int _key, int _sequenceNumber) const;
+  // true if this exact sequence number was seen for this key
+  bool contains(int _key, int _sequenceNumber) const;
+  void insert(int _key, int _sequenceNumber);
+  // records _sequenceNumber only if nothing was seen yet for this key, as
+  // map::insert did for the agents keeping a single sequence number per flow
+  void insertIfAbsent(int _key, int _sequenceNumber);
+
+  size_t size() const { return count; }
+};
+
+
+#endif /* AGENTS_DUPLICATE_FILTER_H_ */
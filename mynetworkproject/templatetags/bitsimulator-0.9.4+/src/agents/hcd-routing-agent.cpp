@@ -29,7 +29,6 @@
 //==============================================================================
 
 ofstream HCDRoutingAgent::HCDPositionsFile;
-mt19937_64 *HCDRoutingAgent::forwardingRNG =  new mt19937_64(1);
 int HCDRoutingAgent::currentAnchorID = 0;
 int HCDRoutingAgent::forwardedHCDBeacons = 0;
 
@@ -131,11 +130,8 @@ void HCDRoutingAgent::receivePacketFromNetwork(PacketPtr _packet) {
   bool alreadySeen = false;
   bool update = false;
   bool forward = false;
-  auto it =alreadyForwardedPackets.find(_packet->flowId);
-  if ( it != alreadyForwardedPackets.end() ){ // Flow already followed
-    if ( it->second >= _packet->flowSequenceNumber ){ // The last seen packet from is flow is newer than the received one
-      alreadySeen = true;
-    }
+  if ( !alreadyForwardedPackets.isNewer(_packet->flowId, _packet->flowSequenceNumber) ){ // The last seen packet from this flow is newer than the received one
+    alreadySeen = true;
   }
 
   //                 if (_packet->needAck && isAck(_packet)){
@@ -144,7 +140,7 @@ void HCDRoutingAgent::receivePacketFromNetwork(PacketPtr _packet) {
     hostNode->dispatchPacketToApplication(_packet);
     //PacketPtr newPacket(new Packet(_packet));
     PacketPtr newPacket(_packet->clone());
-    alreadyForwardedPackets.insert(pair<int,int>(_packet->flowId,_packet->flowSequenceNumber));
+    alreadyForwardedPackets.insertIfAbsent(_packet->flowId,_packet->flowSequenceNumber);
     hostNode->enqueueOutgoingPacket(newPacket);
     LogSystem::EventsLogOutput.log( LogSystem::routingSND, Scheduler::now(),hostNode->getId(),(int) newPacket->type);
 
@@ -183,12 +179,7 @@ void HCDRoutingAgent::receivePacketFromNetwork(PacketPtr _packet) {
     //                     getchar();
     if ( HCDForward(_packet) && isCloser(_packet) ){
       forward = true;
-      auto it =alreadyForwardedPackets.find(_packet->flowId);
-      if (it != alreadyForwardedPackets.end()){
-        it->second = _packet->flowSequenceNumber ;
-      } else {
-        alreadyForwardedPackets.insert(pair<int,int>(_packet->flowId,_packet->flowSequenceNumber));
-      }
+      alreadyForwardedPackets.insert(_packet->flowId,_packet->flowSequenceNumber);
       //                      cout << " forwarding packet " <<  _packet->flowSequenceNumber << " on node " << hostNode->getId() << endl;
 
     }
@@ -46,7 +46,6 @@ protected:
 
   static int currentAnchorID;
 
-  static mt19937_64 *forwardingRNG;
   bool initialisationStarted;
 
   static int forwardedHCDBeacons;
@@ -61,7 +60,7 @@ public:
   virtual void receivePacketFromNetwork(PacketPtr _packet);
   virtual void receivePacketFromApplication(PacketPtr _packet);
 
-  map<int,int> alreadyForwardedPackets;
+  DuplicateFilter alreadyForwardedPackets;
   int anchorID;
 
   int getSLRX() { return(HCDCoordX); }
@@ -223,7 +223,7 @@ IncidentObserverAgent::IncidentObserverAgent(Node *_hostNode,
 
 void IncidentObserverAgent::scheduleObservation(simulationTime_t at) {
   simulationTime_t t = Scheduler::now() + at;
-  Scheduler::getScheduler().schedule(new IncidentObservationEvent(t, this));
+  Scheduler::getScheduler().scheduleTimer(new IncidentObservationEvent(t, this));
 }
 
 void IncidentObserverAgent::observeIncident() {
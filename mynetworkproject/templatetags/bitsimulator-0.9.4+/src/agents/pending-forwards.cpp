@@ -0,0 +1,78 @@
+/*
+ * Copyright (C) 2017-2019 Dominique Dhoutaut, Thierry Arrabal, Eugen Dedu.
+ *
+ * This file is part of BitSimulator.
+ *
+ * BitSimulator is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * BitSimulator is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with BitSimulator.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+
+#include "pending-forwards.h"
+#include "scheduler.h"
+
+
+//==============================================================================
+//
+//          PendingForwards  (class)
+//
+//==============================================================================
+
+PendingForwards::PendingForward_t *PendingForwards::find(int _packetId) {
+  auto it = byPacketId.find(_packetId);
+  return it == byPacketId.end() ? nullptr : &it->second;
+}
+
+PendingForwards::PendingForward_t *PendingForwards::findByFlow(int _flowId, int _sequenceNumber) {
+  auto it = byFlow.find(flowKey(_flowId, _sequenceNumber));
+  if (it == byFlow.end())
+    return nullptr;
+  return &byPacketId.find(it->second.front())->second;
+}
+
+void PendingForwards::insert(PacketPtr _packet, EventPtr _timer) {
+  PendingForward_t info;
+  info.p = _packet;
+  info.counter = 1;
+  info.timer = _timer;
+  if (!byPacketId.insert(pair<int,PendingForward_t>(_packet->packetId, info)).second)
+    return;
+
+  // packet ids are allocated in increasing order, so this is almost always
+  // an append
+  vector<int> &ids = byFlow[flowKey(_packet->flowId, _packet->flowSequenceNumber)];
+  ids.insert(upper_bound(ids.begin(), ids.end(), _packet->packetId), _packet->packetId);
+}
+
+void PendingForwards::erase(int _packetId) {
+  PendingForward_t entry;
+  if (take(_packetId, entry))
+    Scheduler::getScheduler().cancel(entry.timer.lock());
+}
+
+bool PendingForwards::take(int _packetId, PendingForward_t &_entry) {
+  auto it = byPacketId.find(_packetId);
+  if (it == byPacketId.end())
+    return false;
+
+  auto flowIt = byFlow.find(flowKey(it->second.p->flowId, it->second.p->flowSequenceNumber));
+  vector<int> &ids = flowIt->second;
+  ids.erase(lower_bound(ids.begin(), ids.end(), _packetId));
+  if (ids.empty())
+    byFlow.erase(flowIt);
+
+  _entry = move(it->second);
+  byPacketId.erase(it);
+  return true;
+}
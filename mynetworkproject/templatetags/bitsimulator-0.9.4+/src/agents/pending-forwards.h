@@ -0,0 +1,78 @@
+/*
+ * Copyright (C) 2017-2019 Dominique Dhoutaut, Thierry Arrabal, Eugen Dedu.
+ *
+ * This file is part of BitSimulator.
+ *
+ * BitSimulator is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * BitSimulator is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with BitSimulator.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef AGENTS_PENDING_FORWARDS_H_
+#define AGENTS_PENDING_FORWARDS_H_
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include "utils.h"
+#include "packet.h"
+#include "events.h"
+
+using namespace std;
+
+
+//===========================================================================================================
+//
+//          PendingForwards  (class)
+//
+//===========================================================================================================
+
+// Packets waiting for their backoff timer to expire, with the number of
+// copies heard meanwhile.  Entries are reachable by packet id (the backoff
+// timer callback) and by (flowId, flowSequenceNumber) (a new copy is
+// received).  Several entries may share a flow key, e.g. SLR beacons
+// forwarded again after an update; the lookup by flow returns the oldest one.
+// Each entry keeps its backoff timer, cancelled when the entry is erased.
+
+class PendingForwards {
+public:
+  typedef struct {
+    PacketPtr p;
+    int counter;  // number of copies heard, including the one scheduled
+    weak_ptr<Event> timer;
+  } PendingForward_t;
+
+private:
+  unordered_map<int,PendingForward_t> byPacketId;
+  unordered_map<uint64_t,vector<int>> byFlow;  // packet ids, increasing
+
+  static uint64_t flowKey(int _flowId, int _sequenceNumber) {
+    return ((uint64_t)(uint32_t)_flowId << 32) | (uint32_t)_sequenceNumber;
+  }
+
+public:
+  PendingForward_t *find(int _packetId);
+  PendingForward_t *findByFlow(int _flowId, int _sequenceNumber);
+
+  void insert(PacketPtr _packet, EventPtr _timer);
+  // Removes the entry and cancels its timer
+  void erase(int _packetId);
+  // Moves the entry out of the store, for the backoff timer callback
+  bool take(int _packetId, PendingForward_t &_entry);
+
+  size_t size() const { return byPacketId.size(); }
+  bool empty() const { return byPacketId.empty(); }
+};
+
+
+#endif /* AGENTS_PENDING_FORWARDS_H_ */
@@ -27,7 +27,6 @@
 //
 //==============================================================================
 
-mt19937_64 *ProbaFloodingRingRoutingAgent::forwardingRNG =  new mt19937_64(2);
 set<int> ProbaFloodingRingRoutingAgent::reachability = set<int>();
 
 ProbaFloodingRingRoutingAgent::ProbaFloodingRingRoutingAgent(Node *_hostNode) : RoutingAgent(_hostNode) {
@@ -86,21 +85,12 @@ void ProbaFloodingRingRoutingAgent::receivePacketFromNetwork(PacketPtr _packet)
     return;
 
   bool fw = false;
-  auto srcIt = alreadySeenPackets.find(_packet->srcId);
-  if (srcIt != alreadySeenPackets.end()) {
-    // already seen
-    if (_packet->srcSequenceNumber > srcIt->second && _packet->type == PacketType::DATA) {
-      // the source sequence number of this packet is higher than the highest already seen from this source
-      srcIt->second = _packet->srcSequenceNumber;
-      fw = true;
-    }
-  } else {
-    if (_packet->type == PacketType::DATA) {
-    // seen for the first time
-    alreadySeenPackets.insert(pair<int,int>(_packet->srcId, _packet->srcSequenceNumber));
+  // seen for the first time, or the source sequence number of this packet is
+  // higher than the highest already seen from this source
+  if (alreadySeenPackets.isNewer(_packet->srcId, _packet->srcSequenceNumber) && _packet->type == PacketType::DATA) {
+    alreadySeenPackets.insert(_packet->srcId, _packet->srcSequenceNumber);
     fw = true;
   }
-}
 
    if (_packet->type == PacketType::CONTROL_1 || _packet->type == PacketType::CONTROL_2) {
 	fw = true;
@@ -108,7 +98,8 @@ void ProbaFloodingRingRoutingAgent::receivePacketFromNetwork(PacketPtr _packet)
 
 
   uniform_real_distribution<float> distrib(0, 1);
-  float forwardingProbabilityNumber = distrib(*forwardingRNG);
+  CounterRNG forwardingRNG = getForwardingRNG(forwardingRNGSeed);
+  float forwardingProbabilityNumber = distrib(forwardingRNG);
 
   float forwadingProbability;
   forwadingProbability = 0.2;
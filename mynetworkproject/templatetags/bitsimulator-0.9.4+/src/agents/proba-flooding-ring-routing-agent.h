@@ -36,9 +36,9 @@ typedef struct {
 
 class ProbaFloodingRingRoutingAgent : public RoutingAgent {
 protected:
-  map<int,int> alreadySeenPackets;
+  DuplicateFilter alreadySeenPackets;
   map<int, Controlll12_t> ring;
-  static mt19937_64 *forwardingRNG;
+  static const int forwardingRNGSeed = 2;
   static set<int> reachability;
 
   bool alreadySent1and2;
@@ -27,7 +27,6 @@
 //
 //==============================================================================
 
-mt19937_64 *ProbaFloodingRoutingAgent::forwardingRNG =  new mt19937_64(2);
 set<int> ProbaFloodingRoutingAgent::reachability = set<int>();
 
 ProbaFloodingRoutingAgent::ProbaFloodingRoutingAgent(Node *_hostNode) : RoutingAgent(_hostNode) {
@@ -60,22 +59,16 @@ void ProbaFloodingRoutingAgent::receivePacketFromNetwork(PacketPtr _packet) {
     return;
 
   bool fw = false;
-  auto srcIt = alreadySeenPackets.find(_packet->srcId);
-  if (srcIt != alreadySeenPackets.end()) {
-    // already seen
-    if (_packet->srcSequenceNumber > srcIt->second) {
-      // the source sequence number of this packet is higher than the highest already seen from this source
-      srcIt->second = _packet->srcSequenceNumber;
-      fw = true;
-    }
-  } else {
-    // seen for the first time
-    alreadySeenPackets.insert(pair<int,int>(_packet->srcId, _packet->srcSequenceNumber));
+  // seen for the first time, or the source sequence number of this packet is
+  // higher than the highest already seen from this source
+  if (alreadySeenPackets.isNewer(_packet->srcId, _packet->srcSequenceNumber)) {
+    alreadySeenPackets.insert(_packet->srcId, _packet->srcSequenceNumber);
     fw = true;
   }
 
   uniform_real_distribution<float> distrib(0, 1);
-  float forwardingProbabilityNumber = distrib(*forwardingRNG);
+  CounterRNG forwardingRNG = getForwardingRNG(forwardingRNGSeed);
+  float forwardingProbabilityNumber = distrib(forwardingRNG);
 
 //  int wantedForwarder = ScenarioParameters::getSlrBackoffredundancy();
 //  cout << " wantedForwarder       =" << wantedForwarder << endl;
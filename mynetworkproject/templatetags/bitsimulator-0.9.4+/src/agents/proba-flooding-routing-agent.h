@@ -32,8 +32,8 @@
 
 class ProbaFloodingRoutingAgent : public RoutingAgent {
 protected:
-  map<int,int> alreadySeenPackets;
-  static mt19937_64 *forwardingRNG;
+  DuplicateFilter alreadySeenPackets;
+  static const int forwardingRNGSeed = 2;
   static set<int> reachability;
 
 public:
@@ -94,22 +94,11 @@ void PureFloodingRingRoutingAgent::receivePacketFromNetwork(PacketPtr _packet) {
     return;
 
   bool fw = false;
-  auto srcIt = alreadySeenPackets.find(_packet->srcId);
-  if (srcIt != alreadySeenPackets.end()) {
-    // already seen
- 
-    if (_packet->srcSequenceNumber > srcIt->second && _packet->type == PacketType::DATA) {
-      // the source sequence number of this packet is higher than the highest already seen from this source
-      srcIt->second = _packet->srcSequenceNumber;
-      fw = true;
-    }
-  } else {
-
-    if (_packet->type == PacketType::DATA) {
-      // seen for the first time
-      alreadySeenPackets.insert(pair<int,int>(_packet->srcId, _packet->srcSequenceNumber));
-      fw = true;
-    }
+  // seen for the first time, or the source sequence number of this packet is
+  // higher than the highest already seen from this source
+  if (alreadySeenPackets.isNewer(_packet->srcId, _packet->srcSequenceNumber) && _packet->type == PacketType::DATA) {
+    alreadySeenPackets.insert(_packet->srcId, _packet->srcSequenceNumber);
+    fw = true;
   }
 
   if (_packet->type == PacketType::CONTROL_1 || _packet->type == PacketType::CONTROL_2) {
@@ -35,14 +35,13 @@ typedef struct {
 } Control12_t;
 class PureFloodingRingRoutingAgent : public RoutingAgent {
 protected:
-  map<int,int> alreadySeenPackets;
+  DuplicateFilter alreadySeenPackets;
   map<int, Control12_t> ring;     //transmitterId (hostnode), received control1 or not,received control2 or not    //int, bool, bool
                                 //in multimap we insert key,value1 then key,value2... which we does not want, we need this order key,value1,value2
                                 //a map with list of values is better i think
  
 
 
-  static mt19937_64 *forwardingRNG;
   static set<int> reachability;
 
   bool alreadySent1and2;
@@ -66,22 +66,12 @@ void PureFloodingRoutingAgent::receivePacketFromNetwork(PacketPtr _packet) {
     return;
 
   bool fw = false;
-  auto srcIt = alreadySeenPackets.find(_packet->srcId);
-  if (srcIt != alreadySeenPackets.end()) {
-    // already seen
-    // DEDeN probes are not forwarded
-    if (_packet->srcSequenceNumber > srcIt->second && _packet->type != PacketType::D1_DENSITY_PROBE) {
-      // the source sequence number of this packet is higher than the highest already seen from this source
-      srcIt->second = _packet->srcSequenceNumber;
-      fw = true;
-    }
-  } else {
-    // DEDeN probes are not forwarded
-    if (_packet->type != PacketType::D1_DENSITY_PROBE) {
-      // seen for the first time
-      alreadySeenPackets.insert(pair<int,int>(_packet->srcId, _packet->srcSequenceNumber));
-      fw = true;
-    }
+  // seen for the first time, or the source sequence number of this packet is
+  // higher than the highest already seen from this source
+  // DEDeN probes are not forwarded
+  if (alreadySeenPackets.isNewer(_packet->srcId, _packet->srcSequenceNumber) && _packet->type != PacketType::D1_DENSITY_PROBE) {
+    alreadySeenPackets.insert(_packet->srcId, _packet->srcSequenceNumber);
+    fw = true;
   }
 
   if (fw) {
@@ -32,7 +32,7 @@
 
 class PureFloodingRoutingAgent : public RoutingAgent {
 protected:
-  map<int,int> alreadySeenPackets;
+  DuplicateFilter alreadySeenPackets;
   static set<int> reachability;
 
 public:
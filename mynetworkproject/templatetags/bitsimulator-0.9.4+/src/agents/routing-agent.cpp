@@ -31,6 +31,7 @@ int RoutingAgent::forwardedDataPackets = 0;
 
 RoutingAgent::RoutingAgent(Node *_hostNode): hostNode(_hostNode) {
   type = RoutingAgentType::GENERIC;
+  forwardingDraws = 0;
   aliveAgents++;
 }
 
@@ -21,6 +21,8 @@
 #define AGENTS_ROUTING_AGENT_H_
 
 #include "node.h"
+#include "duplicate-filter.h"
+#include "pending-forwards.h"
 
 
 enum class RoutingAgentType {
@@ -52,6 +54,11 @@ protected:
   Node *hostNode;
   static int aliveAgents;
   static int forwardedDataPackets;
+
+  uint64_t forwardingDraws;  // draws made so far from the forwarding stream of this agent
+  CounterRNG getForwardingRNG(uint64_t _seed) {
+    return CounterRNG(_seed, hostNode->getId(), RNGPurpose::FORWARDING, forwardingDraws);
+  }
 public:
   RoutingAgentType type;
   static void initializeAgent() { cout << "Initializing RoutingAgent" << endl; }
@@ -26,6 +26,7 @@
 #include "node.h"
 #include "world.h"
 #include "events.h"
+#include "slr-coordinates-cache.h"
 
 using namespace std;
 
@@ -66,7 +67,6 @@ here are main differences (using diff) between SLRBackoffRoutingAgent and SLRBac
 //==============================================================================
 
 
-mt19937_64 *SLRBackoffRoutingAgent3::forwardingRNG =  new mt19937_64(0);
 ofstream SLRBackoffRoutingAgent3::SLRPositionsFile;
 
 int SLRBackoffRoutingAgent3::currentAnchorID = 0;
@@ -101,7 +101,11 @@ SLRBackoffRoutingAgent3::SLRBackoffRoutingAgent3(Node *_hostNode) : RoutingAgent
     }
   }
 
-  if ( anchorID == 0 ){
+  // cached coordinates: no beacon phase, anchors must not start one either
+  if ( SLRCoordinatesCache::lookup(hostNode->getId(), SLRCoordX, SLRCoordY, SLRCoordZ) ) {
+    initialisationStarted = true;
+  }
+  if ( anchorID == 0 && !initialisationStarted ){
     simulationTime_t t = Scheduler::now()+400000000000;
     initialisationStarted = true;
     Scheduler::getScheduler().schedule(new SLRBackoffInitialisationGenerationEvent3(t,this));
@@ -112,6 +116,7 @@ SLRBackoffRoutingAgent3::~SLRBackoffRoutingAgent3() {
   if ( SLRPositionsFile.is_open() ) {
     SLRPositionsFile << hostNode->getId() << " " << SLRCoordX << " " << SLRCoordY << " " << SLRCoordZ << endl;
   }
+  SLRCoordinatesCache::store(hostNode->getId(), SLRCoordX, SLRCoordY, SLRCoordZ);
 
   aliveAgents--;
 
@@ -144,8 +149,6 @@ void SLRBackoffRoutingAgent3::initializeAgent() {
     cerr << "*** ERROR *** While opening SLR positions file " << filename << endl;
     exit(EXIT_FAILURE);
   }
-
-  forwardingRNG = new mt19937_64(ScenarioParameters::getBackoffFloodingRNGSeed());
 }
 
 
@@ -194,37 +197,34 @@ void SLRBackoffRoutingAgent3::receivePacketFromNetwork(PacketPtr _packet) {
 
 //     }
 
-    for ( auto it = waitingPacket.begin(); it!=waitingPacket.end();it++){
-      PacketPtr testedPacket = it->second.p;
-      int testedPacketCounter = it->second.counter;
-      if ( (testedPacket->flowId == _packet->flowId) && (testedPacket->flowSequenceNumber == _packet->flowSequenceNumber) ){ // if the received packet is in waiting state
-        if (testedPacketCounter >= wantedRedundancy ){
+    PendingForwards::PendingForward_t *pending = waitingPacket.findByFlow(_packet->flowId, _packet->flowSequenceNumber);
+    if ( pending != nullptr ){ // if the received packet is in waiting state
+      if (pending->counter >= wantedRedundancy ){
 //          if ( implicitAck(_packet)){
-            // //               cout << " received packet " << _packet->flowId << "(" << _packet->flowSequenceNumber << ")" << endl;
-            // //               cout << " testedPacket    "<< testedPacket->flowId << "(" << testedPacket   ->flowSequenceNumber << ")" << endl;
-            // //               getchar();
-            waitingPacket.erase(it);
+          // //               cout << " received packet " << _packet->flowId << "(" << _packet->flowSequenceNumber << ")" << endl;
+          // //               cout << " testedPacket    "<< testedPacket->flowId << "(" << testedPacket   ->flowSequenceNumber << ")" << endl;
+          // //               getchar();
+          waitingPacket.erase(pending->p->packetId);
 //             cout << "annulation " << endl; getchar();
 //                         LogSystem::EventsLogOutput.log( LogSystem::memoryTrace, Scheduler::now(),hostNode->getId(),"-",it->second.p->flowId,it->second.p->flowSequenceNumber);
-            // #Tuto LogSystem
+          // #Tuto LogSystem
 
 
-            //                 if (_packet->type == PacketType::DATA ){
-            //                   string filename = ScenarioParameters::getScenarioDirectory()+"/memoryTrace.data";
-            //                   ofstream memoryTrace(filename,std::ofstream::app);
-            //                   memoryTrace << ScenarioParameters::getDefaultBeta() <<" " << hostNode->getId() <<  " - "<< Scheduler::now() << endl;
-            //                   memoryTrace.close();
-            //                 }
+          //                 if (_packet->type == PacketType::DATA ){
+          //                   string filename = ScenarioParameters::getScenarioDirectory()+"/memoryTrace.data";
+          //                   ofstream memoryTrace(filename,std::ofstream::app);
+          //                   memoryTrace << ScenarioParameters::getDefaultBeta() <<" " << hostNode->getId() <<  " - "<< Scheduler::now() << endl;
+          //                   memoryTrace.close();
+          //                 }
 //         } // FIN is implicitAck
 //          else { // Le packet n'est pas un implicitAck
 //
 //          }// else fin implicitAck
-        }
-        else {
-          it->second.counter++;
-        }
-        return;
       }
+      else {
+        pending->counter++;
+      }
+      return;
     }
   }
 
@@ -283,22 +283,12 @@ void SLRBackoffRoutingAgent3::receivePacketFromNetwork(PacketPtr _packet) {
       forward=true;
     }
 
-    auto it = alreadyForwardedPackets.find(flowId);
-    if ( it != alreadyForwardedPackets.end() ) { //Already existing flow
-      auto iit = it->second.find(sequenceNumber);
-      if ( iit != it->second.end() ) { // Packet already seen
-        //         cout << "Already seen packet " << sequenceNumber << "(" << flowId << ") on node " << hostNode->getId() << " at " << Scheduler::now() << endl;
-        forward=false;
-      }
-      else { // new packet from an existing flow
-        it->second.insert(sequenceNumber);
-        forward=true;
-      }
+    if ( alreadyForwardedPackets.contains(flowId, sequenceNumber) ) { // Packet already seen
+      //         cout << "Already seen packet " << sequenceNumber << "(" << flowId << ") on node " << hostNode->getId() << " at " << Scheduler::now() << endl;
+      forward=false;
     }
-    else { //New flow
-      set<int> newSet;
-      newSet.insert(sequenceNumber);
-      alreadyForwardedPackets.insert(pair<int,set<int>>(flowId,newSet));
+    else { // new packet, possibly from a new flow
+      alreadyForwardedPackets.insert(flowId, sequenceNumber);
       forward=true;
     } //END CHECKING FLOW
 
@@ -334,13 +324,10 @@ void SLRBackoffRoutingAgent3::receivePacketFromNetwork(PacketPtr _packet) {
 
 
     uniform_int_distribution<time_t> distrib(0, effectiveBackoffWindow);
-    time_t backoffTime = distrib(*forwardingRNG);
+    CounterRNG forwardingRNG = getForwardingRNG(ScenarioParameters::getBackoffFloodingRNGSeed());
+    time_t backoffTime = distrib(forwardingRNG);
 
-    SLRbackoffRoutingCounter info;
-    info.p = newPacket;
-    info.counter=1;
-    waitingPacket.insert(pair<int,SLRbackoffRoutingCounter>(newPacket->packetId,info));
-    Scheduler::getScheduler().schedule(new SLRbackoffSendingEvent3(Scheduler::now() + backoffTime, hostNode,newPacket->packetId));
+    waitingPacket.insert(newPacket, Scheduler::getScheduler().schedule(new SLRbackoffSendingEvent3(Scheduler::now() + backoffTime, hostNode,newPacket->packetId)));
 //         LogSystem::EventsLogOutput.log( LogSystem::memoryTrace, Scheduler::now(),hostNode->getId(),"+",_packet->flowId,_packet->flowSequenceNumber);
 
     //             if (newPacket->type == PacketType::DATA ){
@@ -679,15 +666,13 @@ bool SLRBackoffRoutingAgent3::SLRUpdate(PacketPtr _packet){
 }
 
 void SLRBackoffRoutingAgent3::processSLRBackoffSending(int packetId){
-  auto it = waitingPacket.find(packetId);
+  PendingForwards::PendingForward_t pending;
 
-  if ( it != waitingPacket.end() ){// On envoi le paquet uniquement s'il est toujours en attente
-    PacketPtr forwardingPacket = it->second.p;
+  if ( waitingPacket.take(packetId, pending) ){// On envoi le paquet uniquement s'il est toujours en attente
+    PacketPtr forwardingPacket = pending.p;
     hostNode->enqueueOutgoingPacket(forwardingPacket);
-    LogSystem::EventsLogOutput.log( LogSystem::routingSND, Scheduler::now(),hostNode->getId(),(int) it->second.p->type,it->second.p->flowId,it->second.p->flowSequenceNumber);
-//         LogSystem::EventsLogOutput.log( LogSystem::memoryTrace, Scheduler::now(),hostNode->getId(),"-",it->second.p->flowId,it->second.p->flowSequenceNumber);
-
-    waitingPacket.erase(it);
+    LogSystem::EventsLogOutput.log( LogSystem::routingSND, Scheduler::now(),hostNode->getId(),(int) pending.p->type,pending.p->flowId,pending.p->flowSequenceNumber);
+//         LogSystem::EventsLogOutput.log( LogSystem::memoryTrace, Scheduler::now(),hostNode->getId(),"-",pending.p->flowId,pending.p->flowSequenceNumber);
   }
 }
 
@@ -35,7 +35,6 @@ using namespace std;
 //==============================================================================
 
 
-mt19937_64 *SLRBackoffRoutingAgent::forwardingRNG =  new mt19937_64(0);
 ofstream SLRBackoffRoutingAgent::SLRPositionsFile;
 
 int SLRBackoffRoutingAgent::currentAnchorID = 0;
@@ -109,8 +108,6 @@ void SLRBackoffRoutingAgent::initializeAgent() {
     cerr << "*** ERROR *** While opening SLR positions file " << filename << endl;
     exit(EXIT_FAILURE);
   }
-
-  forwardingRNG = new mt19937_64(ScenarioParameters::getBackoffFloodingRNGSeed());
 }
 
 
@@ -153,31 +150,25 @@ void SLRBackoffRoutingAgent::receivePacketFromNetwork(PacketPtr _packet) {
   bool alreadySeen = false;
   bool update = false;
   bool forward = false;
-  auto it =alreadyForwardedPackets.find(_packet->flowId);
-  if (it != alreadyForwardedPackets.end() ){ // Flow already followed
-    if ( it->second.find(_packet->flowSequenceNumber) != it->second.end() ) {
-      //                     if ( it->second >= _packet->flowSequenceNumber){
-      alreadySeen = true;
-    }
+  if ( alreadyForwardedPackets.contains(_packet->flowId, _packet->flowSequenceNumber) ) {
+    alreadySeen = true;
   }
 
-  for (auto it = waitingPacket.begin(); it!=waitingPacket.end();it++){
-    if ( (it->second.p)->flowId == _packet->flowId && (it->second.p)->flowSequenceNumber == _packet->flowSequenceNumber) {
-      if ( _packet->type == PacketType::SLR_BEACON && (it->second.counter) >= beaconRedundancy ) {
-        it=waitingPacket.erase(it);
-      }
-      else if (  _packet->type == PacketType::DATA && (it->second.counter) >= redundancy){
-        if ( implicitAck(_packet)) {
-          //                             if ( _packet->flowSequenceNumber != (it->second.p)->flowSequenceNumber || _packet->flowId != (it->second.p)->flowId ){
-          //                               cout << " packet " << _packet->flowSequenceNumber << "(" << _packet->flowId << ") ACK packet " << (it->second.p)->flowSequenceNumber << "(" << (it->second.p)->flowId << ")" << endl; getchar();
-          //                             }
-          it=waitingPacket.erase(it);
-        }
-
-      } else {
-        it->second.counter++;
+  PendingForwards::PendingForward_t *pending = waitingPacket.findByFlow(_packet->flowId, _packet->flowSequenceNumber);
+  if (pending != nullptr) {
+    if ( _packet->type == PacketType::SLR_BEACON && (pending->counter) >= beaconRedundancy ) {
+      waitingPacket.erase(pending->p->packetId);
+    }
+    else if (  _packet->type == PacketType::DATA && (pending->counter) >= redundancy){
+      if ( implicitAck(_packet)) {
+        //                             if ( _packet->flowSequenceNumber != (pending->p)->flowSequenceNumber || _packet->flowId != (pending->p)->flowId ){
+        //                               cout << " packet " << _packet->flowSequenceNumber << "(" << _packet->flowId << ") ACK packet " << (pending->p)->flowSequenceNumber << "(" << (pending->p)->flowId << ")" << endl; getchar();
+        //                             }
+        waitingPacket.erase(pending->p->packetId);
       }
-      break;
+
+    } else {
+      pending->counter++;
     }
     return;
   }
@@ -187,16 +178,7 @@ void SLRBackoffRoutingAgent::receivePacketFromNetwork(PacketPtr _packet) {
     //PacketPtr newPacket(new Packet(_packet));
     PacketPtr newPacket(_packet->clone());
 
-    auto it = alreadyForwardedPackets.find(_packet->flowId);
-    if ( it != alreadyForwardedPackets.end() ) {
-      it->second.insert(_packet->flowSequenceNumber);
-    }
-    else{
-
-      pair<int,set<int>> toto = pair<int,set<int>>(_packet->flowId,set<int>());
-      alreadyForwardedPackets.insert(toto);
-      //                     alreadyForwardedPackets.insert(pair<int,int>(_packet->flowId,_packet->flowSequenceNumber));
-    }
+    alreadyForwardedPackets.insert(_packet->flowId, _packet->flowSequenceNumber);
     hostNode->enqueueOutgoingPacket(newPacket);
     return;
   }
@@ -244,15 +226,7 @@ void SLRBackoffRoutingAgent::receivePacketFromNetwork(PacketPtr _packet) {
 
     if ( SLRForward(_packet) && isCloser(_packet)){
       forward = true;
-      auto it =alreadyForwardedPackets.find(_packet->flowId);
-      if (it != alreadyForwardedPackets.end()){
-        it->second.insert(_packet->flowSequenceNumber);
-      }
-      else{
-        pair<int,set<int>> toto = pair<int,set<int>>(_packet->flowId,set<int>());
-        alreadyForwardedPackets.insert(toto);
-        //                      alreadyForwardedPackets.insert(pair<int,int>(_packet->flowId,_packet->flowSequenceNumber));
-      }
+      alreadyForwardedPackets.insert(_packet->flowId, _packet->flowSequenceNumber);
       //                      else{
       //                          alreadyForwardedPackets.insert(pair<int,int>(_packet->flowId,_packet->flowSequenceNumber));
       //                      }
@@ -297,7 +271,8 @@ void SLRBackoffRoutingAgent::receivePacketFromNetwork(PacketPtr _packet) {
       }
     }
     uniform_int_distribution<time_t> distrib(0, effectiveBackoffWindow);
-    time_t backoffTime = distrib(*forwardingRNG);
+    CounterRNG forwardingRNG = getForwardingRNG(ScenarioParameters::getBackoffFloodingRNGSeed());
+    time_t backoffTime = distrib(forwardingRNG);
 
     PacketPtr newPacket(_packet->clone());
     if ( update ){
@@ -312,11 +287,7 @@ void SLRBackoffRoutingAgent::receivePacketFromNetwork(PacketPtr _packet) {
     newPacket->tx_SLRY = SLRCoordY;
     newPacket->tx_SLRZ = SLRCoordZ;
 
-    struct SLRbackoffRoutingCounter info;
-    info.p = newPacket;
-    info.counter = 1;
-    waitingPacket.insert(pair<int,SLRbackoffRoutingCounter>(newPacket->packetId,info));
-    Scheduler::getScheduler().schedule(new SLRbackoffSendingEvent(Scheduler::now() + backoffTime, hostNode,newPacket->packetId));
+    waitingPacket.insert(newPacket, Scheduler::getScheduler().schedule(new SLRbackoffSendingEvent(Scheduler::now() + backoffTime, hostNode,newPacket->packetId)));
   }
 }
 
@@ -620,26 +591,24 @@ bool SLRBackoffRoutingAgent::SLRUpdate(PacketPtr _packet)
 }
 
 void SLRBackoffRoutingAgent::processSLRBackoffSending(int packetId){
-  auto it = waitingPacket.find(packetId);
+  PendingForwards::PendingForward_t pending;
   //     if ( it != waitingPacket.end() && it->second.p->type == PacketType::DATA ) {
-  if ( it != waitingPacket.end() ) {
+  if ( waitingPacket.take(packetId, pending) ) {
     //
     // if the packet is still in the waiting list
     // i.e. I have not see more than REDUNDANCY copies
     // then I send it now
     //
-    //cout << " ++ forward seq " << it->second.p->flowSequenceNumber << " by node " << hostNode->getId()<< " at " << Scheduler::getScheduler().now() << endl;
-    hostNode->enqueueOutgoingPacket(it->second.p);
-    LogSystem::EventsLogOutput.log( LogSystem::routingSND, Scheduler::now(),hostNode->getId(),(int) it->second.p->type,it->second.p->flowId,it->second.p->flowSequenceNumber);
+    //cout << " ++ forward seq " << pending.p->flowSequenceNumber << " by node " << hostNode->getId()<< " at " << Scheduler::getScheduler().now() << endl;
+    hostNode->enqueueOutgoingPacket(pending.p);
+    LogSystem::EventsLogOutput.log( LogSystem::routingSND, Scheduler::now(),hostNode->getId(),(int) pending.p->type,pending.p->flowId,pending.p->flowSequenceNumber);
 
-    if (it->second.p->type == PacketType::DATA){
+    if (pending.p->type == PacketType::DATA){
       forwardedDataPackets++;
     }
-    else if (it->second.p->type == PacketType::SLR_BEACON){
+    else if (pending.p->type == PacketType::SLR_BEACON){
       slrBeaconCounter++;
     }
-
-    waitingPacket.erase(it);
   }
 }
 
@@ -51,17 +51,11 @@ protected:
   static int totalPacketsCollisions;
   static int totalAlteredBits;
 
-  static mt19937_64 *forwardingRNG;
   bool initialisationStarted;
 
   //         map<int,int> alreadySeenPackets;
 
-  struct SLRbackoffRoutingCounter {
-    PacketPtr p;
-    int counter;
-  };
-
-  map<int,SLRbackoffRoutingCounter> waitingPacket;
+  PendingForwards waitingPacket;
   float dataBackoffMultiplier;
   float beaconBackoffMultiplier;
   int redundancy;
@@ -78,7 +72,7 @@ public:
   virtual void receivePacketFromNetwork(PacketPtr _packet);
   virtual void receivePacketFromApplication(PacketPtr _packet);
 
-  map<int,set<int>> alreadyForwardedPackets;
+  DuplicateFilter alreadyForwardedPackets;
   int anchorID;
 
   int getSLRX() { return(SLRCoordX); }
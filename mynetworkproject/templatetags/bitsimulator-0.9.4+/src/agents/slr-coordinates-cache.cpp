@@ -0,0 +1,197 @@
+/*
+ * Copyright (C) 2017-2019 Dominique Dhoutaut, Thierry Arrabal, Eugen Dedu.
+ *
+ * This file is part of BitSimulator.
+ *
+ * BitSimulator is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * BitSimulator is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with BitSimulator.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <cstring>
+#include "slr-coordinates-cache.h"
+#include "utils.h"
+#include "node.h"
+#include "world.h"
+
+using namespace std;
+
+
+//==============================================================================
+//
+//          SLRCoordinatesCache  (class)
+//
+//==============================================================================
+
+string SLRCoordinatesCache::fileName;
+uint64_t SLRCoordinatesCache::key = 0;
+bool SLRCoordinatesCache::loaded = false;
+vector<SLRCoordinatesCache::SLRCoordinates_t> SLRCoordinatesCache::vectCoordinates;
+
+// FNV-1a, enough to detect a topology or configuration change
+static void hashBytes(uint64_t &_hash, const void *_data, size_t _size) {
+  const unsigned char *bytes = (const unsigned char *)_data;
+  for (size_t i = 0; i < _size; i++) {
+    _hash ^= bytes[i];
+    _hash *= 1099511628211ULL;
+  }
+}
+
+template <typename T>
+static void hashValue(uint64_t &_hash, T _value) {
+  hashBytes(_hash, &_value, sizeof(_value));
+}
+
+uint64_t SLRCoordinatesCache::computeKey() {
+  uint64_t hash = 14695981039346656037ULL;
+
+  string agent = ScenarioParameters::getRoutingAgentName();
+  hashBytes(hash, agent.data(), agent.size());
+
+  // topology
+  hashValue(hash, ScenarioParameters::getCommunicationRange());
+  hashValue(hash, ScenarioParameters::getCommunicationRangeStandardDeviation());
+  for (auto it = World::getFirstNodeIterator(); it != World::getEndNodeIterator(); it++) {
+    hashValue(hash, (*it)->getId());
+    hashValue(hash, (*it)->getXPos());
+    hashValue(hash, (*it)->getYPos());
+    hashValue(hash, (*it)->getZPos());
+  }
+
+  // anchors, in the order giving their anchor number
+  for (const auto &nodeInfo : ScenarioParameters::getVectNodeInfo()) {
+    if (nodeInfo.isAnchor)
+      hashValue(hash, nodeInfo.id);
+  }
+
+  // beacon flooding
+  hashValue(hash, ScenarioParameters::getBackoffRNGSeed());
+  hashValue(hash, ScenarioParameters::getBackoffFloodingRNGSeed());
+  hashValue(hash, ScenarioParameters::getSlrBeaconBackoffredundancy());
+  hashValue(hash, ScenarioParameters::getSlrBackoffBeaconMultiplier());
+  hashValue(hash, ScenarioParameters::getdefaultBackoffWindowWidth());
+
+  // beacon duration and collisions
+  hashValue(hash, ScenarioParameters::getDefaultBeta());
+  hashValue(hash, ScenarioParameters::getPulseDuration());
+  hashValue(hash, ScenarioParameters::getMaxConcurrentReceptions());
+  hashValue(hash, ScenarioParameters::getMinimumIntervalBetweenSends());
+  hashValue(hash, ScenarioParameters::getMinimumIntervalBetweenReceiveAndSend());
+  hashValue(hash, ScenarioParameters::getAcceptCollisionedPackets());
+  hashValue(hash, ScenarioParameters::getLinkShadowing());
+  hashValue(hash, ScenarioParameters::getShadowingCoherenceTime());
+
+  // sleeping nodes miss beacons
+  hashValue(hash, ScenarioParameters::getSleep());
+  if (ScenarioParameters::getSleep()) {
+    hashValue(hash, ScenarioParameters::getAwakenDuration());
+    hashValue(hash, ScenarioParameters::getAwakenNodes());
+    hashValue(hash, ScenarioParameters::getSleepRNGSeed());
+  }
+
+  return hash;
+}
+
+void SLRCoordinatesCache::initialize() {
+  if (ScenarioParameters::getSlrCoordinatesCacheFileName().empty())
+    return;
+
+  // the beacon phase of mobile nodes depends on when each beacon is sent
+  if (World::getWorld()->isMobile()) {
+    cerr << "*** ERROR *** Incompatible parameters. The SLR coordinates cache cannot be used with a <mobility> element" << endl;
+    exit(EXIT_FAILURE);
+  }
+
+  fileName = ScenarioParameters::getScenarioDirectory() + "/" + ScenarioParameters::getSlrCoordinatesCacheFileName();
+  key = computeKey();
+  vectCoordinates = vector<SLRCoordinates_t>(World::getEndNodeIterator() - World::getFirstNodeIterator(), {-1, -1, -1, false});
+
+  loaded = load();
+  if (loaded)
+    cout << "SLR coordinates loaded from " << fileName << ", beacon phase skipped" << endl;
+  else
+    cout << "SLR coordinates not cached in " << fileName << ", they will be saved at the end of the simulation" << endl;
+}
+
+bool SLRCoordinatesCache::load() {
+  ifstream file(fileName);
+  if (!file)
+    return false;
+
+  string line;
+  string word;
+  uint64_t fileKey;
+  if (!getline(file, line))
+    return false;
+  istringstream header(line);
+  if (!(header >> word >> hex >> fileKey) || word != "key" || fileKey != key)
+    return false;
+
+  int id, x, y, z;
+  while (file >> id >> x >> y >> z) {
+    if (id < 0 || id >= (int)vectCoordinates.size()) {
+      cerr << "*** ERROR *** Invalid node id " << id << " in SLR coordinates cache " << fileName << endl;
+      exit(EXIT_FAILURE);
+    }
+    vectCoordinates[id] = {x, y, z, true};
+  }
+  for (size_t i = 0; i < vectCoordinates.size(); i++) {
+    if (!vectCoordinates[i].known) {
+      cerr << "*** ERROR *** Node " << i << " missing in SLR coordinates cache " << fileName << endl;
+      exit(EXIT_FAILURE);
+    }
+  }
+  return true;
+}
+
+bool SLRCoordinatesCache::lookup(int _nodeId, int &_x, int &_y, int &_z) {
+  if (!loaded)
+    return false;
+  _x = vectCoordinates[_nodeId].x;
+  _y = vectCoordinates[_nodeId].y;
+  _z = vectCoordinates[_nodeId].z;
+  return true;
+}
+
+void SLRCoordinatesCache::store(int _nodeId, int _x, int _y, int _z) {
+  if (fileName.empty() || loaded)
+    return;
+  vectCoordinates[_nodeId] = {_x, _y, _z, true};
+}
+
+void SLRCoordinatesCache::save() {
+  if (fileName.empty() || loaded)
+    return;
+
+  // nothing to save if the routing agent is not from the SLR family
+  bool stored = false;
+  for (const auto &coordinates : vectCoordinates)
+    stored = stored || coordinates.known;
+  if (!stored)
+    return;
+
+  ofstream file(fileName);
+  if (!file) {
+    cerr << "*** ERROR *** While opening SLR coordinates cache " << fileName << ": " << strerror(errno) << endl;
+    return;
+  }
+  file << "key " << hex << setw(16) << setfill('0') << key << dec << endl;
+  for (size_t i = 0; i < vectCoordinates.size(); i++) {
+    if (vectCoordinates[i].known)
+      file << i << " " << vectCoordinates[i].x << " " << vectCoordinates[i].y << " " << vectCoordinates[i].z << endl;
+  }
+  cout << "SLR coordinates saved in " << fileName << endl;
+}
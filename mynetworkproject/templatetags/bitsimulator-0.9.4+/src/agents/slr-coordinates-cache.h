@@ -0,0 +1,68 @@
+/*
+ * Copyright (C) 2017-2019 Dominique Dhoutaut, Thierry Arrabal, Eugen Dedu.
+ *
+ * This file is part of BitSimulator.
+ *
+ * BitSimulator is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * BitSimulator is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with BitSimulator.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef AGENTS_SLR_COORDINATES_CACHE_H_
+#define AGENTS_SLR_COORDINATES_CACHE_H_
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+
+//===========================================================================================================
+//
+//          SLRCoordinatesCache  (class)
+//
+//===========================================================================================================
+
+// SLR coordinates only depend on the topology, the anchors and the parameters
+// of the beacon flooding: backoff, beta, collisions and sleep.  With
+// --slrCoordinatesCache, the coordinates computed by a run are saved at the
+// end of the simulation, and later runs with the same key load them at
+// startup instead of simulating the beacon phase.  Mobile nodes are refused.
+
+class SLRCoordinatesCache {
+private:
+  typedef struct {
+    int x, y, z;
+    bool known;
+  } SLRCoordinates_t;
+
+  static string fileName;
+  static uint64_t key;
+  static bool loaded;
+  static vector<SLRCoordinates_t> vectCoordinates;
+
+  static uint64_t computeKey();
+  static bool load();
+
+public:
+  static void initialize();
+  static bool isLoaded() { return loaded; }
+
+  // true (and coordinates set) if coordinates come from the cache
+  static bool lookup(int _nodeId, int &_x, int &_y, int &_z);
+  static void store(int _nodeId, int _x, int _y, int _z);
+  static void save();
+};
+
+
+#endif /* AGENTS_SLR_COORDINATES_CACHE_H_ */
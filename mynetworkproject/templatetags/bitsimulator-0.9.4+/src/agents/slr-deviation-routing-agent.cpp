@@ -44,7 +44,6 @@ using DeviationInitialisationGenerationEvent = CallMethodEvent<
 //==============================================================================
 
 ofstream DeviationRoutingAgent::SLRPositionsFile;
-mt19937_64 *DeviationRoutingAgent::forwardingRNG =  new mt19937_64(0);
 int DeviationRoutingAgent::currentAnchorID = 0;
 
 
@@ -101,8 +100,6 @@ void DeviationRoutingAgent::initializeAgent() {
     cerr << "*** ERROR *** While opening SLR positions file " << filename << endl;
     exit(EXIT_FAILURE);
   }
-
-  forwardingRNG = new mt19937_64(ScenarioParameters::getBackoffFloodingRNGSeed());
 }
 
 
@@ -112,11 +109,8 @@ void DeviationRoutingAgent::receivePacketFromNetwork(PacketPtr _packet) { // Sam
   bool alreadySeen = false;
   bool update = false;
   bool forward = false;
-  auto it =alreadyForwardedPackets.find(_packet->flowId);
-  if (it != alreadyForwardedPackets.end() ){ // Flow already followed
-    if ( it->second >= _packet->flowSequenceNumber){ // The last seen packet from is flow is newer than the received one
-      alreadySeen = true;
-    }
+  if ( !alreadyForwardedPackets.isNewer(_packet->flowId, _packet->flowSequenceNumber) ){ // The last seen packet from this flow is newer than the received one
+    alreadySeen = true;
   }
 
   int wantedRedundancy;
@@ -128,29 +122,26 @@ void DeviationRoutingAgent::receivePacketFromNetwork(PacketPtr _packet) { // Sam
   // if (_packet->deviation > 1 ) dev = true;
 
   if (_packet->type == PacketType::DATA){
-    for ( auto it = backoffWaitingPacket.begin(); it!=backoffWaitingPacket.end();it++){
-      PacketPtr testedPacket = it->second.p;
-      int testedPacketCounter = it->second.counter;
-      if ( (testedPacket->flowId == _packet->flowId) && (testedPacket->flowSequenceNumber == _packet->flowSequenceNumber) ){ // if the received packet is in waiting state
-        if (testedPacketCounter >= wantedRedundancy ){
-          if ( isAck(_packet)){
-            backoffWaitingPacket.erase(it);
-          }
-          else { // Packet is not an implicitAck
-          }
+    PendingForwards::PendingForward_t *pending = backoffWaitingPacket.findByFlow(_packet->flowId, _packet->flowSequenceNumber);
+    if ( pending != nullptr ){ // if the received packet is in waiting state
+      if (pending->counter >= wantedRedundancy ){
+        if ( isAck(_packet)){
+          backoffWaitingPacket.erase(pending->p->packetId);
         }
-        else {
-          it->second.counter++;
+        else { // Packet is not an implicitAck
         }
-        return;
       }
+      else {
+        pending->counter++;
+      }
+      return;
     }
   }
 
   if (  _packet->type == PacketType::D1_DENSITY_INIT && !alreadySeen ) {
     hostNode->dispatchPacketToApplication(_packet);
     PacketPtr newPacket(_packet->clone());
-    alreadyForwardedPackets.insert(pair<int,int>(_packet->flowId,_packet->flowSequenceNumber));
+    alreadyForwardedPackets.insertIfAbsent(_packet->flowId,_packet->flowSequenceNumber);
     hostNode->enqueueOutgoingPacket(newPacket);
     return;
   }
@@ -179,13 +170,7 @@ void DeviationRoutingAgent::receivePacketFromNetwork(PacketPtr _packet) { // Sam
   if ( (!alreadySeen && _packet->type == PacketType::DATA)){
     if ( deviationForward(_packet) && isCloser(_packet) ){
       forward = true;
-      auto it =alreadyForwardedPackets.find(_packet->flowId);
-      if (it != alreadyForwardedPackets.end()){
-        it->second = _packet->flowSequenceNumber ;
-      }
-      else{
-        alreadyForwardedPackets.insert(pair<int,int>(_packet->flowId,_packet->flowSequenceNumber));
-      }
+      alreadyForwardedPackets.insert(_packet->flowId,_packet->flowSequenceNumber);
     }
   }
 
@@ -207,7 +192,8 @@ void DeviationRoutingAgent::receivePacketFromNetwork(PacketPtr _packet) { // Sam
     }
 
     uniform_int_distribution<time_t> distrib(0, effectiveBackoffWindow);
-    time_t backoffTime = distrib(*forwardingRNG);
+    CounterRNG forwardingRNG = getForwardingRNG(ScenarioParameters::getBackoffFloodingRNGSeed());
+    time_t backoffTime = distrib(forwardingRNG);
 
     int mcr = ScenarioParameters::getMaxConcurrentReceptions();
     int receptCount = hostNode->getConcurrentReceptionCount();
@@ -225,12 +211,7 @@ void DeviationRoutingAgent::receivePacketFromNetwork(PacketPtr _packet) { // Sam
       newPacket->src_SLRZ = SLRCoordZ;
     }
 
-    struct SLRbackoffRoutingCounter info;
-    info.p = newPacket;
-    info.counter = 1;
-    backoffWaitingPacket.insert(pair<int,SLRbackoffRoutingCounter>(newPacket->packetId,info));
-
-    Scheduler::getScheduler().schedule(new SLRbackoffSendingEvent2(Scheduler::now() + backoffTime, hostNode,newPacket->packetId));
+    backoffWaitingPacket.insert(newPacket, Scheduler::getScheduler().schedule(new SLRbackoffSendingEvent2(Scheduler::now() + backoffTime, hostNode,newPacket->packetId)));
 //             deviation = true;
   }
 }
@@ -515,16 +496,15 @@ bool DeviationRoutingAgent::isAck(PacketPtr _packet) // The packet is coming fro
 }
 
 void DeviationRoutingAgent::processSLRBackoffSending(int packetId){
-  auto it = backoffWaitingPacket.find(packetId);
-  if ( it != backoffWaitingPacket.end() ) {
+  PendingForwards::PendingForward_t pending;
+  if ( backoffWaitingPacket.take(packetId, pending) ) {
     //
     // if the packet is still in the waiting list
     // i.e. I have not see more than REDUNDANCY copies
     // then I send it now
-    PacketPtr p = it->second.p;
+    PacketPtr p = pending.p;
     hostNode->enqueueOutgoingPacket(p);
-    LogSystem::EventsLogOutput.log( LogSystem::routingSND, Scheduler::now(),hostNode->getId(),(int) it->second.p->type,it->second.p->flowId,it->second.p->flowSequenceNumber);
-    backoffWaitingPacket.erase(it);
+    LogSystem::EventsLogOutput.log( LogSystem::routingSND, Scheduler::now(),hostNode->getId(),(int) p->type,p->flowId,p->flowSequenceNumber);
   }
 }
 
@@ -48,7 +48,6 @@ protected:
 
   static int currentAnchorID;
 
-  static mt19937_64 *forwardingRNG;
   bool initialisationStarted;
 
   bool isAck (PacketPtr _packet);
@@ -60,12 +59,7 @@ protected:
   int redundancy;
   int beaconRedundancy;
 
-  struct SLRbackoffRoutingCounter {
-    PacketPtr p;
-    int counter;
-  };
-
-  map<int,SLRbackoffRoutingCounter> backoffWaitingPacket;
+  PendingForwards backoffWaitingPacket;
 
   bool dedenStarted = false;
 
@@ -78,7 +72,7 @@ public:
   virtual void receivePacketFromNetwork(PacketPtr _packet);
   virtual void receivePacketFromApplication(PacketPtr _packet);
 
-  map<int,int> alreadyForwardedPackets;
+  DuplicateFilter alreadyForwardedPackets;
   int anchorID;
 
   int getSLRX() { return(SLRCoordX); }
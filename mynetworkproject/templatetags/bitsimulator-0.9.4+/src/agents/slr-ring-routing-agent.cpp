@@ -26,6 +26,7 @@
 #include "node.h"
 #include "world.h"
 #include "events.h"
+#include "slr-coordinates-cache.h"
 
 using namespace std;
 
@@ -43,7 +44,6 @@ using SLRInitialisationGenerationEvent = CallMethodEvent<SLRRingRoutingAgent,
 //==============================================================================
 
 ofstream SLRRingRoutingAgent::SLRPositionsFile;
-mt19937_64 *SLRRingRoutingAgent::forwardingRNG =  new mt19937_64(1);
 int SLRRingRoutingAgent::currentAnchorID = 0;
 int SLRRingRoutingAgent::forwardedSLRBeacons = 0;
 
@@ -69,7 +69,11 @@ SLRRingRoutingAgent::SLRRingRoutingAgent(Node *_hostNode) : RoutingAgent(_hostNo
       currentAnchorID++;
     }
   }
-  if ( anchorID == 0 ){
+  // cached coordinates: no beacon phase, anchors must not start one either
+  if ( SLRCoordinatesCache::lookup(hostNode->getId(), SLRCoordX, SLRCoordY, SLRCoordZ) ) {
+    initialisationStarted = true;
+  }
+  if ( anchorID == 0 && !initialisationStarted ){
     simulationTime_t t = Scheduler::now()+200000000000;
     initialisationStarted = true;
     Scheduler::getScheduler().schedule(new SLRInitialisationGenerationEvent(t,this));
@@ -80,6 +84,7 @@ SLRRingRoutingAgent::~SLRRingRoutingAgent() {
   if ( SLRPositionsFile.is_open() ) {
     SLRPositionsFile << hostNode->getId() << " " << SLRCoordX << " " << SLRCoordY << " " << SLRCoordZ << endl;
   }
+  SLRCoordinatesCache::store(hostNode->getId(), SLRCoordX, SLRCoordY, SLRCoordZ);
 
   //     if (SLRCoordX == -1 || SLRCoordY == -1 || SLRCoordZ == -1 ){
   //      cout << " Destructor on node " << hostNode->getId() << " SLR coord X : " << SLRCoordX << " Y : " << SLRCoordY << " Z : " << SLRCoordZ << endl;
@@ -133,11 +138,8 @@ void SLRRingRoutingAgent::receivePacketFromNetwork(PacketPtr _packet) {
   bool update = false;
   bool forward = false;
   bool forwardbeacon = false;
-  auto it =alreadyForwardedPackets.find(_packet->flowId);
-  if (it != alreadyForwardedPackets.end() ){ // Flow already followed
-    if ( it->second >= _packet->flowSequenceNumber){ // The last seen packet from is flow is newer than the received one
-      alreadySeen = true;
-    }
+  if ( !alreadyForwardedPackets.isNewer(_packet->flowId, _packet->flowSequenceNumber) ){ // The last seen packet from this flow is newer than the received one
+    alreadySeen = true;
   }
 
   //                 if (_packet->needAck && isAck(_packet)){
@@ -146,7 +148,7 @@ void SLRRingRoutingAgent::receivePacketFromNetwork(PacketPtr _packet) {
     hostNode->dispatchPacketToApplication(_packet);
     //PacketPtr newPacket(new Packet(_packet));
     PacketPtr newPacket(_packet->clone());
-    alreadyForwardedPackets.insert(pair<int,int>(_packet->flowId,_packet->flowSequenceNumber));
+    alreadyForwardedPackets.insertIfAbsent(_packet->flowId,_packet->flowSequenceNumber);
     hostNode->enqueueOutgoingPacket(newPacket);
     LogSystem::EventsLogOutput.log( LogSystem::routingSND, Scheduler::now(),hostNode->getId(),(int) newPacket->type,newPacket->flowId,newPacket->flowSequenceNumber);
     return;
@@ -181,13 +183,7 @@ void SLRRingRoutingAgent::receivePacketFromNetwork(PacketPtr _packet) {
     //                     getchar();
     if ( SLRForward(_packet) && isCloser(_packet) ){
       forward = true;
-      auto it =alreadyForwardedPackets.find(_packet->flowId);
-      if (it != alreadyForwardedPackets.end()){
-        it->second = _packet->flowSequenceNumber ;
-      }
-      else{
-        alreadyForwardedPackets.insert(pair<int,int>(_packet->flowId,_packet->flowSequenceNumber));
-      }
+      alreadyForwardedPackets.insert(_packet->flowId,_packet->flowSequenceNumber);
       //                      cout << " forwarding packet " <<  _packet->flowSequenceNumber << " on node " << hostNode->getId() << endl;
     }
   }
@@ -50,7 +50,6 @@ protected:
 
   static int currentAnchorID;
 
-  static mt19937_64 *forwardingRNG;
   bool initialisationStarted;
 
   static int forwardedSLRBeacons;
@@ -67,7 +66,7 @@ public:
   virtual void receivePacketFromNetwork(PacketPtr _packet);
   virtual void receivePacketFromApplication(PacketPtr _packet);
 
-  map<int,int> alreadyForwardedPackets;
+  DuplicateFilter alreadyForwardedPackets;
   int anchorID;
 
   int getSLRX() { return(SLRCoordX); }
@@ -26,6 +26,7 @@
 #include "node.h"
 #include "world.h"
 #include "events.h"
+#include "slr-coordinates-cache.h"
 
 using namespace std;
 
@@ -43,7 +44,6 @@ using SLRInitialisationGenerationEvent = CallMethodEvent<SLRRoutingAgent,
 //==============================================================================
 
 ofstream SLRRoutingAgent::SLRPositionsFile;
-mt19937_64 *SLRRoutingAgent::forwardingRNG =  new mt19937_64(1);
 int SLRRoutingAgent::currentAnchorID = 0;
 int SLRRoutingAgent::forwardedSLRBeacons = 0;
 
@@ -65,7 +65,11 @@ SLRRoutingAgent::SLRRoutingAgent(Node *_hostNode) : RoutingAgent(_hostNode) {
       currentAnchorID++;
     }
   }
-  if ( anchorID == 0 ){
+  // cached coordinates: no beacon phase, anchors must not start one either
+  if ( SLRCoordinatesCache::lookup(hostNode->getId(), SLRCoordX, SLRCoordY, SLRCoordZ) ) {
+    initialisationStarted = true;
+  }
+  if ( anchorID == 0 && !initialisationStarted ){
     simulationTime_t t = Scheduler::now()+200000000000;
     initialisationStarted = true;
     Scheduler::getScheduler().schedule(new SLRInitialisationGenerationEvent(t,this));
@@ -76,6 +80,7 @@ SLRRoutingAgent::~SLRRoutingAgent() {
   if ( SLRPositionsFile.is_open() ) {
     SLRPositionsFile << hostNode->getId() << " " << SLRCoordX << " " << SLRCoordY << " " << SLRCoordZ << endl;
   }
+  SLRCoordinatesCache::store(hostNode->getId(), SLRCoordX, SLRCoordY, SLRCoordZ);
 
   //     if (SLRCoordX == -1 || SLRCoordY == -1 || SLRCoordZ == -1 ){
   //      cout << " Destructor on node " << hostNode->getId() << " SLR coord X : " << SLRCoordX << " Y : " << SLRCoordY << " Z : " << SLRCoordZ << endl;
@@ -128,11 +133,8 @@ void SLRRoutingAgent::receivePacketFromNetwork(PacketPtr _packet) {
   bool alreadySeen = false;
   bool update = false;
   bool forward = false;
-  auto it =alreadyForwardedPackets.find(_packet->flowId);
-  if (it != alreadyForwardedPackets.end() ){ // Flow already followed
-    if ( it->second >= _packet->flowSequenceNumber){ // The last seen packet from is flow is newer than the received one
-      alreadySeen = true;
-    }
+  if ( !alreadyForwardedPackets.isNewer(_packet->flowId, _packet->flowSequenceNumber) ){ // The last seen packet from this flow is newer than the received one
+    alreadySeen = true;
   }
 
   //                 if (_packet->needAck && isAck(_packet)){
@@ -141,7 +143,7 @@ void SLRRoutingAgent::receivePacketFromNetwork(PacketPtr _packet) {
     hostNode->dispatchPacketToApplication(_packet);
     //PacketPtr newPacket(new Packet(_packet));
     PacketPtr newPacket(_packet->clone());
-    alreadyForwardedPackets.insert(pair<int,int>(_packet->flowId,_packet->flowSequenceNumber));
+    alreadyForwardedPackets.insertIfAbsent(_packet->flowId,_packet->flowSequenceNumber);
     hostNode->enqueueOutgoingPacket(newPacket);
     LogSystem::EventsLogOutput.log( LogSystem::routingSND, Scheduler::now(),hostNode->getId(),(int) newPacket->type,newPacket->flowId,newPacket->flowSequenceNumber);
     return;
@@ -174,13 +176,7 @@ void SLRRoutingAgent::receivePacketFromNetwork(PacketPtr _packet) {
     //                     getchar();
     if ( SLRForward(_packet) && isCloser(_packet) ){
       forward = true;
-      auto it =alreadyForwardedPackets.find(_packet->flowId);
-      if (it != alreadyForwardedPackets.end()){
-        it->second = _packet->flowSequenceNumber ;
-      }
-      else{
-        alreadyForwardedPackets.insert(pair<int,int>(_packet->flowId,_packet->flowSequenceNumber));
-      }
+      alreadyForwardedPackets.insert(_packet->flowId,_packet->flowSequenceNumber);
       //                      cout << " forwarding packet " <<  _packet->flowSequenceNumber << " on node " << hostNode->getId() << endl;
     }
   }
@@ -47,7 +47,6 @@ protected:
 
   static int currentAnchorID;
 
-  static mt19937_64 *forwardingRNG;
   bool initialisationStarted;
 
   static int forwardedSLRBeacons;
@@ -62,7 +61,7 @@ public:
   virtual void receivePacketFromNetwork(PacketPtr _packet);
   virtual void receivePacketFromApplication(PacketPtr _packet);
 
-  map<int,int> alreadyForwardedPackets;
+  DuplicateFilter alreadyForwardedPackets;
   int anchorID;
 
   int getSLRX() { return(SLRCoordX); }
@@ -0,0 +1,155 @@
+/*
+ * Copyright (C) 2017-2019 Dominique Dhoutaut, Thierry Arrabal, Eugen Dedu.
+ *
+ * This file is part of BitSimulator.
+ *
+ * BitSimulator is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * BitSimulator is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with BitSimulator.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "world.h"
+#include "scheduler.h"
+#include "routing-agent.h"
+#include "datasink-application-agent.h"
+#include "trace-application-agent.h"
+
+
+using TracePacketGenerationEvent = CallMethodArgEvent<TraceApplicationAgent, TraceArrival_t,
+  &TraceApplicationAgent::processPacketGenerationEvent,
+  EventType::TRACE_PACKET_GENERATION>;
+
+//==============================================================================
+//
+//          TraceApplicationAgent  (class)
+//
+//==============================================================================
+
+TraceApplicationAgent::TraceApplicationAgent(Node *_hostNode, string _fileName, int _firstFlowId, int _port, simulationTime_t _startTime, int _window) : ApplicationAgent(_hostNode), reader(_fileName) {
+  firstFlowId = _firstFlowId;
+  port = _port;
+  startTime = _startTime;
+
+  flowSequenceNumbers.assign(Node::getNextId(), 0);
+  sinkAttached.assign(Node::getNextId(), false);
+  allSinksAttached = false;
+
+  for (int i = 0; i < _window; i++) {
+    if (!scheduleNextArrival())
+      break;
+  }
+}
+
+TraceApplicationAgent::~TraceApplicationAgent() {
+}
+
+bool TraceApplicationAgent::scheduleNextArrival() {
+  TraceArrival_t arrival;
+  if (!reader.next(arrival))
+    return false;
+
+  if (arrival.srcId < 0 || arrival.srcId >= Node::getNextId() || arrival.dstId < -1 || arrival.dstId >= Node::getNextId()) {
+    cerr << "*** ERROR *** source or destination id out of bounds in arrival trace (src:" << arrival.srcId << ", dst:" << arrival.dstId << ")" << endl;
+    exit(EXIT_FAILURE);
+  }
+  if (arrival.beta == 0)
+    arrival.beta = ScenarioParameters::getDefaultBeta();
+  if (ScenarioParameters::getSleep() && arrival.beta != ScenarioParameters::getDefaultBeta()) {
+    cerr << "*** ERROR *** Sleep is enabled and beta of a traced packet is not equal to defaultBeta; sleep works only when beta of all flows are the same" << endl;
+    exit(EXIT_FAILURE);
+  }
+
+  simulationTime_t t = startTime + arrival.time;
+  if (t < Scheduler::now())
+    t = Scheduler::now();
+  Scheduler::getScheduler().scheduleTimer(new TracePacketGenerationEvent(t, this, arrival));
+  return true;
+}
+
+void TraceApplicationAgent::attachSink(int _nodeId) {
+  if (sinkAttached[_nodeId])
+    return;
+  sinkAttached[_nodeId] = true;
+
+  Node *dstNode = World::getNode(_nodeId);
+  DataSinkApplicationAgent *sink = new DataSinkApplicationAgent(dstNode);
+  if (!dstNode->attachServerApplicationAgent(sink, port)) {
+    // another generator already bound a server on this port
+    delete sink;
+  }
+}
+
+void TraceApplicationAgent::processPacketGenerationEvent(TraceArrival_t _arrival) {
+  if (_arrival.dstId != -1) {
+    attachSink(_arrival.dstId);
+  } else if (!allSinksAttached) {
+    for (int i = 0; i < Node::getNextId(); i++)
+      attachSink(i);
+    allSinksAttached = true;
+  }
+
+  Node *srcNode = World::getNode(_arrival.srcId);
+  PacketPtr p(new Packet(PacketType::DATA, _arrival.size, _arrival.srcId, _arrival.dstId, port, firstFlowId + _arrival.srcId, flowSequenceNumbers[_arrival.srcId]++));
+  p->setBeta(_arrival.beta);
+  p->needAck = true;
+  p->creationTime = Scheduler::now();
+
+  if ( srcNode->getRoutingAgent()->type == RoutingAgentType::BACKOFF_FLOODING || srcNode->getRoutingAgent()->type == RoutingAgentType::SLR_BACKOFF) {
+    p->disableBackoff = true;
+  }
+
+  srcNode->getRoutingAgent()->receivePacketFromApplication(p);
+
+  scheduleNextArrival();
+}
+
+void TraceApplicationAgent::initializeAgent() {
+  string fileName;
+  int firstFlowId;
+  int port;
+  simulationTime_t startTime;
+  int window;
+
+  tinyxml2::XMLElement *XMLRootNode = ScenarioParameters::getXMLRootNode();
+  tinyxml2::XMLElement *applicationAgentsConfigElement = XMLRootNode->FirstChildElement("applicationAgentsConfig");
+  if (applicationAgentsConfigElement == nullptr)
+    return;  // already reported by CBRApplicationAgent
+  tinyxml2::XMLElement *traceGeneratorElement = applicationAgentsConfigElement->FirstChildElement("TraceGenerator");
+  if (traceGeneratorElement == nullptr)
+    return;
+
+  tinyxml2::XMLElement *trace = traceGeneratorElement->FirstChildElement("trace");
+  cout << "\033[36;1mTrace-driven flows: \033[0m" << endl;
+
+  while (trace != nullptr) {
+    ScenarioParameters::queryStringAttr(trace, "file", fileName, true, nullptr, "", "no \"file\" attribute in element <trace>");
+    ScenarioParameters::queryIntAttr(trace, "firstFlowId", firstFlowId, true, nullptr, 0, "no \"firstFlowId\" attribute in element <trace>");
+    ScenarioParameters::queryIntAttr(trace, "port", port, true, nullptr, 0, "no \"port\" attribute in element <trace>");
+    ScenarioParameters::queryLongAttr(trace, "startTime_fs", "startTime_ns", startTime, false, nullptr, 0, "");
+    ScenarioParameters::queryIntAttr(trace, "window", window, false, nullptr, 64, "");
+    if (window < 1) {
+      cerr << "*** ERROR *** \"window\" of element <trace> must be at least 1" << endl;
+      exit(EXIT_FAILURE);
+    }
+    if (fileName[0] != '/')
+      fileName = ScenarioParameters::getScenarioDirectory() + "/" + fileName;
+    cout << "  trace " << fileName << "  [firstFlowId:" << firstFlowId << ", port:" << port << ", startTime:" << startTime << ", window:" << window << "]" << endl;
+
+    // the generator is owned by node 0, packets are injected on their source node
+    Node *ownerNode = World::getNode(0);
+    TraceApplicationAgent *generator = new TraceApplicationAgent(ownerNode, fileName, firstFlowId, port, startTime, window);
+    ownerNode->attachApplicationAgent(generator);
+
+    trace = trace->NextSiblingElement("trace");
+  }
+  cout << endl;
+}
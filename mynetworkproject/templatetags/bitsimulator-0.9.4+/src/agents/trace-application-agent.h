@@ -0,0 +1,63 @@
+/*
+ * Copyright (C) 2017-2019 Dominique Dhoutaut, Thierry Arrabal, Eugen Dedu.
+ *
+ * This file is part of BitSimulator.
+ *
+ * BitSimulator is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * BitSimulator is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with BitSimulator.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef AGENTS_TRACE_APPLICATION_AGENT_H_
+#define AGENTS_TRACE_APPLICATION_AGENT_H_
+
+#include "application-agent.h"
+#include "arrival-trace-reader.h"
+
+
+//==============================================================================
+//
+//          TraceApplicationAgent  (class)
+//
+//==============================================================================
+
+// Replays a packet arrival trace (see ArrivalTraceReader).  Each source node
+// of the trace is a flow, numbered firstFlowId + srcId.  Only the next
+// "window" arrivals are scheduled at any time: each generation event reads
+// and schedules the following arrival of the trace.  DataSinks are attached
+// to the destinations when their first packet is generated, and to all the
+// nodes once, at the first broadcast.
+
+class TraceApplicationAgent : public ApplicationAgent {
+protected:
+  ArrivalTraceReader reader;
+  int firstFlowId;
+  int port;
+  simulationTime_t startTime;
+
+  vector<int> flowSequenceNumbers;  // indexed by source node id
+  vector<bool> sinkAttached;        // indexed by node id
+  bool allSinksAttached;
+
+  bool scheduleNextArrival();
+  void attachSink(int _nodeId);
+
+public:
+  TraceApplicationAgent(Node *_hostNode, string _fileName, int _firstFlowId, int _port, simulationTime_t _startTime, int _window);
+  virtual ~TraceApplicationAgent();
+
+  static void initializeAgent();
+
+  void processPacketGenerationEvent(TraceArrival_t _arrival);
+};
+
+#endif /* AGENTS_TRACE_APPLICATION_AGENT_H_ */
@@ -0,0 +1,589 @@
+/*
+ * Copyright (C) 2017-2019 Dominique Dhoutaut, Thierry Arrabal, Eugen Dedu.
+ *
+ * This file is part of BitSimulator.
+ *
+ * BitSimulator is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * BitSimulator is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with BitSimulator.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+// bitsim-analyze computes metrics of an events log (plain, gz or sharded)
+// in a single multi-threaded pass, and writes them as JSON or CSV:
+//   delay       first reception time of each node, relative to the first send
+//   collisions  number of collisions per beta
+//   reach       number of distinct nodes reached and receptions per flow
+//   hops        latency between a send and its receptions by the neighbours;
+//               off by default, as it keeps every send and reception in memory
+
+#include <config.h>
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <deque>
+#include <algorithm>
+#include <map>
+#include <unordered_map>
+#include <unordered_set>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <chrono>
+#include <zlib.h>
+#include <tclap/CmdLine.h>
+
+#include "utils.h"
+#include "output.h"
+#include "agents/delay-statistics.h"
+
+using namespace std;
+
+// size of the blocks a single log file is split in
+static const size_t blockSize = 4 << 20;
+
+
+//===========================================================================================================
+//
+//          Analysis  (class)
+//
+//===========================================================================================================
+
+// a packet as seen by the node which sent it
+typedef struct PacketKey {
+  int node;
+  int flow;
+  int seq;
+  bool operator==(const PacketKey &_other) const {
+    return node == _other.node && flow == _other.flow && seq == _other.seq;
+  }
+} PacketKey_t;
+
+struct PacketKeyHash {
+  size_t operator()(const PacketKey_t &_key) const {
+    uint64_t h = ((uint64_t)(uint32_t)_key.node << 32) ^ ((uint64_t)(uint32_t)_key.flow << 20) ^ (uint32_t)_key.seq;
+    return hash<uint64_t>()(h);
+  }
+};
+
+// Partial result of one thread; the partial results are merged at the end,
+// so that the threads never share anything while parsing.
+
+class Analysis {
+public:
+  static bool delay;
+  static bool collisions;
+  static bool reach;
+  static bool hops;
+
+  long lines;
+  simulationTime_t firstSend;                          // -1 while unknown
+  unordered_map<int,simulationTime_t> firstReception;  // per node
+  map<int,long> collisionsPerBeta;
+  unordered_set<uint64_t> reachedNodes;                // flow << 32 | node
+  map<int,long> receptionsPerFlow;
+  unordered_map<PacketKey_t,vector<simulationTime_t>,PacketKeyHash> sends;  // every send of a packet by a node, sorted once merged
+  vector<pair<PacketKey_t,simulationTime_t>> receptions;             // (transmitter, flow, seq) received at
+
+  Analysis() {
+    lines = 0;
+    firstSend = -1;
+  }
+
+  void process(LogOutput &_log);
+  void merge(Analysis &_other);
+};
+
+bool Analysis::delay = false;
+bool Analysis::collisions = false;
+bool Analysis::reach = false;
+bool Analysis::hops = false;
+
+void Analysis::process(LogOutput &_log) {
+  string type = _log.currentLineFormatKey();
+  lines++;
+  if ( type == "s" ) {
+    simulationTime_t time = _log.getLogItemLongValue("time");
+    if ( firstSend < 0 || time < firstSend ) {
+      firstSend = time;
+    }
+    if ( hops ) {
+      PacketKey_t key = { _log.getLogItemIntValue("nodeID"), _log.getLogItemIntValue("flow"), _log.getLogItemIntValue("seq") };
+      sends[key].push_back(time);
+    }
+  } else if ( type == "r" ) {
+    simulationTime_t time = _log.getLogItemLongValue("time");
+    int node = _log.getLogItemIntValue("nodeID");
+    int flow = _log.getLogItemIntValue("flow");
+    if ( delay ) {
+      auto it = firstReception.find(node);
+      if ( it == firstReception.end() ) {
+        firstReception.insert(make_pair(node, time));
+      } else if ( time < it->second ) {
+        it->second = time;
+      }
+    }
+    if ( reach ) {
+      reachedNodes.insert(((uint64_t)(uint32_t)flow << 32) | (uint32_t)node);
+      receptionsPerFlow[flow]++;
+    }
+    if ( hops ) {
+      PacketKey_t key = { _log.getLogItemIntValue("transmitterID"), flow, _log.getLogItemIntValue("seq") };
+      receptions.push_back(make_pair(key, time));
+    }
+  } else if ( type == "c" ) {
+    if ( collisions ) {
+      collisionsPerBeta[_log.getLogItemIntValue("beta")]++;
+    }
+  }
+}
+
+void Analysis::merge(Analysis &_other) {
+  lines += _other.lines;
+  if ( _other.firstSend >= 0 && (firstSend < 0 || _other.firstSend < firstSend) ) {
+    firstSend = _other.firstSend;
+  }
+  for ( auto &r : _other.firstReception ) {
+    auto it = firstReception.find(r.first);
+    if ( it == firstReception.end() || r.second < it->second ) {
+      firstReception[r.first] = r.second;
+    }
+  }
+  for ( auto &c : _other.collisionsPerBeta ) {
+    collisionsPerBeta[c.first] += c.second;
+  }
+  reachedNodes.insert(_other.reachedNodes.begin(), _other.reachedNodes.end());
+  for ( auto &r : _other.receptionsPerFlow ) {
+    receptionsPerFlow[r.first] += r.second;
+  }
+  for ( auto &s : _other.sends ) {
+    vector<simulationTime_t> &times = sends[s.first];
+    times.insert(times.end(), s.second.begin(), s.second.end());
+  }
+  receptions.insert(receptions.end(), _other.receptions.begin(), _other.receptions.end());
+  _other = Analysis();
+}
+
+
+//===========================================================================================================
+//
+//          BlockQueue  (class)
+//
+//===========================================================================================================
+
+// A block of whole lines of a log file.  Format declarations ('#' lines) are
+// moved out of the blocks: every block refers to all the declarations read
+// so far, which only grow.
+
+typedef struct {
+  shared_ptr<const string> declarations;
+  string text;
+} LogBlock_t;
+
+class BlockQueue {
+private:
+  deque<LogBlock_t> blocks;
+  size_t maxBlocks;
+  bool closed;
+  mutex queueMutex;
+  condition_variable queueCondition;
+
+public:
+  BlockQueue(size_t _maxBlocks) {
+    maxBlocks = _maxBlocks;
+    closed = false;
+  }
+
+  void push(LogBlock_t &&_block) {
+    unique_lock<mutex> lock(queueMutex);
+    queueCondition.wait(lock, [this] { return blocks.size() < maxBlocks; });
+    blocks.push_back(std::move(_block));
+    lock.unlock();
+    queueCondition.notify_all();
+  }
+
+  // false once the queue is closed and empty
+  bool pop(LogBlock_t &_block) {
+    unique_lock<mutex> lock(queueMutex);
+    queueCondition.wait(lock, [this] { return !blocks.empty() || closed; });
+    if ( blocks.empty() ) {
+      return false;
+    }
+    _block = std::move(blocks.front());
+    blocks.pop_front();
+    lock.unlock();
+    queueCondition.notify_all();
+    return true;
+  }
+
+  void close() {
+    {
+      lock_guard<mutex> lock(queueMutex);
+      closed = true;
+    }
+    queueCondition.notify_all();
+  }
+};
+
+
+//===========================================================================================================
+//
+//          Readers
+//
+//===========================================================================================================
+
+// moves the '#' lines of _text at the end of the declarations
+static void extractDeclarations(string &_text, shared_ptr<const string> &_declarations) {
+  size_t first = ( !_text.empty() && _text[0] == '#' ) ? 0 : _text.find("\n#");
+  if ( first == string::npos ) {
+    return;
+  }
+  if ( first > 0 ) {
+    first++;
+  }
+  shared_ptr<string> declarations = make_shared<string>(*_declarations);
+  string kept = _text.substr(0, first);
+  size_t start = first;
+  while ( start < _text.size() ) {
+    size_t end = _text.find('\n', start) + 1;
+    if ( _text[start] == '#' ) {
+      declarations->append(_text, start, end - start);
+    } else {
+      kept.append(_text, start, end - start);
+    }
+    start = end;
+  }
+  _text = std::move(kept);
+  _declarations = declarations;
+}
+
+// splits a plain or gzip log in blocks ending at a line boundary
+static long readBlocks(gzFile _input, BlockQueue &_queue) {
+  shared_ptr<const string> declarations = make_shared<string>();
+  string carry;
+  vector<char> chunk(blockSize);
+  long bytes = 0;
+  int n;
+
+  while ( (n = gzread(_input, chunk.data(), blockSize)) > 0 ) {
+    bytes += n;
+    string text = std::move(carry);
+    text.append(chunk.data(), n);
+    size_t end = text.rfind('\n');
+    if ( end == string::npos ) {
+      carry = std::move(text);
+      continue;
+    }
+    carry = text.substr(end + 1);
+    text.resize(end + 1);
+    // a format declaration must not be split between two blocks
+    while ( !text.empty() ) {
+      size_t lineStart = ( text.size() >= 2 ) ? text.rfind('\n', text.size() - 2) : string::npos;
+      lineStart = ( lineStart == string::npos ) ? 0 : lineStart + 1;
+      if ( text[lineStart] != '#' ) {
+        break;
+      }
+      carry = text.substr(lineStart) + carry;
+      text.resize(lineStart);
+    }
+    if ( text.empty() ) {
+      continue;
+    }
+    extractDeclarations(text, declarations);
+    _queue.push({ declarations, std::move(text) });
+  }
+  if ( !carry.empty() ) {
+    carry += '\n';
+    extractDeclarations(carry, declarations);
+    _queue.push({ declarations, std::move(carry) });
+  }
+  _queue.close();
+  return bytes;
+}
+
+static void parseLines(LogOutput &_log, const string &_text, size_t _from, Analysis *_analysis) {
+  size_t start = _from;
+  while ( start < _text.size() ) {
+    size_t end = _text.find('\n', start) + 1;
+    if ( _log.parseLine(_text.data() + start, end - start) == LogOutput::LineType::DATA && _analysis != nullptr ) {
+      _analysis->process(_log);
+    }
+    start = end;
+  }
+}
+
+static void analyzeBlocks(BlockQueue &_queue, Analysis &_analysis) {
+  LogOutput log;
+  size_t declarationsRead = 0;
+  LogBlock_t block;
+
+  while ( _queue.pop(block) ) {
+    parseLines(log, *block.declarations, declarationsRead, nullptr);
+    declarationsRead = block.declarations->size();
+    parseLines(log, block.text, 0, &_analysis);
+  }
+}
+
+// every shard is self-contained, threads take the next unread one
+static void analyzeShards(const vector<logShardInfo_t> &_shards, string _directory, atomic<size_t> &_next, Analysis &_analysis) {
+  size_t index;
+  while ( (index = _next++) < _shards.size() ) {
+    LogOutput log;
+    LogOutput::LineType res;
+    log.open(_directory + _shards[index].fileName);
+    while ( (res = log.readNextLine()) != LogOutput::LineType::END_OF_FILE ) {
+      if ( res == LogOutput::LineType::DATA ) {
+        _analysis.process(log);
+      }
+    }
+    log.close();
+  }
+}
+
+
+//===========================================================================================================
+//
+//          Output
+//
+//===========================================================================================================
+
+static void printStatistics(ostream &_out, const DelayStatistics &_stats, bool _json) {
+  if ( _json ) {
+    _out << "\"count\": " << _stats.getCount() << ", \"mean_fs\": " << (long)_stats.getMean()
+         << ", \"min_fs\": " << _stats.getMin() << ", \"median_fs\": " << _stats.getQuantile(0.5)
+         << ", \"p95_fs\": " << _stats.getQuantile(0.95) << ", \"max_fs\": " << _stats.getMax();
+  } else {
+    _out << _stats.getCount() << "," << (long)_stats.getMean() << "," << _stats.getMin() << ","
+         << _stats.getQuantile(0.5) << "," << _stats.getQuantile(0.95) << "," << _stats.getMax();
+  }
+}
+
+static ofstream openOutput(string _name) {
+  ofstream out(_name);
+  if ( !out.is_open() ) {
+    cerr << "*** ERROR *** Cannot create " << _name << endl;
+    exit(EXIT_FAILURE);
+  }
+  cout << "  writing " << _name << endl;
+  return out;
+}
+
+static void writeResults(Analysis &_analysis, simulationTime_t _origin, string _output, bool _json) {
+  // delays, sorted by node
+  map<int,simulationTime_t> firstReception(_analysis.firstReception.begin(), _analysis.firstReception.end());
+  DelayStatistics delays;
+  for ( auto &r : firstReception ) {
+    delays.add(r.second - _origin);
+  }
+
+  // reached nodes per flow
+  map<int,long> reachedPerFlow;
+  for ( uint64_t key : _analysis.reachedNodes ) {
+    reachedPerFlow[(int)(key >> 32)]++;
+  }
+
+  // per hop latency: a reception comes from the latest send before it, the
+  // same packet being sent again by retransmissions or several betas
+  DelayStatistics hopLatency;
+  long unmatched = 0;
+  for ( auto &s : _analysis.sends ) {
+    sort(s.second.begin(), s.second.end());
+  }
+  for ( auto &r : _analysis.receptions ) {
+    auto it = _analysis.sends.find(r.first);
+    if ( it == _analysis.sends.end() ) {
+      unmatched++;
+      continue;
+    }
+    auto send = upper_bound(it->second.begin(), it->second.end(), r.second);
+    if ( send == it->second.begin() ) {
+      unmatched++;
+    } else {
+      hopLatency.add(r.second - *(send - 1));
+    }
+  }
+
+  if ( _json ) {
+    ofstream out = openOutput(_output + ".json");
+    out << "{" << endl << "  \"lines\": " << _analysis.lines;
+    if ( Analysis::delay ) {
+      out << "," << endl << "  \"delay\": {" << endl << "    \"origin_fs\": " << _origin << "," << endl << "    \"summary\": { ";
+      printStatistics(out, delays, true);
+      out << " }," << endl << "    \"nodes\": [";
+      bool first = true;
+      for ( auto &r : firstReception ) {
+        out << (first ? "" : ",") << endl << "      { \"node\": " << r.first << ", \"firstReception_fs\": " << r.second << ", \"delay_fs\": " << r.second - _origin << " }";
+        first = false;
+      }
+      out << endl << "    ]" << endl << "  }";
+    }
+    if ( Analysis::collisions ) {
+      out << "," << endl << "  \"collisions\": [";
+      bool first = true;
+      for ( auto &c : _analysis.collisionsPerBeta ) {
+        out << (first ? "" : ",") << endl << "    { \"beta\": " << c.first << ", \"collisions\": " << c.second << " }";
+        first = false;
+      }
+      out << endl << "  ]";
+    }
+    if ( Analysis::reach ) {
+      out << "," << endl << "  \"reach\": [";
+      bool first = true;
+      for ( auto &r : _analysis.receptionsPerFlow ) {
+        out << (first ? "" : ",") << endl << "    { \"flow\": " << r.first << ", \"reachedNodes\": " << reachedPerFlow[r.first] << ", \"receptions\": " << r.second << " }";
+        first = false;
+      }
+      out << endl << "  ]";
+    }
+    if ( Analysis::hops ) {
+      out << "," << endl << "  \"hops\": { ";
+      printStatistics(out, hopLatency, true);
+      out << ", \"unmatched\": " << unmatched << " }";
+    }
+    out << endl << "}" << endl;
+  } else {
+    if ( Analysis::delay ) {
+      ofstream out = openOutput(_output + "-delay.csv");
+      out << "node,firstReception_fs,delay_fs" << endl;
+      for ( auto &r : firstReception ) {
+        out << r.first << "," << r.second << "," << r.second - _origin << endl;
+      }
+    }
+    if ( Analysis::collisions ) {
+      ofstream out = openOutput(_output + "-collisions.csv");
+      out << "beta,collisions" << endl;
+      for ( auto &c : _analysis.collisionsPerBeta ) {
+        out << c.first << "," << c.second << endl;
+      }
+    }
+    if ( Analysis::reach ) {
+      ofstream out = openOutput(_output + "-reach.csv");
+      out << "flow,reachedNodes,receptions" << endl;
+      for ( auto &r : _analysis.receptionsPerFlow ) {
+        out << r.first << "," << reachedPerFlow[r.first] << "," << r.second << endl;
+      }
+    }
+    if ( Analysis::hops ) {
+      ofstream out = openOutput(_output + "-hops.csv");
+      out << "count,mean_fs,min_fs,median_fs,p95_fs,max_fs,unmatched" << endl;
+      printStatistics(out, hopLatency, false);
+      out << "," << unmatched << endl;
+    }
+  }
+}
+
+
+//===========================================================================================================
+//
+//          main
+//
+//===========================================================================================================
+
+int main(int argc, char **argv) {
+  cout << "bitsim-analyze " VERSION << endl;
+
+  string input, metrics, format, output;
+  int threads = 0;
+  long origin = -1;
+
+  try {
+    TCLAP::CmdLine cmd("bitsim-analyze computes metrics of a BitSimulator events log in a single multi-threaded pass.", ' ', VERSION);
+    TCLAP::ValueArg<string> inputParam("i","input","Events log: plain, gzip, or the .index of a sharded log",false,"events.log","string", cmd);
+    TCLAP::ValueArg<string> metricsParam("m","metrics","Comma separated metrics among delay, collisions, reach and hops (hops keeps every send and reception in memory)",false,"delay,collisions,reach","string", cmd);
+    TCLAP::ValueArg<string> formatParam("f","format","Output format, json or csv",false,"json","string", cmd);
+    TCLAP::ValueArg<string> outputParam("o","output","Output base name: <output>.json or <output>-<metric>.csv",false,"analysis","string", cmd);
+    TCLAP::ValueArg<int> threadsParam("j","threads","Number of parsing threads, 0 for the number of cores",false,0,"int", cmd);
+    TCLAP::ValueArg<long> originParam("","origin_fs","Date the delays are relative to, the first send by default",false,-1,"long", cmd);
+    cmd.parse(argc, argv);
+    input = inputParam.getValue();
+    metrics = metricsParam.getValue();
+    format = formatParam.getValue();
+    output = outputParam.getValue();
+    threads = threadsParam.getValue();
+    origin = originParam.getValue();
+  } catch (TCLAP::ArgException &e) {
+    cerr << "*** ERROR *** " << e.error() << " for arg " << e.argId() << std::endl;
+    exit(EXIT_FAILURE);
+  }
+
+  stringstream ss(metrics);
+  string metric;
+  while ( getline(ss, metric, ',') ) {
+    if ( metric == "delay" ) Analysis::delay = true;
+    else if ( metric == "collisions" ) Analysis::collisions = true;
+    else if ( metric == "reach" ) Analysis::reach = true;
+    else if ( metric == "hops" ) Analysis::hops = true;
+    else {
+      cerr << "*** ERROR *** Unknown metric " << metric << endl;
+      exit(EXIT_FAILURE);
+    }
+  }
+  if ( format != "json" && format != "csv" ) {
+    cerr << "*** ERROR *** Unknown output format " << format << endl;
+    exit(EXIT_FAILURE);
+  }
+  if ( threads <= 0 ) {
+    threads = max(1u, thread::hardware_concurrency());
+  }
+
+  auto startTime = chrono::steady_clock::now();
+  vector<Analysis> partials(threads);
+  vector<thread> workers;
+
+  string extension = ".index";
+  if ( input.size() > extension.size() && input.compare(input.size() - extension.size(), extension.size(), extension) == 0 ) {
+    vector<logShardInfo_t> shards = LogOutput::readIndex(input);
+    size_t slash = input.find_last_of('/');
+    string directory = ( slash == string::npos ) ? "" : input.substr(0, slash + 1);
+    atomic<size_t> next(0);
+    cout << "  " << shards.size() << " shards, " << threads << " threads" << endl;
+    for ( int i = 0; i < threads; i++ ) {
+      workers.push_back(thread(analyzeShards, cref(shards), directory, ref(next), ref(partials[i])));
+    }
+    for ( auto &w : workers ) {
+      w.join();
+    }
+  } else {
+    gzFile in = gzopen(input.c_str(), "rb");
+    if ( in == nullptr ) {
+      cerr << "*** ERROR *** Cannot open " << input << endl;
+      exit(EXIT_FAILURE);
+    }
+    BlockQueue queue(2 * threads);
+    cout << "  " << threads << " threads" << endl;
+    for ( int i = 0; i < threads; i++ ) {
+      workers.push_back(thread(analyzeBlocks, ref(queue), ref(partials[i])));
+    }
+    readBlocks(in, queue);
+    for ( auto &w : workers ) {
+      w.join();
+    }
+    gzclose(in);
+  }
+
+  Analysis &result = partials[0];
+  for ( int i = 1; i < threads; i++ ) {
+    result.merge(partials[i]);
+  }
+  if ( origin < 0 ) {
+    origin = max(0L, result.firstSend);
+  }
+
+  writeResults(result, origin, output, format == "json");
+
+  chrono::duration<double> elapsed = chrono::steady_clock::now() - startTime;
+  cout << "  " << result.lines << " events analyzed in " << elapsed.count() << " s" << endl;
+  return EXIT_SUCCESS;
+}
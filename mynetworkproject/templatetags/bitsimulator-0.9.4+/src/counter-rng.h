@@ -0,0 +1,87 @@
+/*
+ * Copyright (C) 2017-2019 Dominique Dhoutaut, Thierry Arrabal, Eugen Dedu.
+ *
+ * This file is part of BitSimulator.
+ *
+ * BitSimulator is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * BitSimulator is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with BitSimulator.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef COUNTER_RNG_H_
+#define COUNTER_RNG_H_
+
+#include <cstdint>
+using namespace std;
+
+// what a stream of random numbers is used for, part of its key
+enum class RNGPurpose : uint32_t {
+  BACKOFF,
+  SHADOWING,
+  FORWARDING,
+  PAYLOAD,
+  SLEEP,
+  LINK_SHADOWING,
+  MOBILITY
+};
+
+//===========================================================================================================
+//
+//          CounterRNG  (class)
+//
+//===========================================================================================================
+
+// Philox4x32-10 counter-based generator (Salmon et al., SC'11).  The n-th
+// number of a stream is a pure function of (seed, stream, purpose, n), so a
+// node draws the same values whatever the events of the other nodes, and any
+// number of threads can draw at the same time.  The stream is usually a node
+// id; the counter n is owned by the caller (a few bytes per node) and advanced
+// by each draw.  Usable by the <random> distributions.
+
+class CounterRNG {
+private:
+  uint32_t key0, key1;
+  uint32_t stream;
+  uint32_t purpose;
+  uint64_t &counter;
+
+public:
+  typedef uint64_t result_type;
+
+  CounterRNG(uint64_t _seed, uint32_t _stream, RNGPurpose _purpose, uint64_t &_counter) :
+    key0((uint32_t)_seed), key1((uint32_t)(_seed >> 32)), stream(_stream), purpose((uint32_t)_purpose), counter(_counter) { }
+
+  static constexpr result_type min() { return 0; }
+  static constexpr result_type max() { return UINT64_MAX; }
+
+  result_type operator()() {
+    uint64_t n = counter++;
+    uint32_t c0 = (uint32_t)n, c1 = (uint32_t)(n >> 32), c2 = stream, c3 = purpose;
+    uint32_t k0 = key0, k1 = key1;
+
+    for (int round = 0; round < 10; round++) {
+      if (round > 0) {
+        k0 += 0x9E3779B9;
+        k1 += 0xBB67AE85;
+      }
+      uint64_t p0 = (uint64_t)0xD2511F53 * c0;
+      uint64_t p1 = (uint64_t)0xCD9E8D57 * c2;
+      c0 = (uint32_t)(p1 >> 32) ^ c1 ^ k0;
+      c1 = (uint32_t)p1;
+      c2 = (uint32_t)(p0 >> 32) ^ c3 ^ k1;
+      c3 = (uint32_t)p0;
+    }
+    return ((uint64_t)c0 << 32) | c1;
+  }
+};
+
+#endif /* COUNTER_RNG_H_ */
@@ -44,6 +44,7 @@ public:
   long id;    // unique ID of the event (mainly for debugging purpose)
   simulationTime_t date;    // time at which the event will be processed. 0 means simulation start
   EventType eventType;   // see the various types at the beginning of this file
+  long sequence;    // scheduling order, set by the scheduler to order events of the same date
 
   Event(simulationTime_t _t);
   Event(Event *_ev);
@@ -28,8 +28,9 @@ enum class EventType {
   GENERIC,
   NODE_STARTUP,
   DATA_SINK_LOG,
-  NODE_LOG,
+  INTERVAL_LOG,
   CBR_PACKET_GENERATION,
+  TRACE_PACKET_GENERATION,
   DENSITY_ESTIMATOR_PACKET_GENERATION,
   SLR_INITIALISATION_PACKET_GENERATION,
   HCD_INITIALISATION_PACKET_GENERATION,
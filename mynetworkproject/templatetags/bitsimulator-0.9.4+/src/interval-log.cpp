@@ -0,0 +1,119 @@
+/*
+ * Copyright (C) 2017-2019 Dominique Dhoutaut, Thierry Arrabal, Eugen Dedu.
+ *
+ * This file is part of BitSimulator.
+ *
+ * BitSimulator is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * BitSimulator is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with BitSimulator.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "interval-log.h"
+#include "scheduler.h"
+#include "world.h"
+
+using namespace std;
+
+//===========================================================================================================
+//
+//          IntervalLog  (class)
+//
+//===========================================================================================================
+
+vector<IntervalInfoLog> IntervalLog::counters;
+LogOutput IntervalLog::logOutput;
+simulationTime_t IntervalLog::interval = 0;
+simulationTime_t IntervalLog::endTime = 0;
+long IntervalLog::intervalNumber = 0;
+
+class IntervalLogEvent : public Event {
+public:
+  IntervalLogEvent(simulationTime_t _t) : Event(_t) {
+    eventType = EventType::INTERVAL_LOG;
+  }
+  void consume() {
+    IntervalLog::processIntervalLogEvent();
+  }
+  const string getEventName() {
+    return "IntervalLogEvent";
+  }
+};
+
+void IntervalLog::initialize() {
+  interval = ScenarioParameters::getIntervalLogInterval();
+  if (interval == 0)
+    return;
+  endTime = ScenarioParameters::getIntervalLogEndTime();
+
+  map<string,logSystemInfo_t> mapOutputFiles = ScenarioParameters::getMapOutPutFiles();
+  logSystemInfo_t info = mapOutputFiles.find("IntervalLog")->second;
+  if (info.io != "smartLog" && info.io != "gz") {
+    cerr << "*** ERROR *** IntervalLog requires io=\"smartLog\" or io=\"gz\"" << endl;
+    exit(EXIT_FAILURE);
+  }
+  std::ofstream stream;  // unused, smartLog and gz write through logOutput
+  FILE *file = nullptr;
+  LogSystem::initOutputStream("IntervalLog", stream, &file, logOutput);
+  if (!logOutput.isCreated()) {
+    cerr << "*** ERROR *** IntervalLog must be written to a file" << endl;
+    exit(EXIT_FAILURE);
+  }
+
+  counters.assign(Node::getNextId(), IntervalInfoLog());
+  for (auto it = World::getFirstNodeIterator(); it != World::getEndNodeIterator(); it++)
+    (*it)->setIntervalInfoLog(&counters[(*it)->getId()]);
+
+  Scheduler::getScheduler().scheduleTimer(new IntervalLogEvent(Scheduler::now() + interval));
+}
+
+void IntervalLog::processIntervalLogEvent() {
+  if (!logOutput.isCreated())
+    return;
+
+  // idle nodes are not written, most nodes receive nothing in a short interval
+  double pulsesPerInterval = (double)interval / (double)ScenarioParameters::getPulseDuration();
+  int activeNodes = 0;
+  for (const IntervalInfoLog &c : counters)
+    if (!c.isIdle())
+      activeNodes++;
+  logOutput.log(LogSystem::intervalBlockLog, Scheduler::now(), (int)intervalNumber, activeNodes);
+  for (size_t id = 0; id < counters.size(); id++) {
+    IntervalInfoLog &c = counters[id];
+    if (c.isIdle())
+      continue;
+    logOutput.log(LogSystem::intervalNodeLog, Scheduler::now(), (int)id,
+      c.totalPacketsReceived,
+      c.totalBitsReceived,
+      100 * c.totalBitsReceived / pulsesPerInterval,
+      c.packetsCorrectlyReceived,
+      c.bitsCorrectlyReceived,
+      c.packetsCollisioned,
+      c.bitsCollisioned,
+      c.packetsIgnored,
+      c.bitsIgnored);
+    c.reset();
+  }
+  intervalNumber++;
+
+  // without an end time, the last block is the one written once the
+  // simulation has nothing else to do
+  bool last = endTime == 0 ? Scheduler::getScheduler().idle() : Scheduler::now() + interval > endTime;
+  if (last) {
+    close();
+  } else {
+    Scheduler::getScheduler().scheduleTimer(new IntervalLogEvent(Scheduler::now() + interval));
+  }
+}
+
+void IntervalLog::close() {
+  logOutput.close();
+}
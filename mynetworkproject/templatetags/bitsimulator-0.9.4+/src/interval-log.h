@@ -0,0 +1,61 @@
+/*
+ * Copyright (C) 2017-2019 Dominique Dhoutaut, Thierry Arrabal, Eugen Dedu.
+ *
+ * This file is part of BitSimulator.
+ *
+ * BitSimulator is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * BitSimulator is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with BitSimulator.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef INTERVAL_LOG_H_
+#define INTERVAL_LOG_H_
+
+#include <vector>
+#include "utils.h"
+#include "node.h"
+#include "output.h"
+using namespace std;
+
+//===========================================================================================================
+//
+//          IntervalLog  (class)
+//
+//===========================================================================================================
+
+// Channel usage statistics of all nodes, per time interval.  The counters of
+// the nodes are stored in a single contiguous array, a single periodic timer
+// writes one block per interval in the "IntervalLog" output of the log
+// system, then resets all of them.  A block is an "ib" line followed by one
+// "in" line per node that received something during the interval; the other
+// nodes have all their counters at 0.  Without endTime, the timer stops once
+// no other event is waiting.
+//
+// <IntervalLog suffix="intervals" output="file" io="smartLog" interval_ns="1000" endTime_ns="100000"/>
+
+class IntervalLog {
+private:
+  static vector<IntervalInfoLog> counters;  // indexed by node id
+  static LogOutput logOutput;
+  static simulationTime_t interval;
+  static simulationTime_t endTime;
+  static long intervalNumber;
+
+  IntervalLog() {}
+
+public:
+  static void initialize();
+  static void processIntervalLogEvent();
+  static void close();
+};
+
+#endif /* INTERVAL_LOG_H_ */
@@ -0,0 +1,225 @@
+/*
+ * Copyright (C) 2017-2019 Dominique Dhoutaut, Thierry Arrabal, Eugen Dedu.
+ *
+ * This file is part of BitSimulator.
+ *
+ * BitSimulator is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * BitSimulator is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with BitSimulator.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <sstream>
+#include "mobility.h"
+#include "node.h"
+#include "counter-rng.h"
+
+using namespace std;
+
+//===========================================================================================================
+//
+//          MobilityModel  (class)
+//
+//===========================================================================================================
+
+MobilityModel *MobilityModel::create(const vector<Node*> &_nodes) {
+  tinyxml2::XMLElement *mobilityElement = ScenarioParameters::getXMLRootNode()->FirstChildElement("world")->FirstChildElement("mobility");
+  if (mobilityElement == nullptr)
+    return nullptr;
+
+  string model;
+  ScenarioParameters::queryStringAttr(mobilityElement, "model", model, true, nullptr, "", "\"mobility\" element does not have a \"model\" attribute");
+
+  MobilityModel *mobility;
+  if (model == "constantVelocity") {
+    double vx = 0, vy = 0, vz = 0;  // nm per us
+    mobilityElement->QueryDoubleAttribute("velocityX_nm_per_us", &vx);
+    mobilityElement->QueryDoubleAttribute("velocityY_nm_per_us", &vy);
+    mobilityElement->QueryDoubleAttribute("velocityZ_nm_per_us", &vz);
+    mobility = new ConstantVelocityMobility(_nodes, vx / 1e9, vy / 1e9, vz / 1e9);
+  } else if (model == "randomWalk") {
+    double speed;
+    if (mobilityElement->QueryDoubleAttribute("speed_nm_per_us", &speed) != tinyxml2::XML_SUCCESS) {
+      cerr << "*** ERROR *** \"mobility\" element with randomWalk model does not have a \"speed_nm_per_us\" attribute" << endl;
+      exit(EXIT_FAILURE);
+    }
+    int seed;
+    ScenarioParameters::queryIntAttr(mobilityElement, "mobilityRNGSeed", seed, false, nullptr, 0, "no \"mobilityRNGSeed\" attribute in \"mobility\" element");
+    mobility = new RandomWalkMobility(_nodes, speed / 1e9, seed);
+  } else if (model == "trace") {
+    string file;
+    ScenarioParameters::queryStringAttr(mobilityElement, "file", file, true, nullptr, "", "\"mobility\" element with trace model does not have a \"file\" attribute");
+    mobility = new TraceMobility(_nodes, ScenarioParameters::getScenarioDirectory() + "/" + file);
+  } else {
+    cerr << "*** ERROR *** Invalid mobility model \"" << model << "\". Expected one of \"constantVelocity\", \"randomWalk\" or \"trace\"" << endl;
+    exit(EXIT_FAILURE);
+  }
+
+  ScenarioParameters::queryLongAttr(mobilityElement, "updateInterval_fs", "updateInterval_ns", mobility->updateInterval, false, nullptr, 1000000000, "");
+  ScenarioParameters::queryLongAttr(mobilityElement, "skin_nm", "skin_mm", mobility->skin, false, nullptr, ScenarioParameters::getCommunicationRange() / 10, "");
+  if (mobility->updateInterval <= 0 || mobility->skin <= 0) {
+    cerr << "*** ERROR *** The update interval and the skin of the mobility must be positive" << endl;
+    exit(EXIT_FAILURE);
+  }
+  cout << "  mobility: " << model << ", update interval " << mobility->updateInterval << " fs, skin " << mobility->skin << " nm" << endl;
+  return mobility;
+}
+
+double MobilityModel::bounce(double _v, distance_t _size) {
+  if (_size <= 0) return 0;
+  double period = 2.0 * _size;
+  double v = fmod(_v, period);
+  if (v < 0) v += period;
+  return v <= _size ? v : period - v;
+}
+
+//===========================================================================================================
+//
+//          ConstantVelocityMobility  (class)
+//
+//===========================================================================================================
+
+ConstantVelocityMobility::ConstantVelocityMobility(const vector<Node*> &_nodes, double _vx, double _vy, double _vz)
+  : MobilityModel(_nodes) {
+  // no move along the axes where the world is flat
+  velocityX = ScenarioParameters::getWorldXSize() > 0 ? _vx : 0;
+  velocityY = ScenarioParameters::getWorldYSize() > 0 ? _vy : 0;
+  velocityZ = ScenarioParameters::getWorldZSize() > 0 ? _vz : 0;
+  for (Node *node : nodes)
+    initialPositions.push_back({ node->getXPos(), node->getYPos(), node->getZPos() });
+}
+
+// computed from the initial positions, so that no error accumulates
+void ConstantVelocityMobility::moveTo(simulationTime_t _date) {
+  for (size_t i = 0; i < nodes.size(); i++) {
+    const spatialPoint_t &p = initialPositions[i];
+    nodes[i]->setPosition(
+      velocityX != 0 ? (distance_t)bounce(p.x + velocityX * _date, ScenarioParameters::getWorldXSize()) : p.x,
+      velocityY != 0 ? (distance_t)bounce(p.y + velocityY * _date, ScenarioParameters::getWorldYSize()) : p.y,
+      velocityZ != 0 ? (distance_t)bounce(p.z + velocityZ * _date, ScenarioParameters::getWorldZSize()) : p.z);
+  }
+}
+
+//===========================================================================================================
+//
+//          RandomWalkMobility  (class)
+//
+//===========================================================================================================
+
+RandomWalkMobility::RandomWalkMobility(const vector<Node*> &_nodes, double _speed, int _seed)
+  : MobilityModel(_nodes), speed(_speed), rngSeed(_seed), currentInterval(0) {
+  for (Node *node : nodes) {
+    x.push_back(node->getXPos());
+    y.push_back(node->getYPos());
+    z.push_back(node->getZPos());
+  }
+}
+
+void RandomWalkMobility::moveTo(simulationTime_t _date) {
+  long lastInterval = _date / updateInterval;
+  if (lastInterval <= currentInterval) return;
+
+  distance_t sizes[3] = { ScenarioParameters::getWorldXSize(), ScenarioParameters::getWorldYSize(), ScenarioParameters::getWorldZSize() };
+  int axes[3], axesCount = 0;
+  for (int a = 0; a < 3; a++)
+    if (sizes[a] > 0) axes[axesCount++] = a;
+  if (axesCount == 0) return;
+  double step = speed * updateInterval;
+
+  for (size_t i = 0; i < nodes.size(); i++) {
+    double *position[3] = { &x[i], &y[i], &z[i] };
+    for (long k = currentInterval; k < lastInterval; k++) {
+      // two draws per interval, whatever the number of axes
+      uint64_t draws = 2 * (uint64_t)k;
+      CounterRNG mobilityRNG(rngSeed, nodes[i]->getId(), RNGPurpose::MOBILITY, draws);
+      double u1 = (mobilityRNG() >> 11) / 9007199254740992.0;
+      double u2 = (mobilityRNG() >> 11) / 9007199254740992.0;
+
+      // direction uniform on the segment, circle or sphere of the free axes
+      double direction[3];
+      if (axesCount == 1) {
+        direction[0] = u1 < 0.5 ? -1 : 1;
+      } else if (axesCount == 2) {
+        direction[0] = cos(2 * M_PI * u1);
+        direction[1] = sin(2 * M_PI * u1);
+      } else {
+        double c = 2 * u1 - 1, s = sqrt(1 - c * c);
+        direction[0] = s * cos(2 * M_PI * u2);
+        direction[1] = s * sin(2 * M_PI * u2);
+        direction[2] = c;
+      }
+      for (int a = 0; a < axesCount; a++)
+        *position[axes[a]] = bounce(*position[axes[a]] + direction[a] * step, sizes[axes[a]]);
+    }
+    nodes[i]->setPosition((distance_t)x[i], (distance_t)y[i], (distance_t)z[i]);
+  }
+  currentInterval = lastInterval;
+}
+
+//===========================================================================================================
+//
+//          TraceMobility  (class)
+//
+//===========================================================================================================
+
+TraceMobility::TraceMobility(const vector<Node*> &_nodes, const string &_fileName)
+  : MobilityModel(_nodes), samples(_nodes.size()), currentSample(_nodes.size(), 0) {
+  ifstream traceFile(_fileName);
+  if (!traceFile) {
+    cerr << "*** ERROR *** While opening mobility trace file " << _fileName << endl;
+    exit(EXIT_FAILURE);
+  }
+
+  string line;
+  int lineNumber = 0;
+  while (getline(traceFile, line)) {
+    lineNumber++;
+    if (line.empty() || line[0] == '#') continue;
+    istringstream fields(line);
+    traceSample_t sample;
+    int id;
+    if (!(fields >> sample.date >> id >> sample.x >> sample.y >> sample.z) || id < 0 || id >= (int)nodes.size() || sample.date < 0) {
+      cerr << "*** ERROR *** Invalid line " << lineNumber << " in mobility trace file " << _fileName << endl;
+      exit(EXIT_FAILURE);
+    }
+    samples[id].push_back(sample);
+  }
+
+  for (size_t i = 0; i < nodes.size(); i++) {
+    if (samples[i].empty()) continue;
+    stable_sort(samples[i].begin(), samples[i].end(),
+      [](const traceSample_t &_a, const traceSample_t &_b) { return _a.date < _b.date; });
+    if (samples[i].front().date > 0)
+      samples[i].insert(samples[i].begin(), { 0, nodes[i]->getXPos(), nodes[i]->getYPos(), nodes[i]->getZPos() });
+  }
+}
+
+void TraceMobility::moveTo(simulationTime_t _date) {
+  for (size_t i = 0; i < nodes.size(); i++) {
+    const vector<traceSample_t> &nodeSamples = samples[i];
+    if (nodeSamples.empty()) continue;
+
+    size_t &s = currentSample[i];
+    while (s + 1 < nodeSamples.size() && nodeSamples[s + 1].date <= _date) s++;
+    const traceSample_t &a = nodeSamples[s];
+    if (s + 1 == nodeSamples.size() || _date <= a.date) {
+      nodes[i]->setPosition(a.x, a.y, a.z);
+    } else {
+      const traceSample_t &b = nodeSamples[s + 1];
+      double f = (double)(_date - a.date) / (b.date - a.date);
+      nodes[i]->setPosition((distance_t)(a.x + f * (b.x - a.x)), (distance_t)(a.y + f * (b.y - a.y)),
+                            (distance_t)(a.z + f * (b.z - a.z)));
+    }
+  }
+}
@@ -0,0 +1,139 @@
+/*
+ * Copyright (C) 2017-2019 Dominique Dhoutaut, Thierry Arrabal, Eugen Dedu.
+ *
+ * This file is part of BitSimulator.
+ *
+ * BitSimulator is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * BitSimulator is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with BitSimulator.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef MOBILITY_H_
+#define MOBILITY_H_
+
+#include <vector>
+#include "utils.h"
+#include "spatial-index.h"
+using namespace std;
+
+class Node;
+
+//===========================================================================================================
+//
+//          MobilityModel  (class)
+//
+//===========================================================================================================
+
+// Moves the nodes during the simulation.  Configured by a <mobility> element
+// in the <world> element, for instance:
+//   <mobility model="constantVelocity" updateInterval_ns="1000" skin_nm="50000"
+//             velocityX_nm_per_us="500" velocityY_nm_per_us="0" velocityZ_nm_per_us="0"/>
+//   <mobility model="randomWalk" speed_nm_per_us="300" mobilityRNGSeed="1"/>
+//   <mobility model="trace" file="positions.trace"/>
+//
+// Positions are updated every updateInterval (1 us by default), the nodes
+// being placed where they are at the start of the interval.  The nodes stay
+// in the world: they bounce on its borders, and do not move along an axis
+// on which the world size is 0.  The skin (communicationRange/10 by default)
+// is the margin added to the neighbours lists, see World::updatePositions.
+
+class MobilityModel {
+protected:
+  vector<Node*> nodes;
+  simulationTime_t updateInterval;
+  distance_t skin;
+
+  MobilityModel(const vector<Node*> &_nodes) : nodes(_nodes), updateInterval(1000000000), skin(0) {}
+
+  // _v folded into [0, _size], as if bouncing on 0 and _size
+  static double bounce(double _v, distance_t _size);
+
+public:
+  virtual ~MobilityModel() {}
+
+  // nullptr when the scenario has no <mobility> element
+  static MobilityModel *create(const vector<Node*> &_nodes);
+
+  simulationTime_t getUpdateInterval() { return updateInterval; }
+  distance_t getSkin() { return skin; }
+
+  // places all the nodes where they are at _date, later than the previous call
+  virtual void moveTo(simulationTime_t _date) = 0;
+};
+
+//===========================================================================================================
+//
+//          ConstantVelocityMobility  (class)
+//
+//===========================================================================================================
+
+// All the nodes drift with the same velocity, like in a flow.
+
+class ConstantVelocityMobility : public MobilityModel {
+private:
+  double velocityX, velocityY, velocityZ;  // nm per fs
+  vector<spatialPoint_t> initialPositions;
+
+public:
+  ConstantVelocityMobility(const vector<Node*> &_nodes, double _vx, double _vy, double _vz);
+  void moveTo(simulationTime_t _date);
+};
+
+//===========================================================================================================
+//
+//          RandomWalkMobility  (class)
+//
+//===========================================================================================================
+
+// Each node goes in a new random direction at each update interval, at a
+// constant speed.  Directions come from the stream of the node, so the
+// positions do not depend on when they are asked.
+
+class RandomWalkMobility : public MobilityModel {
+private:
+  double speed;  // nm per fs
+  int rngSeed;
+  long currentInterval;
+  vector<double> x, y, z;
+
+public:
+  RandomWalkMobility(const vector<Node*> &_nodes, double _speed, int _seed);
+  void moveTo(simulationTime_t _date);
+};
+
+//===========================================================================================================
+//
+//          TraceMobility  (class)
+//
+//===========================================================================================================
+
+// Positions read from a file, one sample per line: "date_fs nodeId x_nm y_nm z_nm",
+// lines starting with # being ignored.  Positions are interpolated between
+// the samples of a node, its scenario position being its sample at date 0.
+// Nodes without samples do not move.
+
+class TraceMobility : public MobilityModel {
+private:
+  typedef struct {
+    simulationTime_t date;
+    distance_t x, y, z;
+  } traceSample_t;
+
+  vector<vector<traceSample_t>> samples;  // by node id, sorted by date
+  vector<size_t> currentSample;
+
+public:
+  TraceMobility(const vector<Node*> &_nodes, const string &_fileName);
+  void moveTo(simulationTime_t _date);
+};
+
+#endif /* MOBILITY_H_ */
@@ -17,6 +17,7 @@
  * along with BitSimulator.  If not, see <https://www.gnu.org/licenses/>.
  */
 
+#include <algorithm>
 #include <cassert>
 #include <set>
 #include "utils.h"
@@ -42,9 +43,6 @@
 #include "agents/slr-ring-routing-agent.h"
 #include "agents/slr-deviation-routing-agent.h"
 
-using NodeLogEvent = CallMethodEvent<Node, &Node::processNodeLogEvent,
-  EventType::NODE_LOG>;
-
 //==============================================================================
 //
 //          IntervalInfoLog  (class)
@@ -66,6 +64,11 @@ void IntervalInfoLog::reset() {
   bitsIgnored = 0;
 }
 
+bool IntervalInfoLog::isIdle() const {
+  return totalPacketsReceived == 0 && packetsCorrectlyReceived == 0 && packetsCollisioned == 0 && packetsIgnored == 0
+    && totalBitsReceived == 0 && bitsCorrectlyReceived == 0 && bitsCollisioned == 0 && bitsIgnored == 0;
+}
+
 //==============================================================================
 //
 //          Node  (class)
@@ -73,59 +76,90 @@ void IntervalInfoLog::reset() {
 //==============================================================================
 
 int Node::nextId = 0;
-mt19937_64 *Node::backoffRandomGenerator = nullptr;
+int Node::backoffRNGSeed = 0;
 simulationTime_t Node::pulseDuration;
 uniform_int_distribution<distance_t> Node::defaultBackoffDistribution;
 map<PacketType,backoffHelper_t> Node::specificBackoffsMap;
+nodesHotState_t Node::hot;
+unsigned long Node::overflowDrops = 0;
 
 Node::Node(int _id, distance_t _x, distance_t _y, distance_t _z) {
   assert (_id == nextId);
   id = _id;
   nextId++;
-  x = _x;
-  y = _y;
-  z = _z;
+  hot.x.push_back(_x);
+  hot.y.push_back(_y);
+  hot.z.push_back(_z);
+  hot.communicationRange.push_back(0);
+  hot.communicationRangeStandardDeviation.push_back(0);
+  hot.lastEndSend.push_back(-ScenarioParameters::getMinimumIntervalBetweenSends());
+  hot.lastEndReceive.push_back(-ScenarioParameters::getMinimumIntervalBetweenReceiveAndSend());
+  hot.beta.push_back(ScenarioParameters::getDefaultBeta());
 
-  currentBeta = ScenarioParameters::getDefaultBeta();
   nodeSequenceNumber = 0;
   estimatedNeighbours = -1;
 
   routingAgent = nullptr;
+  cold = nullptr;
 
-  currentTransmitedPacketStartTime = -1;
-  lastEndSend = -ScenarioParameters::getMinimumIntervalBetweenSends();
-  lastEndReceive = -ScenarioParameters::getMinimumIntervalBetweenReceiveAndSend();
+  receptionSlots = nullptr;
+  receptionCount = 0;
+
+  backoffDraws = 0;
+  shadowingDraws = 0;
+  payloadDraws = 0;
 
   LogSystem::NodeInfo << "Instantiating node " << id << endl;
 
   neighboursCount = -1;
+  neighbours = nullptr;
+  neighboursListSize = 0;
+  cutoffRange[0] = cutoffRange[1] = -1;
 
   intervalInfoLog = nullptr;
-  endLoggingTime = 0;
-  loggingInterval = 0;
-  nodeLogFile = nullptr;
 }
 
 Node::~Node() {
   delete routingAgent;
-  for (auto it=serverApplicationsMap.begin(); it!=serverApplicationsMap.end(); it++) {
-    delete it->second;
-  }
-  for (auto it=vectApplications.begin(); it!=vectApplications.end(); it++) {
-    delete *it;
+  if (cold != nullptr) {
+    for (auto it=cold->serverApplicationsMap.begin(); it!=cold->serverApplicationsMap.end(); it++) {
+      delete it->second;
+    }
+    for (auto it=cold->vectApplications.begin(); it!=cold->vectApplications.end(); it++) {
+      delete *it;
+    }
+    delete cold;
   }
+  delete[] receptionSlots;
 }
 
 void Node::setNeighboursCount(int count) {
   neighboursCount = count;
 }
 
+// Number of neighbours within _range.  Sends use few different ranges (e.g.
+// data and beacons), so the last two answers are kept.
+int Node::getNeighboursWithin(distance_t _range) {
+  if (cutoffRange[0] == _range) return cutoff[0];
+  if (cutoffRange[1] == _range) return cutoff[1];
+
+  const neighbour_t *end = upper_bound(neighbours, neighbours + neighboursListSize, _range,
+    [](distance_t _r, const neighbour_t &_n) { return _r < _n.distance; });
+  cutoffRange[1] = cutoffRange[0];
+  cutoff[1] = cutoff[0];
+  cutoffRange[0] = _range;
+  cutoff[0] = (int)(end - neighbours);
+  return cutoff[0];
+}
+
 int Node::getNeighboursCount() {
+  if (World::getWorld()->isMobile())
+    return World::getWorld()->countNeighbours(this);
   if ( ScenarioParameters::getDoNotUseNeighboursList() ) {
     assert (neighboursCount != -1);
     return neighboursCount;
   } else
-    return (int)neighboursMap.size();
+    return neighboursListSize;
 }
 
 void Node::attachRoutingAgent(RoutingAgent *_routingAgent) {
@@ -137,17 +171,18 @@ void Node::attachRoutingAgent(RoutingAgent *_routingAgent) {
 }
 
 void Node::attachApplicationAgent(ApplicationAgent *_applicationAgent) {
-  vectApplications.push_back(_applicationAgent);
+  getColdState().vectApplications.push_back(_applicationAgent);
 }
 
 bool Node::attachServerApplicationAgent(ServerApplicationAgent *_serverApplicationAgent, int _port) {
   //cout << "Attaching ServerApplicationAgent on node " << id << "  port:" << _port << endl;
-  return serverApplicationsMap.insert(pair<int, ServerApplicationAgent*>(_port,_serverApplicationAgent)).second;
+  return getColdState().serverApplicationsMap.insert(pair<int, ServerApplicationAgent*>(_port,_serverApplicationAgent)).second;
 }
 
 void Node::dispatchPacketToApplication(PacketPtr _packet) {
-  auto it = serverApplicationsMap.find(_packet->port);
-  if (it != serverApplicationsMap.end()) {
+  if (cold == nullptr) return;
+  auto it = cold->serverApplicationsMap.find(_packet->port);
+  if (it != cold->serverApplicationsMap.end()) {
     // forwarding packet to bound server application
     it->second->receivePacket(_packet);
   } else {
@@ -158,27 +193,66 @@ void Node::dispatchPacketToApplication(PacketPtr _packet) {
 void Node::enqueueOutgoingPacket(PacketPtr _p) {
   //cerr << " ENQUEUE packet buffer size of node " << id << " is " << outputPacketBuffer.size() << " new packet is " << p->sequence << " beta " << p->beta<< endl;
 
-  // TODO ? simultaneous emission of several packets
-
   _p->transmitterId = id;
 
-  outputPacketBuffer.push(_p);
+  RingBuffer<PacketPtr> &outputPacketBuffer = getColdState().outputPacketBuffer;
+  if (outputPacketBuffer.full()) {
+    PacketPtr dropped = _p;
+    if (ScenarioParameters::getOutputBufferDropPolicy() == DropPolicy::HEAD) {
+      dropped = outputPacketBuffer.front();
+      outputPacketBuffer.pop();
+      outputPacketBuffer.push(_p);
+    }
+    overflowDrops++;
+    LogSystem::EventsLogOutput.log( LogSystem::overflowEventLog, Scheduler::now(), id, dropped->beta, dropped->size, dropped->type, dropped->flowId, dropped->flowSequenceNumber);
+  } else
+    outputPacketBuffer.push(_p);
 
-  if (outputPacketBuffer.size() == 1){
-    Scheduler::getScheduler().schedule(new StartSendPacketEvent(Scheduler::now(), this, outputPacketBuffer.front()));
-  }
+  startTransmissions();
 
   //cout << "AFTER ENQUEUE packet buffer size of node " << id << " is " << outputPacketBuffer.size() << " new packet is " << p << endl;
 }
 
+// Moves waiting packets to the transmissions: the oldest one when nothing is
+// being transmitted, and with --allowMultipleSend every one whose beta differs
+// from those of the packets being transmitted, TS-OOK interleaving their pulses.
+void Node::startTransmissions() {
+  RingBuffer<PacketPtr> &outputPacketBuffer = cold->outputPacketBuffer;
+  vector<transmissionSlot_t> &transmissions = cold->transmissions;
+  if (!ScenarioParameters::getAllowMultipleSend()) {
+    if (transmissions.empty() && !outputPacketBuffer.empty()) {
+      transmissions.push_back({ outputPacketBuffer.front(), -1 });
+      outputPacketBuffer.pop();
+      Scheduler::getScheduler().schedule(new StartSendPacketEvent(Scheduler::now(), this, transmissions.back().packet));
+    }
+    return;
+  }
+
+  for (size_t i = 0; i < outputPacketBuffer.size(); ) {
+    PacketPtr packet = outputPacketBuffer[i];
+    bool sameBeta = false;
+    for (const transmissionSlot_t &t : transmissions)
+      sameBeta = sameBeta || t.packet->beta == packet->beta;
+    if (sameBeta) {
+      i++;
+      continue;
+    }
+    transmissions.push_back({ packet, -1 });
+    outputPacketBuffer.erase(i);
+    Scheduler::getScheduler().schedule(new StartSendPacketEvent(Scheduler::now(), this, packet));
+  }
+}
+
 bool Node::detectPacketCollision(PacketPtr _p, simulationTime_t _p1StartTime) {
   //cout << "Detect collision on node dpc" << id << endl;
 
   //
-  // A packet being transmitted can collide with an incoming one
+  // The packets being transmitted can collide with an incoming one
   //
-  if (currentTransmitedPacketStartTime != -1 && !outputPacketBuffer.empty())  {
-    _p->checkAndTagCollision(_p1StartTime, outputPacketBuffer.front(), currentTransmitedPacketStartTime);
+  if (cold != nullptr) {
+    for (const transmissionSlot_t &t : cold->transmissions)
+      if (t.startTime != -1)
+        _p->checkAndTagCollision(_p1StartTime, t.packet, t.startTime);
   }
 
 
@@ -187,9 +261,9 @@ bool Node::detectPacketCollision(PacketPtr _p, simulationTime_t _p1StartTime) {
   // the reception buffer, as it may cause a collision with some of them.
   // In case of collision the affected packets will get a mark that will prevent their reception
   //
-  for ( map<PacketPtr,simulationTime_t>::iterator it = receptionBuffer.begin(); it != receptionBuffer.end(); it++) {
-    if (_p->packetId != it->first->packetId) {
-      _p->checkAndTagCollision(_p1StartTime, it->first, it->second);
+  for (receptionSlot_t *it = receptionSlots; it != receptionSlots + receptionCount; it++) {
+    if (_p->packetId != it->packet->packetId) {
+      _p->checkAndTagCollision(_p1StartTime, it->packet, it->startTime);
     }
   }
 
@@ -197,10 +271,10 @@ bool Node::detectPacketCollision(PacketPtr _p, simulationTime_t _p1StartTime) {
   // If the current packet is not a parasite (see maxConcurrentReceptions parameter)
   // it has to be checked also against all current parasites, that may collision with it.
   //
-  if (!_p->parasite) {
-    for ( map<PacketPtr,simulationTime_t>::iterator it = parasiteReceptionBuffer.begin(); it != parasiteReceptionBuffer.end(); it++) {
-      if (_p->packetId != it->first->packetId) {
-        _p->checkAndTagCollision(_p1StartTime, it->first, it->second);
+  if (!_p->parasite && cold != nullptr) {
+    for (auto it = cold->parasiteReceptions.begin(); it != cold->parasiteReceptions.end(); it++) {
+      if (_p->packetId != it->packet->packetId) {
+        _p->checkAndTagCollision(_p1StartTime, it->packet, it->startTime);
       }
     }
   }
@@ -223,9 +297,9 @@ void Node::processStartSendEvent(PacketPtr packet) {
   simulationTime_t guardInterval = 0;
   simulationTime_t guardIntervalReceive = 0;
   simulationTime_t diffSend, diffReceive;
-  diffSend = Scheduler::now() - lastEndSend;
+  diffSend = Scheduler::now() - hot.lastEndSend[id];
   if (diffSend < ScenarioParameters::getMinimumIntervalBetweenSends()) guardInterval = ScenarioParameters::getMinimumIntervalBetweenSends() - diffSend;
-  diffReceive = Scheduler::now() - lastEndReceive;
+  diffReceive = Scheduler::now() - hot.lastEndReceive[id];
   if (diffReceive < ScenarioParameters::getMinimumIntervalBetweenReceiveAndSend()) guardIntervalReceive = ScenarioParameters::getMinimumIntervalBetweenReceiveAndSend() - diffReceive;
   if (guardInterval < guardIntervalReceive) guardInterval = guardIntervalReceive;
 
@@ -239,21 +313,61 @@ void Node::processStartSendEvent(PacketPtr packet) {
 
   // simulationTime_t delayBeforeTransmission = 0;
 
+  // propagation from the positions of the nodes at this date
+  World::getWorld()->updatePositions();
+
   if (ScenarioParameters::getDoNotUseNeighboursList())
     World::getWorld()->sendPacketToNeighbours(this, packet, delayBeforeTransmission);
-  else
-    for (auto it = neighboursMap.begin(); it != neighboursMap.end() ; it ++) {
-      if ((packet->type == PacketType::SLR_BEACON && it->first <= ScenarioParameters::getCommunicationRangeSmall()) || packet->type != PacketType::SLR_BEACON) {
-        receptionTime = Scheduler::now() + delayBeforeTransmission + it->first/PROPAGATIONSPEED;
-        if (it->second->isAwake (receptionTime)) {
+  else {
+    // the neighbours in range are a prefix of the list, sorted by distance
+    distance_t range;
+    if (packet->type == PacketType::SLR_BEACON)
+      range = ScenarioParameters::getCommunicationRangeSmall();
+    else if (packet->communicationRange == -1)
+      range = getCommunicationRange();
+    else {
+      assert (packet->communicationRange <= getCommunicationRange());
+      range = packet->communicationRange;
+    }
+    // with mobility, the distances of the list are those of its last build,
+    // at most one skin away from the current ones
+    bool mobile = World::getWorld()->isMobile();
+    const neighbour_t *end = neighbours + getNeighboursWithin(range + World::getWorld()->getNeighboursSkin());
+
+    // --linkShadowing: the neighbours closer than range - 6 sigma are always reached
+    const distance_t *linkShadowing = nullptr;
+    distance_t standardDeviation = ScenarioParameters::getCommunicationRangeStandardDeviation();
+    distance_t safeRange = 0;
+    if (ScenarioParameters::getLinkShadowing() && standardDeviation != 0 && packet->type != PacketType::SLR_BEACON) {
+      linkShadowing = World::getWorld()->getLinkShadowing(this, neighbours, neighboursListSize);
+      safeRange = range - standardDeviation*6;
+    }
+    // sleeping nodes: the phase of each reception in the period ts follows
+    // from the phase of the transmission, see SleepingNode::isAwakeInPhase
+    bool sleeping = SleepingNode::hasAwakeWindows();
+    simulationTime_t ts = 0, sendPhase = 0;
+    if (sleeping) {
+      ts = SleepingNode::getPeriod();
+      sendPhase = (Scheduler::now() + delayBeforeTransmission) % ts;
+    }
+
+    for (const neighbour_t *it = neighbours; it != end; it++) {
+      distance_t distance = mobile ? this->distance(it->node) : it->distance;
+      if (distance <= range && (linkShadowing == nullptr || distance <= safeRange || distance <= range + linkShadowing[it - neighbours])) {
+        receptionTime = Scheduler::now() + delayBeforeTransmission + distance/PROPAGATIONSPEED;
+        simulationTime_t phase = sendPhase + distance/PROPAGATIONSPEED;
+        if (sleeping && phase >= ts) phase %= ts;
+        if (!sleeping || SleepingNode::isAwakeInPhase(it->node->getId(), phase)) {
           //PacketPtr packetClone = PacketPtr(new Packet(packet));
           PacketPtr packetClone = PacketPtr(packet->clone());
-          Scheduler::getScheduler().schedule(new StartReceivePacketEvent(receptionTime, it->second, packetClone));
+          Scheduler::getScheduler().schedule(new StartReceivePacketEvent(receptionTime, it->node, packetClone));
         }
       }
+    }
   }
 
-  currentTransmitedPacketStartTime = Scheduler::now() + delayBeforeTransmission;
+  for (transmissionSlot_t &t : cold->transmissions)
+    if (t.packet == packet) t.startTime = Scheduler::now() + delayBeforeTransmission;
   Scheduler::getScheduler().schedule(new EndSendPacketEvent(Scheduler::now() + delayBeforeTransmission + packetDuration, this, packet));
 
   //     LogSystem::EventsLogOutput.log( LogSystem::channelUsage, currentTransmitedPacketStartTime,_event->packet->type,_event->packet->flowId,_event->packet->flowSequenceNumber,_event->packet->beta, "+" );
@@ -264,18 +378,21 @@ void Node::processEndSendPacket(PacketPtr packet) {
   //
   // The outgoing packet may have caused collision on still incoming packets, we have to check all of them
   //
-  for ( map<PacketPtr,simulationTime_t>::iterator it = receptionBuffer.begin(); it != receptionBuffer.end(); it++) {
-    if (outputPacketBuffer.front()->packetId != it->first->packetId) {
-      outputPacketBuffer.front()->checkAndTagCollision(currentTransmitedPacketStartTime, it->first, it->second);
+  vector<transmissionSlot_t> &transmissions = cold->transmissions;
+  auto transmission = transmissions.begin();
+  while (transmission != transmissions.end() && transmission->packet != packet) transmission++;
+  assert (transmission != transmissions.end());
+  for (receptionSlot_t *it = receptionSlots; it != receptionSlots + receptionCount; it++) {
+    if (packet->packetId != it->packet->packetId) {
+      packet->checkAndTagCollision(transmission->startTime, it->packet, it->startTime);
     }
   }
 
   //
-  // remove the current packet from the outgoing buffer
-  // then schedule the transmission of the following one (if exists)
+  // remove the packet from the transmissions
+  // then schedule the transmission of the following ones (if exist)
   //
-  outputPacketBuffer.pop();
-  currentTransmitedPacketStartTime = -1;
+  transmissions.erase(transmission);
 
   //if ( ScenarioParameters::getLogAtNodeLevel() ) {
   LogSystem::EventsLogOutput.log( LogSystem::sentEventLog, Scheduler::now(), id, packet->transmitterId, packet->beta, packet->size,packet->type,packet->flowId,packet->flowSequenceNumber);
@@ -287,10 +404,8 @@ void Node::processEndSendPacket(PacketPtr packet) {
   if (ScenarioParameters::getGraphicMode()) {
     World::drawNode(packet->transmitterId, DrawingType::SEND);
   }
-  if (outputPacketBuffer.size() > 0) {
-    Scheduler::getScheduler().schedule(new StartSendPacketEvent(Scheduler::now(), this, outputPacketBuffer.front()));
-  }
-  lastEndSend = Scheduler::now();
+  startTransmissions();
+  hot.lastEndSend[id] = Scheduler::now();
 
   //if (packet->type == PacketType::DATA && id != packet->srcId){
   //    string filename = ScenarioParameters::getScenarioDirectory()+"/memoryTrace.data";
@@ -305,13 +420,14 @@ void Node::processStartReceivePacketEvent(StartReceivePacketEvent *_event) {
   simulationTime_t packetDuration =  (Node::getPulseDuration() * packet->beta) * (packet->size-1) + Node::getPulseDuration();
   simulationTime_t endReceptionTime = Scheduler::now() + packetDuration;
 
-  if (receptionBuffer.size() < ScenarioParameters::getMaxConcurrentReceptions() ) {
+  if (receptionCount < ScenarioParameters::getMaxConcurrentReceptions() ) {
     //   fprintf(LogSystem::EventsLogC,"a %d %d %d %ld %d %d %d %d\n", id, packet->srcSequenceNumber, packet->packetId, Scheduler::now(), packet->flowId, packet->transmitterId, packet->size, packet->beta);
-    receptionBuffer.insert(pair<PacketPtr,simulationTime_t>(packet, _event->date));
+    if (receptionSlots == nullptr) receptionSlots = new receptionSlot_t[ScenarioParameters::getMaxConcurrentReceptions()];
+    receptionSlots[receptionCount++] = {packet, _event->date};
   } else {
     //   fprintf(LogSystem::EventsLogC,"b %d %d %d %ld %d %d %d %d\n", id, packet->srcSequenceNumber, packet->packetId, Scheduler::now(), packet->flowId, packet->transmitterId, packet->size, packet->beta);
     packet->parasite = true;
-    parasiteReceptionBuffer.insert(pair<PacketPtr,simulationTime_t>(packet, _event->date));
+    getColdState().parasiteReceptions.push_back({packet, _event->date});
   }
   Scheduler::getScheduler().schedule(new EndReceivePacketEvent(endReceptionTime, this, packet, _event->date));
 }
@@ -319,7 +435,7 @@ void Node::processStartReceivePacketEvent(StartReceivePacketEvent *_event) {
 void Node::processEndReceivePacketEvent(EndReceivePacketEvent *_event) {
   PacketPtr packet = _event->packet;
 
-  lastEndReceive = Scheduler::now();
+  hot.lastEndReceive[id] = Scheduler::now();
 
   if (!detectPacketCollision(packet, _event->receptionStartTime)) {
     //
@@ -423,55 +539,30 @@ void Node::processEndReceivePacketEvent(EndReceivePacketEvent *_event) {
     intervalInfoLog->totalBitsReceived += packet->size;
     intervalInfoLog->bitsCollisioned += (int)packet->modifiedBitsPositions.size();
   }
-  if (packet->parasite) {
-    parasiteReceptionBuffer.erase(packet);
-  } else {
-    receptionBuffer.erase(packet);
-  }
+  removeReception(packet);
   //cout << "NODE " << id << "processEndReceive  now:" << Scheduler::now() << "  _event->date:" << _event->date << "  _event->receptionStartTime:" << _event->receptionStartTime << endl;
 }
 
-void Node::startLogging(simulationTime_t _interval, simulationTime_t _endTime) {
-  cout << "INTERVAL LOG starting" << endl;
-  string fileName = ScenarioParameters::getScenarioDirectory() + ScenarioParameters::getOutputBaseName()+"-node-"+to_string(id)+".log";
-  nodeLogFile = fopen(fileName.c_str(), "w");
-  loggingInterval = _interval;
-  endLoggingTime = _endTime;
-  intervalInfoLog = IntervalInfoLogPtr(new IntervalInfoLog());
-  intervalInfoLog->bitsIgnored++;
-  if ( loggingInterval > 0 && Scheduler::now() <= endLoggingTime) {
-    Scheduler::getScheduler().schedule(new NodeLogEvent(Scheduler::now() + loggingInterval, this));
-  }
-}
-
-void Node::processNodeLogEvent() {
-  if (intervalInfoLog != nullptr) {
-    double channelUsage = 100 * intervalInfoLog->totalBitsReceived / ((double)loggingInterval / (double)ScenarioParameters::getPulseDuration());
-    //        cout << "Interval log on node " << id<< ":" << endl;
-    //        cout << "    " << intervalInfoLog->totalPacketsReceived << " packets total / ";
-    //        cout << intervalInfoLog->totalBitsReceived << " bits total / ";
-    //        cout << channelUsage << "% channel usage" << endl;
-    //        cout << "    " << intervalInfoLog->packetsCorrectlyReceived << " corrects (" << ((double)intervalInfoLog->packetsCorrectlyReceived / intervalInfoLog->totalPacketsReceived) * 100 << "%)";
-    //        cout << "    " << intervalInfoLog->packetsCollisioned << " collisioned (" <<((double)intervalInfoLog->packetsCollisioned / intervalInfoLog->totalPacketsReceived) * 100 << "%)";
-    //        cout << "    " << intervalInfoLog->packetsIgnored << " ignored (" <<((double)intervalInfoLog->packetsIgnored / intervalInfoLog->totalPacketsReceived) * 100 << "%)";
-    //        cout << endl;
-    fprintf(nodeLogFile,"interval: %ld totalPackets: %d totalBits: %d channelUsage: %lf okPcks: %d okBits: %d cPkts: %d cBits: %d iPkt: %d iBits: %d\n",
-      loggingInterval,
-      intervalInfoLog->totalPacketsReceived,
-      intervalInfoLog->totalBitsReceived,
-      channelUsage,
-      intervalInfoLog->packetsCorrectlyReceived,
-      intervalInfoLog->bitsCorrectlyReceived,
-      intervalInfoLog->packetsCollisioned,
-      intervalInfoLog->bitsCollisioned,
-      intervalInfoLog->packetsIgnored,
-      intervalInfoLog->bitsIgnored);
-    if ( loggingInterval > 0 && Scheduler::now() <= endLoggingTime) {
-      Scheduler::getScheduler().schedule(new NodeLogEvent(Scheduler::now() + loggingInterval, this));
-    } else {
-      fclose(nodeLogFile);
+// Collision tagging does not depend on the order of the receptions, so a
+// finished one is replaced by the last one
+void Node::removeReception(PacketPtr _packet) {
+  if (_packet->parasite) {
+    vector<receptionSlot_t> &parasites = cold->parasiteReceptions;
+    for (auto it = parasites.begin(); it != parasites.end(); it++) {
+      if (it->packet == _packet) {
+        *it = parasites.back();
+        parasites.pop_back();
+        return;
+      }
+    }
+  } else {
+    for (unsigned int i = 0; i < receptionCount; i++) {
+      if (receptionSlots[i].packet == _packet) {
+        receptionSlots[i] = receptionSlots[--receptionCount];
+        receptionSlots[receptionCount].packet.reset();
+        return;
+      }
     }
-    intervalInfoLog->reset();
   }
 }
 
@@ -523,9 +614,11 @@ void Node::startupCode() {
     D11DensityEstimatorAgent *D11DensityEstimator = new D11DensityEstimatorAgent(this, 1, 4000, PacketType::D1_DENSITY_PROBE, 10000000000, 1,2);
     attachServerApplicationAgent(D11DensityEstimator, 4000);
 
-    if ( ScenarioParameters::getD1DoNotSimulateInitFlood() ) {
+    if ( ScenarioParameters::getDedenOracle() ) {
+      D11DensityEstimator->estimateFromOracle();
+    } else if ( ScenarioParameters::getD1DoNotSimulateInitFlood() ) {
       simulationTime_t t = Scheduler::now();
-      Scheduler::getScheduler().schedule(new D11DensityEstimatorGenerationEvent(t,D11DensityEstimator));
+      Scheduler::getScheduler().scheduleTimer(new D11DensityEstimatorGenerationEvent(t,D11DensityEstimator));
     } else {
       if (id == 0) {
         cout << "Node 0 initialization ..." << endl;
@@ -533,7 +626,7 @@ void Node::startupCode() {
         routingAgent->receivePacketFromApplication(p);
 
         simulationTime_t t = Scheduler::now();
-        Scheduler::getScheduler().schedule(new D11DensityEstimatorGenerationEvent(t,D11DensityEstimator));
+        Scheduler::getScheduler().scheduleTimer(new D11DensityEstimatorGenerationEvent(t,D11DensityEstimator));
       }
     }
   }
@@ -547,31 +640,26 @@ void Node::startupCode() {
 //==============================================================================
 
 class SleepingNode;
-mt19937_64 *SleepingNode::RNG =  new mt19937_64(0);
 simulationTime_t SleepingNode::ts;
+vector<awakeWindow_t> SleepingNode::awakeWindows;
 
 SleepingNode::SleepingNode(int _id, distance_t _x, distance_t _y, distance_t _z) : Node(_id,_x,_y, _z) {
-  initialized = 0;
   if ( id == 0 ){
-    RNG = new mt19937_64(ScenarioParameters::getSleepRNGSeed());
-    ts = currentBeta * pulseDuration;
+    ts = getBeta() * pulseDuration;
   }
+  // always awake until processSleepingSetUpEvent
+  if ((int)awakeWindows.size() <= id)
+    awakeWindows.resize(id + 1, { 0, numeric_limits<simulationTime_t>::max() });
 }
 
 // schedule only if SleepingNode is awake at reception
 bool SleepingNode::isAwake (simulationTime_t receptionTime) {
-  // the second term of the or condition deals with the case where the awake
-  // duration spreads over 2 consecutive ts, i.e. awakenStart+awakenDuration > ts
-  bool receiverAwake = (receptionTime%ts >= awakenStart && receptionTime%ts < awakenStart + awakenDuration)
-    || receptionTime%ts < awakenStart + awakenDuration - ts;
-  if (!receiverAwake && initialized != 0)
-    return false;
-  return true;
+  return isAwakeInPhase(id, receptionTime % ts);
 }
 
 void SleepingNode::processSleepingSetUpEvent() {
   int min = 300;  // it makes no sense to stay awake for a lesser duration
-  initialized = 1;
+  int awakenDuration;
 
   if (ScenarioParameters::getAwakenNodes()){
     // the average number of awake neighbours was specified, transform it in absolute duration
@@ -585,8 +673,11 @@ void SleepingNode::processSleepingSetUpEvent() {
     exit(-1);
   }
 
+  uint64_t sleepDraws = 0;
+  CounterRNG sleepRNG(ScenarioParameters::getSleepRNGSeed(), id, RNGPurpose::SLEEP, sleepDraws);
   uniform_int_distribution<time_t> distrib(0, ts);
-  awakenStart = distrib(*RNG); // NODES WILL START SEPARATELY
+  int awakenStart = distrib(sleepRNG); // NODES WILL START SEPARATELY
+  awakeWindows[id] = { awakenStart, awakenDuration };
 }
 
 
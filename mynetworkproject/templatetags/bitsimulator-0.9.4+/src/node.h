@@ -21,16 +21,20 @@
 #define NODE_H_
 
 #include <iostream>
+#include <limits>
 #include <queue>
 #include "utils.h"
+#include "ring-buffer.h"
 #include "packet.h"
 #include "events.h"
+#include "counter-rng.h"
 
 #define PROPAGATIONSPEED 300
 
 class RoutingAgent;
 class ApplicationAgent;
 class ServerApplicationAgent;
+class Node;
 class StartSendPacketEvent;
 class EndSendPacketEvent;
 class StartReceivePacketEvent;
@@ -51,6 +55,45 @@ typedef struct {
   uniform_int_distribution<simulationTime_t> backoffDistribution;
 } backoffHelper_t;
 
+// one entry of the neighbour table built by World::initNodes
+typedef struct {
+  distance_t distance;
+  Node *node;
+} neighbour_t;
+
+// a packet being received, and the date its reception started
+typedef struct {
+  PacketPtr packet;
+  simulationTime_t startTime;
+} receptionSlot_t;
+
+// a packet being transmitted, and the date its transmission started (-1
+// until its StartSendPacketEvent is processed)
+typedef struct {
+  PacketPtr packet;
+  simulationTime_t startTime;
+} transmissionSlot_t;
+
+// The state read on every packet, kept in arrays indexed by node id rather
+// than in the Node objects, so that large worlds stay compact
+typedef struct {
+  vector<distance_t> x, y, z;
+  vector<distance_t> communicationRange;
+  vector<distance_t> communicationRangeStandardDeviation;
+  vector<simulationTime_t> lastEndSend;
+  vector<simulationTime_t> lastEndReceive;
+  vector<simulationTime_t> beta;
+} nodesHotState_t;
+
+// The state most nodes never use, allocated by the first one which needs it
+typedef struct {
+  map<int,ServerApplicationAgent*> serverApplicationsMap;
+  vector<ApplicationAgent*> vectApplications;
+  RingBuffer<PacketPtr> outputPacketBuffer;  // packets waiting for their transmission
+  vector<transmissionSlot_t> transmissions;  // at most one without --allowMultipleSend
+  vector<receptionSlot_t> parasiteReceptions;
+} nodeColdState_t;
+
 class IntervalInfoLog{
 public:
   int totalPacketsReceived;
@@ -64,49 +107,56 @@ public:
 
   IntervalInfoLog();
   void reset();
+  bool isIdle() const;  // nothing received since the last reset
 };
 
-typedef shared_ptr<IntervalInfoLog> IntervalInfoLogPtr;
 
 class Node {
 protected:
   static int nextId;
   static simulationTime_t pulseDuration;
 
-  static mt19937_64 *backoffRandomGenerator;
+  static int backoffRNGSeed;
   static uniform_int_distribution<distance_t> defaultBackoffDistribution;
   static map<PacketType,backoffHelper_t> specificBackoffsMap;
+  static nodesHotState_t hot;
+  static unsigned long overflowDrops;  // packets lost by full output buffers
 
   int id;
-
-  distance_t x,y,z;
+  int nodeSequenceNumber;
 
   RoutingAgent *routingAgent;
-  map<int,ServerApplicationAgent*> serverApplicationsMap;
-  vector<ApplicationAgent*> vectApplications;
-
-  queue<PacketPtr> outputPacketBuffer;
-  simulationTime_t currentTransmitedPacketStartTime;
-  simulationTime_t lastEndSend;
-  simulationTime_t lastEndReceive;
-  simulationTime_t currentBeta;
-  int nodeSequenceNumber;
+  nodeColdState_t *cold;  // nullptr until needed
 
-  multimap<distance_t ,Node*> neighboursMap;
+  // maxConcurrentReceptions slots, allocated at the first reception
+  receptionSlot_t *receptionSlots;
+  unsigned int receptionCount;
   int estimatedNeighbours;
 
-  map<PacketPtr, simulationTime_t> receptionBuffer;
-  map<PacketPtr, simulationTime_t> parasiteReceptionBuffer;
+  // draws made so far from the random streams of this node
+  uint64_t backoffDraws;
+  uint64_t shadowingDraws;
+  uint64_t payloadDraws;
 
+  // neighbours sorted by distance, a slice of the World neighbour table
+  const neighbour_t *neighbours;
+  int neighboursListSize;
   int neighboursCount;
+  // the last two ranges asked to getNeighboursWithin, and the answers
+  distance_t cutoffRange[2];
+  int cutoff[2];
 
-  IntervalInfoLogPtr intervalInfoLog;
-  simulationTime_t endLoggingTime;
-  simulationTime_t loggingInterval;
-  FILE *nodeLogFile;
+  IntervalInfoLog *intervalInfoLog;  // in IntervalLog, nullptr when disabled
 
-  distance_t communicationRange;
-  distance_t communicationRangeStandardDeviation;
+  nodeColdState_t &getColdState() {
+    if (cold == nullptr) {
+      cold = new nodeColdState_t;
+      cold->outputPacketBuffer.setCapacity(ScenarioParameters::getOutputBufferCapacity());
+    }
+    return *cold;
+  }
+  void startTransmissions();
+  void removeReception(PacketPtr _packet);
 
 public:
   Node(int _id, distance_t _x, distance_t _y, distance_t _z);
@@ -115,10 +165,9 @@ public:
   static int getNextId() { return(nextId); }
 
   static void initBackoffRandomGenerator(int _seed) {
-    backoffRandomGenerator = new mt19937_64(_seed);
+    backoffRNGSeed = _seed;
     defaultBackoffDistribution = uniform_int_distribution<distance_t>(0,ScenarioParameters::getdefaultBackoffWindowWidth());
   }
-  static mt19937_64 *getBackoffRNG() { return(backoffRandomGenerator); }
   static void setPulseDuration(simulationTime_t _duration) { pulseDuration = _duration; }
   static void registerSpecificBackoff(PacketType _type, simulationTime_t _min, simulationTime_t _max) {
     map<PacketType, backoffHelper_t>::iterator it;
@@ -136,37 +185,48 @@ public:
     cout << "Unregistering the specific backoff for packet type " << (int)_type << endl;
     specificBackoffsMap.erase(_type);
   }
-  static simulationTime_t getNewBackoff(PacketType _type) {
+  simulationTime_t getNewBackoff(PacketType _type) {
+    CounterRNG backoffRNG(backoffRNGSeed, id, RNGPurpose::BACKOFF, backoffDraws);
     map<PacketType, backoffHelper_t>::iterator it;
     it = specificBackoffsMap.find(_type);
     if (it != specificBackoffsMap.end()) {
-      return it->second.backoffDistribution(*backoffRandomGenerator);
+      return it->second.backoffDistribution(backoffRNG);
     } else {
-      return defaultBackoffDistribution(*backoffRandomGenerator);
+      return defaultBackoffDistribution(backoffRNG);
     }
   }
+  CounterRNG getShadowingRNG(uint64_t _seed) {
+    return CounterRNG(_seed, id, RNGPurpose::SHADOWING, shadowingDraws);
+  }
+  uint64_t &getPayloadDraws() { return payloadDraws; }
 
   static simulationTime_t getPulseDuration() { return pulseDuration; }
 
-  distance_t distance(Node *_n) { return((distance_t)(sqrt( pow(x-_n->x,2) + pow(y-_n->y,2) + pow(z-_n->z,2)))); }
+  distance_t distance(Node *_n) { return distance(hot.x[_n->id], hot.y[_n->id], hot.z[_n->id]); }
   distance_t distance(distance_t dx, distance_t dy, distance_t dz) {
     return (distance_t)(
-      sqrt( pow(dx - x, 2) + pow(dy - y, 2) + pow(dz - z, 2)));
+      sqrt( pow(dx - hot.x[id], 2) + pow(dy - hot.y[id], 2) + pow(dz - hot.z[id], 2)));
   }
 
-  void addNeighbour(distance_t _distance, Node *_node) { neighboursMap.insert(pair<distance_t, Node*>(_distance, _node)); }
+  void setNeighbours(const neighbour_t *_neighbours, int _count) {
+    neighbours = _neighbours;
+    neighboursListSize = _count;
+    cutoffRange[0] = cutoffRange[1] = -1;
+  }
+  int getNeighboursWithin(distance_t _range);
   int getNeighboursCount();
   void setNeighboursCount(int count);
 
   int getId() { return id; }
-  simulationTime_t getBeta() { return currentBeta; }
+  simulationTime_t getBeta() { return hot.beta[id]; }
   int getNextSrcSequenceNumber() { return nodeSequenceNumber++; }
   int getEstimatedNeighbours () {return estimatedNeighbours; }
   void setEstimatedNeighbours (int e ) {estimatedNeighbours = e; }
 
-  distance_t getXPos() { return(x); }
-  distance_t getYPos() { return(y); }
-  distance_t getZPos() { return(z); }
+  void setPosition(distance_t _x, distance_t _y, distance_t _z) { hot.x[id] = _x; hot.y[id] = _y; hot.z[id] = _z; }
+  distance_t getXPos() { return(hot.x[id]); }
+  distance_t getYPos() { return(hot.y[id]); }
+  distance_t getZPos() { return(hot.z[id]); }
 
   void attachRoutingAgent(RoutingAgent *_routingAgent);
   void attachApplicationAgent(ApplicationAgent *_applicationAgent);
@@ -175,13 +235,13 @@ public:
   RoutingAgent *getRoutingAgent() { return routingAgent; };
 
   void enqueueOutgoingPacket(PacketPtr p);
-  void popPacketFromOutputPacketBuffer() { outputPacketBuffer.pop(); }
-  unsigned long int outputPacketBufferSize() { return outputPacketBuffer.size(); }
+  unsigned long int outputPacketBufferSize() { return cold ? cold->outputPacketBuffer.size() + cold->transmissions.size() : 0; }
+  static unsigned long getOverflowDrops() { return overflowDrops; }
 
   bool detectPacketCollision(PacketPtr _p, simulationTime_t _p1StartTime);
 
   distance_t getCommunicationRange() {
-    return this->communicationRange;
+    return hot.communicationRange[id];
   }
   void setCommunicationRange( distance_t _cr ) {
     if ( _cr > ScenarioParameters::getCommunicationRange() ) {
@@ -189,19 +249,14 @@ public:
       exit (EXIT_FAILURE);
     }
 
-    if ( _cr != ScenarioParameters::getCommunicationRange() && !ScenarioParameters::getDoNotUseNeighboursList() ) {
-      cout << "*** ERROR, You cannot change the communication range at runtime if you are using the neighbours list" << endl;
-      exit (EXIT_FAILURE);
-    }
-
-    communicationRange = _cr;
+    hot.communicationRange[id] = _cr;
   }
 
   void setCommunicationRangeStandardDeviation( distance_t _crsd ) {
-    this->communicationRangeStandardDeviation = _crsd;
+    hot.communicationRangeStandardDeviation[id] = _crsd;
   }
   distance_t getCommunicationRangeStandardDeviation() {
-    return this->communicationRangeStandardDeviation;
+    return hot.communicationRangeStandardDeviation[id];
   }
 
 protected:
@@ -212,13 +267,12 @@ public:
   virtual void processStartReceivePacketEvent(StartReceivePacketEvent *_event);
   virtual void processEndReceivePacketEvent(EndReceivePacketEvent *_event);
 
-  void startLogging(simulationTime_t _interval, simulationTime_t _endTime);
-  void processNodeLogEvent();
+  void setIntervalInfoLog(IntervalInfoLog *_intervalInfoLog) { intervalInfoLog = _intervalInfoLog; }
 
   virtual void startupCode();
 
   inline unsigned int getConcurrentReceptionCount() {
-    return receptionBuffer.size();
+    return receptionCount;
   }
 
   // event types
@@ -242,18 +296,33 @@ using NodeStartupEvent = CallMethodEvent<Node, &Node::startupCode,
 //
 //==============================================================================
 
+// A node is awake at t if (t - start) mod ts < duration.  The windows of all
+// the nodes are in a flat array indexed by node id, so that the senders
+// select their awake receivers without calling isAwake on each of them.
+typedef struct {
+  simulationTime_t start;
+  simulationTime_t duration;
+} awakeWindow_t;
+
 class SleepingNode : public Node {
 protected:
-  static mt19937_64 *RNG;
   static simulationTime_t ts;
-  int initialized;
+  static vector<awakeWindow_t> awakeWindows;
 
 public:
   SleepingNode(int _id, distance_t _x, distance_t _y, distance_t _z);
   void processSleepingSetUpEvent();
 
-  int awakenStart;
-  int awakenDuration;
+  static bool hasAwakeWindows() { return !awakeWindows.empty(); }
+  static simulationTime_t getPeriod() { return ts; }
+  // _phase being the reception date modulo ts
+  static bool isAwakeInPhase(int _id, simulationTime_t _phase) {
+    if (_id >= (int)awakeWindows.size()) return true;
+    const awakeWindow_t &window = awakeWindows[_id];
+    simulationTime_t elapsed = _phase - window.start;
+    if (elapsed < 0) elapsed += ts;
+    return elapsed < window.duration;
+  }
   virtual bool isAwake(simulationTime_t receptionTime);
 };
 
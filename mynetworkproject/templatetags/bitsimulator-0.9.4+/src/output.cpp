@@ -20,8 +20,85 @@
 #include "utils.h"
 #include "output.h"
 #include <cstdarg>
+#include <climits>
+#include <fstream>
+#include <sstream>
+#include <algorithm>
 
-int OutputLineFormat::nextFormatID = 0;
+atomic<int> OutputLineFormat::nextFormatID(0);
+
+// gzip output blocks, and blocks allowed to wait for the compressor
+static const size_t compressedBlockSize = 1 << 20;
+static const size_t maxQueuedBlocks = 8;
+
+//===========================================================================================================
+//
+//          LogFilter  (class)
+//
+//===========================================================================================================
+
+// "0-99,150" -> [0,99] [150,150]
+vector<pair<int,int>> LogFilter::parseRanges(string _ranges) {
+  vector<pair<int,int>> ranges;
+  stringstream ss(_ranges);
+  string token;
+  while ( getline(ss, token, ',') ) {
+    int first, last;
+    char dash;
+    stringstream ts(token);
+    if ( !(ts >> first) ) {
+      cerr << "*** ERROR *** invalid range \"" << token << "\" in <filter> element" << endl;
+      exit(EXIT_FAILURE);
+    }
+    last = first;
+    if ( ts >> dash ) {
+      if ( dash != '-' || !(ts >> last) || last < first ) {
+        cerr << "*** ERROR *** invalid range \"" << token << "\" in <filter> element" << endl;
+        exit(EXIT_FAILURE);
+      }
+    }
+    ranges.push_back(pair<int,int>(first, last));
+  }
+  sort(ranges.begin(), ranges.end());
+  return ranges;
+}
+
+bool LogFilter::inRanges(const vector<pair<int,int>> &_ranges, long _value) {
+  if ( _ranges.empty() ) {
+    return true;
+  }
+  // last range starting at or before _value
+  auto it = upper_bound(_ranges.begin(), _ranges.end(), pair<int,int>((int)_value, INT_MAX));
+  while ( it != _ranges.begin() ) {
+    it--;
+    if ( _value <= it->second ) {
+      return true;
+    }
+    if ( it->first + (long)INT_MAX < _value ) {
+      break;
+    }
+  }
+  return false;
+}
+
+bool LogFilter::accept(const long *_values) {
+  if ( !enabled ) {
+    return false;
+  }
+  if ( timeIndex >= 0 && (_values[timeIndex] < from || (to >= 0 && _values[timeIndex] > to)) ) {
+    return false;
+  }
+  if ( nodeIndex >= 0 && !inRanges(nodeRanges, _values[nodeIndex]) ) {
+    return false;
+  }
+  if ( flowIndex >= 0 && !inRanges(flowRanges, _values[flowIndex]) ) {
+    return false;
+  }
+  if ( sample > 1 ) {
+    return (sampleCounter++ % sample) == 0;
+  }
+  return true;
+}
 
 //===========================================================================================================
 //
@@ -32,36 +109,332 @@ int OutputLineFormat::nextFormatID = 0;
 LogOutput::LogOutput() {
   //cout << "LogOutput constructor" << endl;
   outputFile = NULL;
-  buffer = (char*)malloc(4096);
-  xmlBuffer = (char*)malloc(10000);
-  bzero(xmlBuffer, 10000);
+  inputFile = nullptr;
+  sharded = false;
+  indexFile = nullptr;
+  shardDuration = 0;
+  shardRecords = 0;
+  shardSlotEnd = 0;
+  writtenBytes = 0;
+  shardIndex = 0;
+  compressed = false;
+  compressedFile = nullptr;
+  closing = false;
+  compressorFailed = false;
+  bufferSize = 4096;
+  buffer = (char*)malloc(bufferSize);
   currentFormat = nullptr;
 }
 
 LogOutput::~LogOutput() {
   //cout << "LogOutput destructor" << endl;
+  if ( compressed || sharded ) {
+    close();
+  }
   free(buffer);
-  free(xmlBuffer);
 }
 
-void LogOutput::create( string fileName ) {
-  outputFile = fopen( fileName.c_str(), "w" );
+// level 1 compresses these text logs almost as well as the default level
+// at several times the speed
+void LogOutput::create( string fileName, bool _compressed ) {
+  if ( _compressed ) {
+    compressedFile = gzopen( fileName.c_str(), "wb1" );
+    if ( compressedFile == nullptr ) {
+      cerr << "*** ERROR *** Cannot create compressed log file " << fileName << endl;
+      exit(EXIT_FAILURE);
+    }
+    compressed = true;
+    closing = false;
+    compressorFailed = false;
+    pendingBlock.reserve( compressedBlockSize );
+    compressorThread = thread( &LogOutput::compressorLoop, this );
+  } else {
+    outputFile = fopen( fileName.c_str(), "w" );
+  }
+}
+
+void LogOutput::createSharded( string _prefix, string _extension, bool _compressed, long _duration, long _records ) {
+  string indexName = _prefix + ".index";
+  indexFile = fopen( indexName.c_str(), "w" );
+  if ( indexFile == nullptr ) {
+    cerr << "*** ERROR *** Cannot create log index file " << indexName << endl;
+    exit(EXIT_FAILURE);
+  }
+  fprintf( indexFile, "# shard firstTime lastTime offset records file\n" );
+  sharded = true;
+  shardPrefix = _prefix;
+  shardExtension = _extension;
+  compressed = _compressed;
+  shardDuration = _duration;
+  shardRecords = _records;
+  currentShard.shard = -1;
+  writtenBytes = 0;
+}
+
+// the shard is created with its first line, so that empty time slots leave no file
+void LogOutput::openShard( long _time ) {
+  char number[16];
+  int shard = currentShard.shard + 1;
+  snprintf( number, sizeof(number), ".%04d", shard );
+  currentShard.shard = shard;
+  currentShard.firstTime = _time;
+  currentShard.lastTime = _time;
+  currentShard.offset = writtenBytes;
+  currentShard.records = 0;
+  currentShard.fileName = shardPrefix + number + shardExtension;
+  if ( shardDuration > 0 ) {
+    shardSlotEnd = _time - _time % shardDuration + shardDuration;
+  }
+  knownFormats.clear();
+  create( currentShard.fileName, compressed );
+}
+
+void LogOutput::closeShard() {
+  bool compressedShards = compressed;
+  closeFile();
+  compressed = compressedShards;
+  string name = currentShard.fileName.substr( currentShard.fileName.find_last_of('/') + 1 );
+  fprintf( indexFile, "%d %ld %ld %ld %ld %s\n", currentShard.shard, currentShard.firstTime, currentShard.lastTime,
+    currentShard.offset, currentShard.records, name.c_str() );
+  fflush( indexFile );
+}
+
+vector<logShardInfo_t> LogOutput::readIndex( string _indexFileName ) {
+  vector<logShardInfo_t> result;
+  ifstream index( _indexFileName );
+  if ( !index.is_open() ) {
+    cerr << "*** ERROR *** Cannot open log index file " << _indexFileName << endl;
+    exit(EXIT_FAILURE);
+  }
+  string line;
+  while ( getline(index, line) ) {
+    if ( line.empty() || line[0] == '#' ) {
+      continue;
+    }
+    logShardInfo_t shard;
+    stringstream ss(line);
+    if ( !(ss >> shard.shard >> shard.firstTime >> shard.lastTime >> shard.offset >> shard.records >> shard.fileName) ) {
+      cerr << "*** ERROR *** Invalid line in log index file " << _indexFileName << ": " << line << endl;
+      exit(EXIT_FAILURE);
+    }
+    result.push_back( shard );
+  }
+  return result;
 }
 
+// gzopen() reads uncompressed files as they are; an index file opens its shards in turn
 void LogOutput::open( string fileName ) {
-  outputFile = fopen( fileName.c_str(), "r" );
+  string extension = ".index";
+  if ( fileName.size() > extension.size() && fileName.compare(fileName.size() - extension.size(), extension.size(), extension) == 0 ) {
+    shards = readIndex( fileName );
+    size_t slash = fileName.find_last_of('/');
+    shardDirectory = ( slash == string::npos ) ? "" : fileName.substr( 0, slash + 1 );
+    openInputShard( 0 );
+    return;
+  }
+  inputFile = gzopen( fileName.c_str(), "rb" );
+  if ( inputFile != nullptr ) {
+    gzbuffer( inputFile, 128*1024 );
+  }
+}
+
+bool LogOutput::openInputShard( size_t _index ) {
+  if ( inputFile != nullptr ) {
+    gzclose( inputFile );
+    inputFile = nullptr;
+  }
+  shardIndex = _index;
+  if ( _index >= shards.size() ) {
+    return false;
+  }
+  string name = shardDirectory + shards[_index].fileName;
+  inputFile = gzopen( name.c_str(), "rb" );
+  if ( inputFile == nullptr ) {
+    cerr << "*** ERROR *** Cannot open log shard " << name << endl;
+    exit(EXIT_FAILURE);
+  }
+  gzbuffer( inputFile, 128*1024 );
+  return true;
+}
+
+// skips the shards which end before _time; no effect on a single file log
+void LogOutput::seek( long _time ) {
+  size_t index = shardIndex;
+  while ( index < shards.size() && shards[index].lastTime < _time ) {
+    index++;
+  }
+  if ( index != shardIndex ) {
+    openInputShard( index );
+  }
+}
+
+logPosition_t LogOutput::tell() {
+  logPosition_t position;
+  position.shard = shardIndex;
+  position.offset = ( inputFile != nullptr ) ? gztell( inputFile ) : 0;
+  return position;
+}
+
+// goes back (or forth) to a line start returned by tell(); formats declared
+// again after that point are recognized as already known
+void LogOutput::seek( const logPosition_t &_position ) {
+  if ( _position.shard != shardIndex || inputFile == nullptr ) {
+    openInputShard( _position.shard );
+  }
+  if ( inputFile == nullptr || gzseek( inputFile, _position.offset, SEEK_SET ) < 0 ) {
+    cerr << "*** ERROR *** Cannot seek to offset " << _position.offset << " of the log" << endl;
+    exit(EXIT_FAILURE);
+  }
+  xmlText.clear();
+  currentFormat = nullptr;
 }
 
 void LogOutput::close() {
-  fclose( outputFile );
+  if ( sharded ) {
+    if ( currentShard.shard >= 0 ) {
+      closeShard();
+    }
+    fclose( indexFile );
+    indexFile = nullptr;
+    sharded = false;
+    compressed = false;
+    return;
+  }
+  shards.clear();
+  closeFile();
+}
+
+void LogOutput::closeFile() {
+  if ( compressed ) {
+    if ( !pendingBlock.empty() ) {
+      flushBlock();
+    }
+    {
+      lock_guard<mutex> lock(compressorMutex);
+      closing = true;
+    }
+    compressorCondition.notify_all();
+    compressorThread.join();
+    gzclose( compressedFile );
+    compressedFile = nullptr;
+    compressed = false;
+    if ( compressorFailed ) {
+      cerr << "*** ERROR *** Failed to write compressed log file" << endl;
+      exit(EXIT_FAILURE);
+    }
+  }
+  if ( inputFile != nullptr ) {
+    gzclose( inputFile );
+    inputFile = nullptr;
+  }
+  if ( outputFile != NULL ) {
+    fclose( outputFile );
+    outputFile = NULL;
+  }
+}
+
+void LogOutput::compressorLoop() {
+  unique_lock<mutex> lock(compressorMutex);
+  while ( true ) {
+    compressorCondition.wait( lock, [this] { return !fullBlocks.empty() || closing; } );
+    if ( fullBlocks.empty() ) {
+      return;
+    }
+    string block = std::move( fullBlocks.front() );
+    fullBlocks.pop_front();
+    lock.unlock();
+    compressorCondition.notify_all();
+    if ( gzwrite( compressedFile, block.data(), block.size() ) != (int)block.size() ) {
+      // exit() must not be called from this thread: the destructor of the
+      // LogOutput would join it
+      lock.lock();
+      compressorFailed = true;
+      lock.unlock();
+      compressorCondition.notify_all();
+      return;
+    }
+    lock.lock();
+  }
+}
+
+// stops the simulation if the compressor thread failed to write
+void LogOutput::checkCompressor() {
+  {
+    lock_guard<mutex> lock(compressorMutex);
+    if ( !compressorFailed ) {
+      return;
+    }
+  }
+  closeFile();
+}
+
+// hands the pending block to the compressor, waiting if it is too far behind
+void LogOutput::flushBlock() {
+  unique_lock<mutex> lock(compressorMutex);
+  compressorCondition.wait( lock, [this] { return fullBlocks.size() < maxQueuedBlocks || compressorFailed; } );
+  fullBlocks.push_back( std::move(pendingBlock) );
+  lock.unlock();
+  compressorCondition.notify_all();
+  pendingBlock = string();
+  pendingBlock.reserve( compressedBlockSize );
+  checkCompressor();
+}
+
+void LogOutput::write( const string &_text ) {
+  if ( compressed ) {
+    pendingBlock += _text;
+    if ( pendingBlock.size() >= compressedBlockSize ) {
+      flushBlock();
+    }
+  } else {
+    fprintf( outputFile, "%s", _text.c_str() );
+  }
+  writtenBytes += _text.size();
+}
+
+// reads a whole line in buffer, growing it as needed; returns 0 at end of file
+size_t LogOutput::readLine() {
+  size_t length = 0;
+  while ( gzgets( inputFile, buffer + length, bufferSize - length ) != nullptr ) {
+    length += strlen( buffer + length );
+    if ( buffer[length-1] == '\n' || length < bufferSize - 1 ) {
+      break;
+    }
+    bufferSize *= 2;
+    buffer = (char*)realloc( buffer, bufferSize );
+  }
+  return length;
 }
 
 LogOutput::LineType LogOutput::readNextLine() {
-  size_t linecap = 4096;
-  ssize_t linelen;
+  size_t linelen;
 
-  static int xmlBufferPos = 0;
+  if ( inputFile == nullptr ) {
+    cout << "Fail to open" << endl;
+    return LineType::END_OF_FILE;
+  }
+
+  linelen = readLine();
+  while ( linelen == 0 && shardIndex + 1 < shards.size() ) {
+    openInputShard( shardIndex + 1 );
+    linelen = readLine();
+  }
+
+  return parseBuffer( linelen );
+}
+
+// parses a line read by another mean, e.g. a block of a log split between threads
+LogOutput::LineType LogOutput::parseLine( const char *_line, size_t _length ) {
+  if ( _length + 1 > bufferSize ) {
+    bufferSize = _length + 1;
+    buffer = (char*)realloc( buffer, bufferSize );
+  }
+  memcpy( buffer, _line, _length );
+  buffer[_length] = '\0';
+  return parseBuffer( _length );
+}
 
+LogOutput::LineType LogOutput::parseBuffer( size_t linelen ) {
   //format
   int formatId;
   string formatKey;
@@ -76,25 +449,23 @@ LogOutput::LineType LogOutput::readNextLine() {
 
   tinyxml2::XMLElement *elem;
 
-  if ( outputFile == NULL ) {
-    cout << "Fail to open" << endl;
-    return LineType::END_OF_FILE;
-  }
-
-  if ( (linelen = getline(&buffer, &linecap, outputFile)) > 0 ) {
+  if ( linelen > 0 ) {
     if (buffer[0] == '#') {
-      memcpy( xmlBuffer+xmlBufferPos, buffer+1, linelen-1);
-      xmlBufferPos += (linelen-1);
+      xmlText.append( buffer+1, linelen-1 );
       currentFormat = nullptr;
       return LineType::COMMENT;
 
     } else {
-      if ( xmlBufferPos > 0 ) {
-        //printf("xmlbuffer: %s\n", xmlBuffer);
+      if ( !xmlText.empty() ) {
+        //printf("xmlbuffer: %s\n", xmlText.c_str());
 
-        xmlDoc.Parse(xmlBuffer);
+        xmlDoc.Parse(xmlText.c_str());
         XMLRootNode = xmlDoc.FirstChildElement( "lineFormat" );
-        if ( XMLRootNode != nullptr ) {
+        if ( XMLRootNode == nullptr ) {
+          cout << "*** Error while reading XMLRootNode ***" << endl;
+        }
+        // several formats may be declared before a data line
+        for ( ; XMLRootNode != nullptr; XMLRootNode = XMLRootNode->NextSiblingElement( "lineFormat" ) ) {
           XMLRootNode->QueryIntAttribute( "id", &formatId);
           formatKey = string(XMLRootNode->Attribute( "key" ));
           formatDescription = string(XMLRootNode->Attribute( "description" ));
@@ -110,6 +481,10 @@ LogOutput::LineType LogOutput::readNextLine() {
           if ( it == mapKnownFormats.end() ) {
             format = new OutputLineFormat( formatId, formatKey, formatDescription );
             mapKnownFormats.insert( pair<int, OutputLineFormat*>(formatId, format) );
+          } else if ( it->second->formatKey == formatKey ) {
+            // every shard repeats the formats it uses, and a reader may seek back
+            format = it->second;
+            elem = nullptr;
           } else {
             cerr << "*** ERROR: format id " << formatId << " already seen" << endl;
             exit(EXIT_FAILURE);
@@ -147,28 +522,26 @@ LogOutput::LineType LogOutput::readNextLine() {
 
           }
 
-        } else {
-          cout << "*** Error while reading XMLRootNode ***" << endl;
         }
 
-        xmlBufferPos = 0;
-        bzero(xmlBuffer, 10000);
+        xmlText.clear();
       }
       //             cout << "data line : " << buffer;
-      char *stringToken = strtok(buffer," ");
+      char *tokenizerState;
+      char *stringToken = strtok_r(buffer," ",&tokenizerState);
       sscanf(stringToken,"%d",&formatId);
 
 
       map<int,OutputLineFormat*>::iterator itFormat;
       itFormat = mapKnownFormats.find(formatId);
-      currentFormat = itFormat->second;
       //             cout << " id:" << formatId << " " << itFormat->second->formatKey <<endl;
 
       if ( itFormat != mapKnownFormats.end() ) {
+        currentFormat = itFormat->second;
         vector<LogItem*>::iterator itLogItem;
         itLogItem = itFormat->second->vectorItems.begin();
         while ( itLogItem != itFormat->second->vectorItems.end() ) {
-          stringToken = strtok(NULL, " ");
+          stringToken = strtok_r(NULL, " ",&tokenizerState);
           switch ( (*itLogItem)->type ) {
           case LogItem::ItemType::INT32:
             (*itLogItem)->data.intValue = atoi(stringToken);
@@ -192,6 +565,7 @@ LogOutput::LineType LogOutput::readNextLine() {
           itLogItem++;
         }
       } else {
+        currentFormat = nullptr;
         cerr << "*** ERROR *** Unknown log format (" << formatId << ") while reading log file" << endl;
       }
       return LineType::DATA;
@@ -309,49 +683,68 @@ bool LogOutput::hasItem( string pKey ) {
 
 }
 
-void LogOutput::log( OutputLineFormat &format...) {
+void LogOutput::logLine( OutputLineFormat &format...) {
   va_list args;
   va_start(args, format);
-  string buffer;
-
-  if ( knownFormats.find( format.formatID ) == knownFormats.end() ) {
-    knownFormats.insert( format.formatID );
-
-    buffer = "#<lineFormat id=\"" + to_string(format.formatID) + "\" key=\"" + format.formatKey +  "\" description=\"" + format.formatDescription + "\">\n";
-    for ( vector<LogItem*>::iterator it = format.vectorItems.begin(); it != format.vectorItems.end(); it++ ) {
-      buffer += "#    <item type=\"" + LogItem::toString((*it)->type);
-      buffer += "\" key=\"" + (*it)->key + "\">" + (*it)->description + "</item>\n";
-    }
+  string line;
+  long time = 0;
 
-    buffer += "#</lineFormat>\n";
-    fprintf( outputFile , "%s", buffer.c_str());
-  }
-
-  buffer = to_string( format.formatID );
+  line = to_string( format.formatID );
 
   for ( vector<LogItem*>::iterator it = format.vectorItems.begin(); it != format.vectorItems.end(); it++ ) {
     switch ( (*it)->type ) {
     case LogItem::ItemType::INT32:
-      buffer += " " + to_string( va_arg(args, int) );
+      line += " " + to_string( va_arg(args, int) );
       break;
     case LogItem::ItemType::INT64:
-      buffer += " " + to_string( va_arg(args, long) );
+      if ( (*it)->key == "time" ) {
+        time = va_arg(args, long);
+        line += " " + to_string( time );
+      } else {
+        line += " " + to_string( va_arg(args, long) );
+      }
       break;
     case LogItem::ItemType::STRING:
-      buffer += " " + string( va_arg(args, const char*) );
+      line += " " + string( va_arg(args, const char*) );
       break;
     case LogItem::ItemType::DOUBLE:
-      buffer += " " + to_string( va_arg(args, double) );
+      line += " " + to_string( va_arg(args, double) );
       break;
     case LogItem::ItemType::BOOLEAN:
-      buffer += " " + to_string( (va_arg(args, int) != 0) );
+      line += " " + to_string( (va_arg(args, int) != 0) );
       break;
     default:
       break;
     }
   }
-  buffer += "\n";
-  fprintf( outputFile, "%s", buffer.c_str());
+  line += "\n";
+  va_end(args);
+
+  if ( sharded ) {
+    if ( currentShard.shard < 0 ) {
+      openShard( time );
+    } else if ( (shardRecords > 0 && currentShard.records >= shardRecords) || (shardDuration > 0 && time >= shardSlotEnd) ) {
+      closeShard();
+      openShard( time );
+    }
+    currentShard.lastTime = time;
+    currentShard.records++;
+  }
+
+  if ( knownFormats.find( format.formatID ) == knownFormats.end() ) {
+    knownFormats.insert( format.formatID );
+
+    string buffer = "#<lineFormat id=\"" + to_string(format.formatID) + "\" key=\"" + format.formatKey +  "\" description=\"" + format.formatDescription + "\">\n";
+    for ( vector<LogItem*>::iterator it = format.vectorItems.begin(); it != format.vectorItems.end(); it++ ) {
+      buffer += "#    <item type=\"" + LogItem::toString((*it)->type);
+      buffer += "\" key=\"" + (*it)->key + "\">" + (*it)->description + "</item>\n";
+    }
+
+    buffer += "#</lineFormat>\n";
+    write( buffer );
+  }
+
+  write( line );
 }
 
 //===========================================================================================================
@@ -390,6 +783,9 @@ OutputLineFormat LogSystem::dstReach("dr","destination reach");
 
 OutputLineFormat LogSystem::slrBroadcastReach("br","slr broadcast destination reach");
 OutputLineFormat LogSystem::hcdBroadcastReach("hr","hcd broadcast destination reach");
+OutputLineFormat LogSystem::overflowEventLog("o","packet dropped (output buffer full)");
+OutputLineFormat LogSystem::intervalBlockLog("ib","interval block (followed by one in line per node active in the interval)");
+OutputLineFormat LogSystem::intervalNodeLog("in","channel usage of a node during an interval");
 // OutputLineFormat LogSystem::channelUsage("cu","channel usage");
 
 // #StaticLogSystem
@@ -426,7 +822,20 @@ void LogSystem::initOutputStream(string _name, std::ofstream &_stream, FILE **_f
 				}
 
         string n = ScenarioParameters::getScenarioDirectory() + "/" + ScenarioParameters::getOutputBaseName() + suffix + ScenarioParameters::getDefaultExtension();
-        if (it->second.io.compare("fprintf") == 0) {
+        if (it->second.shardDuration > 0 || it->second.shardRecords > 0) {
+          if (it->second.io.compare("smartLog") != 0 && it->second.io.compare("gz") != 0) {
+            cerr << "*** ERROR *** Sharding " << _name << " requires io=\"smartLog\" or io=\"gz\"" << endl;
+            exit(EXIT_FAILURE);
+          }
+          string prefix = ScenarioParameters::getScenarioDirectory() + "/" + ScenarioParameters::getOutputBaseName() + suffix;
+          string extension = ScenarioParameters::getDefaultExtension();
+          bool compressed = it->second.io.compare("gz") == 0;
+          if (compressed) {
+            extension += ".gz";
+          }
+          cout << "  [" << it->second.io << "] redirecting " << _name << " to shards indexed in " << prefix << ".index" << endl;
+          _logOutput.createSharded(prefix, extension, compressed, it->second.shardDuration, it->second.shardRecords);
+        } else if (it->second.io.compare("fprintf") == 0) {
           *_fileC = fopen(n.c_str(),"w");
           cout << "  [fprintf] redirecting " << _name << " to " << n << endl;
         } else if (it->second.io.compare("stream") == 0) {
@@ -435,6 +844,10 @@ void LogSystem::initOutputStream(string _name, std::ofstream &_stream, FILE **_f
         } else if (it->second.io.compare("smartLog") == 0) {
           cout << "  [smartLog] redirecting " << _name << " to " << n << endl;
           _logOutput.create(n.c_str());
+        } else if (it->second.io.compare("gz") == 0) {
+          n += ".gz";
+          cout << "  [gz] redirecting " << _name << " to " << n << endl;
+          _logOutput.create(n.c_str(), true);
         } else {
           cerr << "*** ERROR *** Invalid output system " << it->second.io << endl;
           exit(EXIT_FAILURE);
@@ -486,6 +899,14 @@ void LogSystem::initLogSystem() {
   ignoredEventLog.addItem( LogItem::INT32, "pktType", "packet type" );
   ignoredEventLog.addItem(LogItem::INT32,"flow","flow id");
   ignoredEventLog.addItem(LogItem::INT32,"seq","packet sequence number");
+
+  overflowEventLog.addItem( LogItem::INT64, "time", "simulation time in fs" );
+  overflowEventLog.addItem( LogItem::INT32, "nodeID", "node ID handling the event" );
+  overflowEventLog.addItem( LogItem::INT32, "beta", "beta" );
+  overflowEventLog.addItem( LogItem::INT32, "size", "packet size in bits" );
+  overflowEventLog.addItem( LogItem::INT32, "pktType", "packet type" );
+  overflowEventLog.addItem(LogItem::INT32,"flow","flow id");
+  overflowEventLog.addItem(LogItem::INT32,"seq","packet sequence number");
   
   LogSystem::initOutputStream("RoutingInfoLog", RoutingInfoLog, &RoutingInfoLogC, RoutingInfoOuput);
 
@@ -532,6 +953,24 @@ void LogSystem::initLogSystem() {
   hcdBroadcastReach.addItem(LogItem::INT32,"SLRY","SLRY");
   hcdBroadcastReach.addItem(LogItem::INT32,"SLRZ","SLRZ");
 
+  intervalBlockLog.addItem(LogItem::INT64,"time","end of the interval in fs");
+  intervalBlockLog.addItem(LogItem::INT32,"interval","interval number");
+  intervalBlockLog.addItem(LogItem::INT32,"nodes","number of in lines of the block, i.e. of active nodes");
+
+  intervalNodeLog.addItem(LogItem::INT64,"time","end of the interval in fs");
+  intervalNodeLog.addItem(LogItem::INT32,"nodeID","node ID");
+  intervalNodeLog.addItem(LogItem::INT32,"totalPkts","packets received");
+  intervalNodeLog.addItem(LogItem::INT32,"totalBits","bits received");
+  intervalNodeLog.addItem(LogItem::DOUBLE,"usage","channel usage in percent");
+  intervalNodeLog.addItem(LogItem::INT32,"okPkts","packets correctly received");
+  intervalNodeLog.addItem(LogItem::INT32,"okBits","bits correctly received");
+  intervalNodeLog.addItem(LogItem::INT32,"cPkts","packets collisionned");
+  intervalNodeLog.addItem(LogItem::INT32,"cBits","bits collisionned");
+  intervalNodeLog.addItem(LogItem::INT32,"iPkts","packets ignored");
+  intervalNodeLog.addItem(LogItem::INT32,"iBits","bits ignored");
+
+  initFilters();
+
   //     channelUsage.addItem(LogItem::INT64,"time","date in fs");
   //     channelUsage.addItem(LogItem::INT32,"pktType","packet Type");
   //     channelUsage.addItem(LogItem::INT32,"flow","flow id");
@@ -541,3 +980,68 @@ void LogSystem::initLogSystem() {
 
   // #LogSystem
 }
+
+void LogSystem::closeLogSystem() {
+  EventsLogOutput.close();
+  NodeInfoLogOutput.close();
+  EstimationLogOutput.close();
+  SummarizeLogOutput.close();
+  RoutingInfoOuput.close();
+}
+
+void LogSystem::initFilters() {
+  OutputLineFormat *formats[] = { &receptionEventLog, &sentEventLog, &collisionEventLog, &ignoredEventLog,
+    &overflowEventLog, &routingRCV, &routingSND, &memoryTrace, &dstReach, &slrBroadcastReach, &hcdBroadcastReach,
+    &intervalBlockLog, &intervalNodeLog };
+  // disabled without logAtRoutingLevel
+  OutputLineFormat *routingFormats[] = { &routingRCV, &routingSND, &memoryTrace, &dstReach,
+    &slrBroadcastReach, &hcdBroadcastReach };
+
+  vector<logFilterInfo_t> filters = ScenarioParameters::getLogFilters();
+  for ( auto &info : filters ) {
+    OutputLineFormat *format = nullptr;
+    for ( auto f : formats ) {
+      if ( f->formatKey == info.format ) {
+        format = f;
+      }
+    }
+    if ( format == nullptr ) {
+      cerr << "*** ERROR *** Unknown format \"" << info.format << "\" in <filter> element" << endl;
+      exit(EXIT_FAILURE);
+    }
+    if ( format->filter != nullptr ) {
+      cerr << "*** ERROR *** Several <filter> elements for format \"" << info.format << "\"" << endl;
+      exit(EXIT_FAILURE);
+    }
+
+    LogFilter *filter = new LogFilter();
+    filter->enabled = info.enabled;
+    filter->nodeRanges = LogFilter::parseRanges(info.nodes);
+    filter->flowRanges = LogFilter::parseRanges(info.flows);
+    filter->from = info.from;
+    filter->to = info.to;
+    filter->sample = info.sample < 1 ? 1 : info.sample;
+    format->filter = filter;
+    cout << "  filtering " << format->formatKey << " lines" << endl;
+  }
+
+  if ( !ScenarioParameters::getLogAtRoutingLevel() ) {
+    for ( auto f : routingFormats ) {
+      if ( f->filter == nullptr ) {
+        f->filter = new LogFilter();
+      }
+      f->filter->enabled = false;
+    }
+  }
+
+  for ( auto f : formats ) {
+    if ( f->filter == nullptr ) {
+      continue;
+    }
+    for ( size_t i = 0; i < f->vectorItems.size(); i++ ) {
+      if ( f->vectorItems[i]->key == "time" ) f->filter->timeIndex = i;
+      if ( f->vectorItems[i]->key == "nodeID" ) f->filter->nodeIndex = i;
+      if ( f->vectorItems[i]->key == "flow" ) f->filter->flowIndex = i;
+    }
+  }
+}
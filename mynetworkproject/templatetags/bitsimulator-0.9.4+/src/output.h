@@ -25,8 +25,14 @@
 #include <map>
 #include <set>
 #include <utility>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
 
 #include <tinyxml2.h>
+#include <zlib.h>
 
 using namespace std;
 
@@ -34,8 +40,37 @@ typedef struct {
   string output;
   string suffix;
   string io;
+  long shardDuration;  // fs, 0 for no time sharding
+  int shardRecords;    // 0 for no record count sharding
 } logSystemInfo_t;
 
+// one line of the index of a sharded log
+typedef struct {
+  int shard;
+  long firstTime;
+  long lastTime;
+  long offset;   // uncompressed offset of the shard in the whole log
+  long records;
+  string fileName;
+} logShardInfo_t;
+
+// a place in a log being read, to come back to with LogOutput::seek()
+typedef struct {
+  size_t shard;  // index in the shard list, 0 for a single file
+  long offset;   // uncompressed offset in that file
+} logPosition_t;
+
+// raw attributes of a <filter> element of <logSystem>
+typedef struct {
+  string format;
+  bool enabled;
+  string nodes;
+  string flows;
+  long from;
+  long to;
+  int sample;
+} logFilterInfo_t;
+
 //==============================================================================
 //
 //          LogItem  (class)
@@ -98,6 +133,50 @@ public:
 
 
 
+//==============================================================================
+//
+//          LogFilter  (class)
+//
+//==============================================================================
+
+// Selection of the lines of one OutputLineFormat, declared with
+// <filter format="rr" nodes="0-99,150" flows="7" from_ns="0" to_ns="1000" sample="10"/>
+// in <logSystem>.  It is evaluated on the raw arguments of LogOutput::log(),
+// before any formatting.
+
+class LogFilter {
+public:
+  bool enabled;
+  vector<pair<int,int>> nodeRanges;  // sorted, empty for all nodes
+  vector<pair<int,int>> flowRanges;  // sorted, empty for all flows
+  long from;
+  long to;                           // -1 for no limit
+  int sample;                        // keep 1 line out of sample
+  long sampleCounter;
+
+  int timeIndex;   // position of the items in the format, -1 if absent
+  int nodeIndex;
+  int flowIndex;
+
+  LogFilter() {
+    enabled = true;
+    from = 0;
+    to = -1;
+    sample = 1;
+    sampleCounter = 0;
+    timeIndex = nodeIndex = flowIndex = -1;
+  }
+
+  static vector<pair<int,int>> parseRanges(string _ranges);
+  static bool inRanges(const vector<pair<int,int>> &_ranges, long _value);
+
+  template<typename T> static long value(T _value) { return (long)_value; }
+  static long value(const char *) { return 0; }
+
+  bool accept(const long *_values);
+};
+
+
 //==============================================================================
 //
 //          OutputLineFormat  (class)
@@ -115,7 +194,7 @@ public:
 
 class OutputLineFormat {
 private:
-  static int nextFormatID;
+  static atomic<int> nextFormatID;
 public:
 
   int formatID;
@@ -124,9 +203,11 @@ public:
   string formatDescription;
   vector<LogItem*> vectorItems;
   map<string, LogItem*> mapItemsByKey;
+  LogFilter *filter;  // nullptr: every line is logged
 
   OutputLineFormat( string pFormatKey, string pFormatDescription ) {
     formatID = OutputLineFormat::nextFormatID++;
+    filter = nullptr;
 
     formatKey = pFormatKey;
     formatDescription = pFormatDescription;
@@ -138,6 +219,7 @@ public:
     }
 
     formatID = pId;
+    filter = nullptr;
     formatKey = pFormatKey;
     formatDescription = pFormatDescription;
   }
@@ -173,11 +255,52 @@ private:
   map<int,OutputLineFormat*> mapKnownFormats;
 
   char *buffer;
-  char *xmlBuffer;
+  size_t bufferSize;
+  string xmlText;  // format declaration being read
   tinyxml2::XMLDocument xmlDoc;
   tinyxml2::XMLElement *XMLRootNode;
 
   OutputLineFormat *currentFormat;
+  gzFile inputFile;  // reading, plain or gzip
+
+  // gzip output: lines are gathered in blocks which are compressed by a
+  // dedicated thread, so that zlib does not run on the simulation thread
+  bool compressed;
+  gzFile compressedFile;
+  string pendingBlock;
+  deque<string> fullBlocks;
+  bool closing;
+  bool compressorFailed;  // set by the compressor thread, reported by the simulation thread
+  mutex compressorMutex;
+  condition_variable compressorCondition;
+  thread compressorThread;
+
+  // sharded output: a new file every shardDuration fs or shardRecords lines,
+  // each with its own format header, listed in <prefix>.index
+  bool sharded;
+  string shardPrefix;
+  string shardExtension;
+  long shardDuration;
+  long shardRecords;
+  FILE *indexFile;
+  logShardInfo_t currentShard;
+  long shardSlotEnd;
+  long writtenBytes;
+
+  // sharded input
+  vector<logShardInfo_t> shards;
+  size_t shardIndex;
+  string shardDirectory;
+
+  void compressorLoop();
+  void flushBlock();
+  void checkCompressor();
+  void write( const string &_text );
+  void openShard( long _time );
+  void closeShard();
+  void closeFile();
+  bool openInputShard( size_t _index );
+  size_t readLine();
 
 public:
   enum class LineType {
@@ -186,16 +309,28 @@ public:
     COMMENT
   };
 
+private:
+  LineType parseBuffer( size_t linelen );
+
+public:
   FILE* outputFile;
 
   LogOutput();
   ~LogOutput();
 
-  void create( string fileName );
+  void create( string fileName, bool _compressed = false );
+  void createSharded( string _prefix, string _extension, bool _compressed, long _duration, long _records );
   void open( string fileName );
   void close();
+  bool isCreated() const { return outputFile != NULL || compressed || sharded; }
+  void seek( long _time );
+  logPosition_t tell();
+  void seek( const logPosition_t &_position );
+
+  static vector<logShardInfo_t> readIndex( string _indexFileName );
 
   LineType readNextLine();
+  LineType parseLine( const char *_line, size_t _length );
   string currentLineFormatKey();
 
   int getLogItemIntValue( string pKey );
@@ -205,7 +340,18 @@ public:
   bool getLogItemBooleanValue( string pKey );
 
   bool hasItem( string pKey );
-  void log( OutputLineFormat &format...);
+  void logLine( OutputLineFormat &format...);
+
+  template<typename... Args>
+  void log( OutputLineFormat &format, Args... args ) {
+    if ( format.filter != nullptr ) {
+      long values[] = { LogFilter::value(args)... };
+      if ( !format.filter->accept(values) ) {
+        return;
+      }
+    }
+    logLine( format, args... );
+  }
 };
 
 
@@ -241,6 +387,7 @@ public:
   static OutputLineFormat sentEventLog;
   static OutputLineFormat collisionEventLog;
   static OutputLineFormat ignoredEventLog;
+  static OutputLineFormat overflowEventLog;
 
   static OutputLineFormat routingRCV;
   static OutputLineFormat routingSND;
@@ -250,6 +397,9 @@ public:
   static OutputLineFormat slrBroadcastReach;
 
   static OutputLineFormat hcdBroadcastReach;
+
+  static OutputLineFormat intervalBlockLog;
+  static OutputLineFormat intervalNodeLog;
   //     static OutputLineFormat channelUsage;
 
   // #LogSystem NEW OPTIONS
@@ -258,7 +408,9 @@ public:
   }
 
   static void initOutputStream(string _name, std::ofstream &_stream, FILE **_fileC, LogOutput &_logOutput);
+  static void initFilters();
   static void initLogSystem();
+  static void closeLogSystem();
 };
 
 #endif /* OUTPUT_H_ */
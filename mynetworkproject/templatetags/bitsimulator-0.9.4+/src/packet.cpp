@@ -22,8 +22,9 @@
 #include "utils.h"
 #include "packet.h"
 #include "scheduler.h"
+#include "world.h"
 
-mt19937 BinaryPayload::payloadRNG;
+int BinaryPayload::payloadRNGSeed = 0;
 
 //===========================================================================================================
 //
@@ -43,6 +44,11 @@ Packet::Packet(PacketType _type, int _size, int _srcId, int _dstId, int _port, i
 
 
 Packet::Packet(PacketType _type, int _size, int _srcId, int _dstId, int _port, int _flowId, int _flowSequenceNumber,int _anchorID, int _anchorDist) :
+  Packet (_type, _size, _srcId, _dstId, _port, _flowId, _flowSequenceNumber, _anchorID, _anchorDist, nullptr)
+{
+}
+
+Packet::Packet(PacketType _type, int _size, int _srcId, int _dstId, int _port, int _flowId, int _flowSequenceNumber,int _anchorID, int _anchorDist, PayloadPtr _payload) :
   type(_type), size(_size), srcId(_srcId), dstId(_dstId), port(_port), flowId(_flowId), flowSequenceNumber(_flowSequenceNumber) {
 
   assert(size >= 1);
@@ -53,7 +59,10 @@ Packet::Packet(PacketType _type, int _size, int _srcId, int _dstId, int _port, i
   retransmission = 0;
   collisioned = false;
   parasite = false;
-  payload = PayloadPtr(new BinaryPayload(_size));
+  if (_payload)
+    payload = _payload;
+  else
+    payload = PayloadPtr(new BinaryPayload(_size, _srcId, World::getNode(_srcId)->getPayloadDraws()));
 
   anchorID = _anchorID;
   anchorDist = _anchorDist;
@@ -82,7 +91,7 @@ Packet::Packet(PacketType _type, int _size, int _srcId, int _dstId, int _port, i
 }
 
 PacketPtr Packet::clone() {
-  PacketPtr clone = std::make_shared<Packet>(type, size, srcId, dstId, port, flowId, flowSequenceNumber);
+  PacketPtr clone = std::make_shared<Packet>(type, size, srcId, dstId, port, flowId, flowSequenceNumber, anchorID, anchorDist, payload);
 
 
   clone->beta = beta;
@@ -91,11 +100,6 @@ PacketPtr Packet::clone() {
   clone->transmitterId = transmitterId;
   clone->retransmission = retransmission;
 
-  clone->payload = payload;
-
-  clone->anchorID = anchorID;
-  clone->anchorDist = anchorDist;
-
   clone->src_SLRX = src_SLRX;
   clone->src_SLRY = src_SLRY;
   clone->src_SLRZ = src_SLRZ;
@@ -21,6 +21,8 @@
 #define PACKET_H_
 
 #include <unordered_set>
+#include <vector>
+#include "counter-rng.h"
 
 // why Class and not just enum?
 enum class PacketType {
@@ -49,15 +51,18 @@ class BinaryPayload {
 protected:
   uint32_t *data;
   uint32_t marsagliaState;;
-  static mt19937 payloadRNG;
+  static int payloadRNGSeed;
 
 public:
-  BinaryPayload(int _size) {
+  // the payloads of a node are drawn from its own stream, _draws being the
+  // counter the source node keeps for it
+  BinaryPayload(int _size, int _srcId, uint64_t &_draws) {
     int intCount = _size / 32;
     int reminder = _size % 32;
     if (reminder > 0) intCount++;
 
-    marsagliaState = payloadRNG();
+    CounterRNG payloadRNG(payloadRNGSeed, _srcId, RNGPurpose::PAYLOAD, _draws);
+    marsagliaState = (uint32_t)payloadRNG();
 
     data = new uint32_t[intCount];
     for (int i=0; i<intCount; i++) {
@@ -72,7 +77,7 @@ public:
   }
 
   static void initialize(int _seed) {
-    payloadRNG = mt19937(_seed);
+    payloadRNGSeed = _seed;
   }
 
   bool getVal(int _i) {
@@ -156,6 +161,8 @@ public:
 
   Packet(PacketType _type, int _size, int _srcId, int _dstId, int _port, int _flowId, int _flowSequenceNumber);
   Packet(PacketType _type, int _size, int _srcId, int _dstId, int _port, int _flowId, int _flowSequenceNumber, int _achorID, int _achorDist);
+  // shares _payload rather than drawing a new one, for clones
+  Packet(PacketType _type, int _size, int _srcId, int _dstId, int _port, int _flowId, int _flowSequenceNumber, int _achorID, int _achorDist, PayloadPtr _payload);
 
 
   virtual ~Packet() { }
@@ -173,11 +180,6 @@ public:
         exit(EXIT_FAILURE);
     }
 
-    if ( _range != ScenarioParameters::getCommunicationRange() && !ScenarioParameters::getDoNotUseNeighboursList() ) {
-        cout << "*** ERROR, You cannot change the communication range at runtime if you are using the neighbours list" << endl;
-        exit(EXIT_FAILURE);
-    }
-
     communicationRange = _range;
   }
 };
@@ -0,0 +1,100 @@
+/*
+ * Copyright (C) 2017-2019 Dominique Dhoutaut, Thierry Arrabal, Eugen Dedu.
+ *
+ * This file is part of BitSimulator.
+ *
+ * BitSimulator is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * BitSimulator is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with BitSimulator.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef RING_BUFFER_H_
+#define RING_BUFFER_H_
+
+#include <cstddef>
+#include <vector>
+using namespace std;
+
+//===========================================================================================================
+//
+//          RingBuffer  (class)
+//
+//===========================================================================================================
+
+// FIFO stored in a circular array.  With a capacity, the array is allocated
+// once and push() is refused when it is full, the caller choosing what to
+// drop; with a capacity of 0 the array doubles when needed, like a queue.
+// Removed slots are reset to T(), so that no packet is kept alive by them.
+
+template<typename T>
+class RingBuffer {
+private:
+  vector<T> slots;
+  size_t first;  // slot of the front element
+  size_t count;
+  size_t capacity;  // 0 for unbounded
+
+  size_t slot(size_t _i) const {
+    size_t s = first + _i;
+    return s < slots.size() ? s : s - slots.size();
+  }
+
+  void grow() {
+    vector<T> larger(slots.empty() ? 4 : 2 * slots.size());
+    for (size_t i = 0; i < count; i++)
+      larger[i] = slots[slot(i)];
+    slots.swap(larger);
+    first = 0;
+  }
+
+public:
+  explicit RingBuffer(size_t _capacity = 0) : first(0), count(0), capacity(0) { setCapacity(_capacity); }
+
+  // only while empty
+  void setCapacity(size_t _capacity) {
+    capacity = _capacity;
+    slots.assign(_capacity, T());
+    first = 0;
+  }
+
+  size_t size() const { return count; }
+  bool empty() const { return count == 0; }
+  bool full() const { return capacity != 0 && count == capacity; }
+
+  // false, and nothing done, when full
+  bool push(const T &_element) {
+    if (full()) return false;
+    if (count == slots.size()) grow();
+    slots[slot(count)] = _element;
+    count++;
+    return true;
+  }
+
+  T &front() { return slots[first]; }
+  T &operator[](size_t _i) { return slots[slot(_i)]; }
+
+  void pop() {
+    slots[first] = T();
+    first = slot(1);
+    count--;
+  }
+
+  // removes the _i-th element, the following ones keeping their order
+  void erase(size_t _i) {
+    for (size_t i = _i; i + 1 < count; i++)
+      slots[slot(i)] = slots[slot(i + 1)];
+    slots[slot(count - 1)] = T();
+    count--;
+  }
+};
+
+#endif /* RING_BUFFER_H_ */
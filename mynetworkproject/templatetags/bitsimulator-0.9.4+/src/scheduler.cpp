@@ -41,7 +41,10 @@ Scheduler::Scheduler() {
   //         maximumDate = 5*100000;
   eventsMapSize = 0;
   largestEventsMapSize = 0;
+  largestTimersSize = 0;
   prematureEnd = false;
+  nextSequence = 0;
+  currentEvent = nullptr;
 }
 
 
@@ -63,14 +66,23 @@ void Scheduler::run() {
   multimap<simulationTime_t, EventPtr>::iterator first;
   EventPtr pev;
 
-  while ( (!eventsMap.empty() ) && currentDate < maximumDate && !prematureEnd) {
+  while ( (!eventsMap.empty() || !timers.empty() ) && currentDate < maximumDate && !prematureEnd) {
     first=eventsMap.begin();
-    pev = (*first).second;
-    currentDate = pev->date;
-    //                 cout << currentDate << " : " << pev->getEventName() << endl;
-    pev->consume();
-    eventsMap.erase(first);
-    eventsMapSize--;
+    if ( !timers.empty() && ( eventsMap.empty() || timers.top().date < first->first
+        || ( timers.top().date == first->first && timers.top().sequence < first->second->sequence ) ) ) {
+      pev = timers.pop();
+      currentDate = pev->date;
+      currentEvent = pev.get();
+      pev->consume();
+    } else {
+      pev = (*first).second;
+      currentDate = pev->date;
+      //                 cout << currentDate << " : " << pev->getEventName() << endl;
+      currentEvent = pev.get();
+      pev->consume();
+      eventsMap.erase(first);
+      eventsMapSize--;
+    }
     if (processedEventCounter % 100000 == 0) {
       endPeriod = std::chrono::system_clock::now();
       elapsed_milliseconds = (double)std::chrono::duration_cast<std::chrono::milliseconds>(endPeriod-startPeriod).count();
@@ -80,7 +92,7 @@ void Scheduler::run() {
     processedEventCounter++;
   }
 
-  if (eventsMap.empty()) cerr << "all events processed (fin at " << currentDate << ")" << endl;
+  if (eventsMap.empty() && timers.empty()) cerr << "all events processed (fin at " << currentDate << ")" << endl;
   cout << "*** Simulation end ***" << endl;
 
   end = std::chrono::system_clock::now();
@@ -94,6 +106,7 @@ void Scheduler::run() {
     cerr << "*** " << (double)processedEventCounter / (elapsed_milliseconds/1000.0) << " events/s" << endl;
   }
   cerr << "*** maximum events list depth " << largestEventsMapSize << endl;
+  cerr << "*** maximum timers depth " << largestTimersSize << endl;
 }
 
 //void Scheduler::run() {
@@ -135,32 +148,40 @@ void Scheduler::run() {
 // cerr << "*** maximum events list depth " << largestEventsMapSize << endl;
 //}
 
-void Scheduler::schedule(Event *_ev) {
-  assert(_ev != NULL);
-  //stringstream info;
-
-  EventPtr pev(_ev);
-
-  //info << "Schedule a " << pev->getEventName() << " (" << _ev->id << ")";
-  //cout << info.str() << endl;
-
+bool Scheduler::checkDate(EventPtr pev) {
   if (pev->date < Scheduler::currentDate) {
     cerr << "ERROR: An event cannot be scheduled in the past!\n";
     cerr << "current time: " << Scheduler::currentDate << endl;
     cerr << "ev->eventDate: " << pev->date << endl;
     cerr << "ev->getEventName(): " << pev->getEventName() << endl;
-    return;
+    return false;
   }
 
   if (pev->date > maximumDate) {
     cerr << "WARNING: An event should not be scheduled beyond the end of simulation date!\n";
     cerr << "pev->date: " << pev->date << endl;
     cerr << "maximumDate: " << maximumDate << endl;
-    return;
+    return false;
+  }
+  return true;
+}
+
+EventPtr Scheduler::schedule(Event *_ev) {
+  assert(_ev != NULL);
+  //stringstream info;
+
+  EventPtr pev(_ev);
+
+  //info << "Schedule a " << pev->getEventName() << " (" << _ev->id << ")";
+  //cout << info.str() << endl;
+
+  if (!checkDate(pev)) {
+    return nullptr;
   }
 
   //cout<< " Event insertion: " << pev->getEventName() << " at date " << pev->date << endl;
 
+  pev->sequence = nextSequence++;
   eventsMap.insert(pair<long, EventPtr>(pev->date,pev));
 
   // auto it = eventsMap.lower_bound(pev->date);
@@ -182,4 +203,31 @@ void Scheduler::schedule(Event *_ev) {
 
   eventsMapSize++;
   if (largestEventsMapSize < eventsMapSize) largestEventsMapSize = eventsMapSize;
+  return pev;
+}
+
+void Scheduler::cancel(const EventPtr &_event) {
+  if (_event == nullptr || _event.get() == currentEvent)
+    return;
+  auto range = eventsMap.equal_range(_event->date);
+  for (auto it = range.first; it != range.second; it++) {
+    if (it->second == _event) {
+      eventsMap.erase(it);
+      eventsMapSize--;
+      return;
+    }
+  }
+}
+
+void Scheduler::scheduleTimer(Event *_ev) {
+  assert(_ev != NULL);
+
+  EventPtr pev(_ev);
+  if (!checkDate(pev)) {
+    return;
+  }
+
+  pev->sequence = nextSequence++;
+  timers.insert(pev, pev->sequence);
+  if (largestTimersSize < timers.size()) largestTimersSize = timers.size();
 }
@@ -25,6 +25,7 @@
 #include <map>
 #include "utils.h"
 #include "events.h"
+#include "timer-wheel.h"
 using namespace std;
 
 #define TIME_PICO   (simulationTime_t)1000
@@ -50,8 +51,15 @@ private:
   static simulationTime_t currentDate;
   simulationTime_t maximumDate;
   int eventsMapSize, largestEventsMapSize;
+  size_t largestTimersSize;
   bool prematureEnd;
 
+  TimerWheel timers;  // periodic and coarse-grained events
+  long nextSequence;
+  Event *currentEvent;  // being processed
+
+  bool checkDate(EventPtr _pev);
+
 public:
   ~Scheduler();
   static Scheduler &getScheduler() {
@@ -59,7 +67,17 @@ public:
     return(myScheduler);
   }
 
-  void schedule(Event *_ev);
+  // returns the scheduled event, or nullptr if it was refused
+  EventPtr schedule(Event *_ev);
+  // removes an event given to schedule() which is not processed yet; does
+  // nothing for an event already processed or being processed
+  void cancel(const EventPtr &_event);
+  // for periodic or coarse-grained events (packet generation, logging...),
+  // processed in the same order as if they had been given to schedule()
+  void scheduleTimer(Event *_ev);
+  // true when neither an event nor a timer is waiting, the one being
+  // processed excepted
+  bool idle() const { return eventsMap.empty() && timers.empty(); }
   static simulationTime_t now() { return(myScheduler.currentDate); }
   static void initScheduler() { myScheduler = Scheduler(); }
   static void endSimulation() { myScheduler.prematureEnd = true; }
@@ -0,0 +1,144 @@
+/*
+ * Copyright (C) 2017-2019 Dominique Dhoutaut, Thierry Arrabal, Eugen Dedu.
+ *
+ * This file is part of BitSimulator.
+ *
+ * BitSimulator is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * BitSimulator is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with BitSimulator.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <queue>
+#include "spatial-index.h"
+#include "node.h"
+
+using namespace std;
+
+//===========================================================================================================
+//
+//          SpatialIndex  (class)
+//
+//===========================================================================================================
+
+void SpatialIndex::build(const vector<Node*> &_nodes, distance_t _cellSize) {
+  entries.clear();
+  cellStart.clear();
+  builtAt.clear();
+  drift = 0;
+  xSize = ySize = zSize = 0;
+  if (_nodes.empty()) return;
+
+  distance_t maxX, maxY, maxZ;
+  minX = maxX = _nodes[0]->getXPos();
+  minY = maxY = _nodes[0]->getYPos();
+  minZ = maxZ = _nodes[0]->getZPos();
+  for (Node *node : _nodes) {
+    minX = min(minX, node->getXPos()); maxX = max(maxX, node->getXPos());
+    minY = min(minY, node->getYPos()); maxY = max(maxY, node->getYPos());
+    minZ = min(minZ, node->getZPos()); maxZ = max(maxZ, node->getZPos());
+  }
+
+  // no more than a few cells per node, whatever the range and world size
+  cellSize = max(_cellSize, 1L);
+  long long maxCells = 4 * (long long)_nodes.size() + 64;
+  while (true) {
+    xSize = (int)((maxX - minX) / cellSize) + 1;
+    ySize = (int)((maxY - minY) / cellSize) + 1;
+    zSize = (int)((maxZ - minZ) / cellSize) + 1;
+    if ((long long)xSize * ySize * zSize <= maxCells) break;
+    cellSize *= 2;
+  }
+
+  // counting sort of the nodes by cell
+  vector<int> cellOfNode(_nodes.size());
+  cellStart.assign((size_t)xSize * ySize * zSize + 1, 0);
+  for (size_t i = 0; i < _nodes.size(); i++) {
+    Node *node = _nodes[i];
+    cellOfNode[i] = cellIndex((int)cellOf(node->getXPos(), minX), (int)cellOf(node->getYPos(), minY),
+                              (int)cellOf(node->getZPos(), minZ));
+    cellStart[cellOfNode[i] + 1]++;
+  }
+  for (size_t c = 1; c < cellStart.size(); c++)
+    cellStart[c] += cellStart[c - 1];
+
+  entries.resize(_nodes.size());
+  vector<int> next(cellStart.begin(), cellStart.end() - 1);
+  for (size_t i = 0; i < _nodes.size(); i++) {
+    Node *node = _nodes[i];
+    entries[next[cellOfNode[i]]++] = { node->getXPos(), node->getYPos(), node->getZPos(), node };
+  }
+}
+
+distance_t SpatialIndex::update() {
+  if (builtAt.empty()) {
+    for (const spatialEntry_t &e : entries)
+      builtAt.push_back({ e.x, e.y, e.z });
+  }
+  double maxSquared = 0;
+  for (size_t i = 0; i < entries.size(); i++) {
+    spatialEntry_t &e = entries[i];
+    e.x = e.node->getXPos();
+    e.y = e.node->getYPos();
+    e.z = e.node->getZPos();
+    double dx = e.x - builtAt[i].x, dy = e.y - builtAt[i].y, dz = e.z - builtAt[i].z;
+    maxSquared = max(maxSquared, dx*dx + dy*dy + dz*dz);
+  }
+  drift = (distance_t)ceil(sqrt(maxSquared));
+  return drift;
+}
+
+// Scans the cells by growing cubic shells around the cell of the point.  A
+// node outside the shells already scanned is at least radius * cellSize - drift
+// away, so the search stops when the _k best found are all closer than that.
+void SpatialIndex::nearest(distance_t _x, distance_t _y, distance_t _z, int _k,
+                           vector<spatialHit_t> &_result, const Node *_exclude) const {
+  _result.clear();
+  if (_k <= 0 || entries.empty()) return;
+
+  // ((squared distance, node id), entry), the id being unique the entries are never compared
+  typedef pair<pair<double, int>, const spatialEntry_t*> candidate_t;
+  priority_queue<candidate_t> best;  // worst on top
+  auto consider = [&](const spatialEntry_t &_e) {
+    if (_e.node == _exclude) return;
+    candidate_t c(make_pair(squaredDistance(_e, _x, _y, _z), _e.node->getId()), &_e);
+    if ((int)best.size() < _k) best.push(c);
+    else if (c < best.top()) { best.pop(); best.push(c); }
+  };
+
+  long cx = cellOf(_x, minX), cy = cellOf(_y, minY), cz = cellOf(_z, minZ);
+  // shells needed to cover the whole grid from the cell of the point
+  long maxRadius = max(max(max(cx, xSize - 1 - cx), max(cy, ySize - 1 - cy)), max(cz, zSize - 1 - cz));
+
+  for (long r = 0; r <= maxRadius; r++) {
+    for (long x = cx - r; x <= cx + r; x++) {
+      if (x < 0 || x >= xSize) continue;
+      for (long y = cy - r; y <= cy + r; y++) {
+        if (y < 0 || y >= ySize) continue;
+        bool onShell = (x == cx - r || x == cx + r || y == cy - r || y == cy + r);
+        for (long z = cz - r; z <= cz + r; z += (onShell ? 1 : max(2 * r, 1L))) {
+          if (z < 0 || z >= zSize) continue;
+          int c = cellIndex((int)x, (int)y, (int)z);
+          for (int i = cellStart[c]; i < cellStart[c + 1]; i++)
+            consider(entries[i]);
+        }
+      }
+    }
+    double reach = max((double)r * cellSize - drift, 0.0);
+    if ((int)best.size() == _k && best.top().first.first <= reach * reach) break;
+  }
+
+  _result.resize(best.size());
+  for (int i = (int)best.size() - 1; i >= 0; i--) {
+    _result[i] = { (distance_t)sqrt(best.top().first.first), best.top().second->node };
+    best.pop();
+  }
+}
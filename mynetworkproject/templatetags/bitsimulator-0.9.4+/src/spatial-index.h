@@ -0,0 +1,188 @@
+/*
+ * Copyright (C) 2017-2019 Dominique Dhoutaut, Thierry Arrabal, Eugen Dedu.
+ *
+ * This file is part of BitSimulator.
+ *
+ * BitSimulator is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * BitSimulator is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with BitSimulator.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef SPATIAL_INDEX_H_
+#define SPATIAL_INDEX_H_
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+#include "utils.h"
+using namespace std;
+
+class Node;
+
+typedef struct {
+  distance_t x, y, z;
+} spatialPoint_t;
+
+typedef struct {
+  distance_t x, y, z;
+  Node *node;
+} spatialEntry_t;
+
+typedef struct {
+  distance_t distance;
+  Node *node;
+} spatialHit_t;
+
+//===========================================================================================================
+//
+//          SpatialIndex  (class)
+//
+//===========================================================================================================
+
+// Uniform grid over the bounding box of the nodes, stored flat: the entries
+// are sorted by cell and cellStart[c] is the first entry of cell c.  Each
+// entry carries a copy of the position, so a query only reads contiguous
+// memory.  Distances are computed and truncated like Node::distance.
+//
+// With mobile nodes, update() refreshes the positions without moving the
+// entries between cells: the queries then widen their search by the largest
+// distance covered by a node since build(), which is called again when this
+// drift becomes too large.
+//
+// The queries take their visitor as a template parameter so that a lambda
+// is inlined in the scanning loop:
+//   radius:  visit(Node*, distance_t) for each node at distance <= radius
+//   box:     visit(Node*) for each node inside the box, bounds included
+//   batch:   visit(int center, Node*, distance_t), the centers being grouped
+//            by cell so that the cells around a group are scanned once
+
+class SpatialIndex {
+private:
+  distance_t cellSize;
+  distance_t minX, minY, minZ;
+  int xSize, ySize, zSize;
+  vector<int> cellStart;  // xSize*ySize*zSize + 1 values
+  vector<spatialEntry_t> entries;
+  vector<spatialPoint_t> builtAt;  // position of each entry at build(), once update() was called
+  distance_t drift;
+
+  // cell coordinate of _v on an axis, not clamped
+  long cellOf(distance_t _v, distance_t _min) const {
+    return (long)floor((double)(_v - _min) / cellSize);
+  }
+  int cellIndex(int _x, int _y, int _z) const { return (_x * ySize + _y) * zSize + _z; }
+
+  static double squaredDistance(const spatialEntry_t &_e, distance_t _x, distance_t _y, distance_t _z) {
+    double dx = _e.x - _x, dy = _e.y - _y, dz = _e.z - _z;
+    return dx*dx + dy*dy + dz*dz;
+  }
+
+  // every entry of the cells overlapping the box
+  template<typename Visitor>
+  void forEachCandidate(distance_t _minX, distance_t _minY, distance_t _minZ,
+                        distance_t _maxX, distance_t _maxY, distance_t _maxZ, Visitor &&_visit) const {
+    if (entries.empty()) return;
+    _minX -= drift; _minY -= drift; _minZ -= drift;
+    _maxX += drift; _maxY += drift; _maxZ += drift;
+    int x0 = (int)max(cellOf(_minX, minX), 0L), x1 = (int)min(cellOf(_maxX, minX), (long)xSize - 1);
+    int y0 = (int)max(cellOf(_minY, minY), 0L), y1 = (int)min(cellOf(_maxY, minY), (long)ySize - 1);
+    int z0 = (int)max(cellOf(_minZ, minZ), 0L), z1 = (int)min(cellOf(_maxZ, minZ), (long)zSize - 1);
+    // a box outside the grid, or empty, has no cell
+    if (x0 > x1 || y0 > y1 || z0 > z1) return;
+    for (int x = x0; x <= x1; x++)
+      for (int y = y0; y <= y1; y++) {
+        // the cells along z are contiguous
+        const spatialEntry_t *it = entries.data() + cellStart[cellIndex(x, y, z0)];
+        const spatialEntry_t *end = entries.data() + cellStart[cellIndex(x, y, z1) + 1];
+        for ( ; it < end; it++)
+          _visit(*it);
+      }
+  }
+
+public:
+  SpatialIndex() : cellSize(1), minX(0), minY(0), minZ(0), xSize(0), ySize(0), zSize(0), drift(0) {}
+
+  void build(const vector<Node*> &_nodes, distance_t _cellSize);
+  // reads the current positions of the nodes, returns the drift
+  distance_t update();
+  size_t size() const { return entries.size(); }
+
+  // the _k nodes closest to the point, closest first, ties broken by id
+  void nearest(distance_t _x, distance_t _y, distance_t _z, int _k,
+               vector<spatialHit_t> &_result, const Node *_exclude = nullptr) const;
+
+  template<typename Visitor>
+  void forEachInRadius(distance_t _x, distance_t _y, distance_t _z, distance_t _radius, Visitor &&_visit) const {
+    // the truncated distance is <= radius iff the real one is < radius + 1
+    double limit = ((double)_radius + 1) * ((double)_radius + 1);
+    forEachCandidate(_x - _radius, _y - _radius, _z - _radius, _x + _radius, _y + _radius, _z + _radius,
+      [&](const spatialEntry_t &_e) {
+        double d2 = squaredDistance(_e, _x, _y, _z);
+        if (d2 < limit) {
+          distance_t d = (distance_t)sqrt(d2);
+          if (d <= _radius) _visit(_e.node, d);
+        }
+      });
+  }
+
+  template<typename Visitor>
+  void forEachInBox(distance_t _minX, distance_t _minY, distance_t _minZ,
+                    distance_t _maxX, distance_t _maxY, distance_t _maxZ, Visitor &&_visit) const {
+    forEachCandidate(_minX, _minY, _minZ, _maxX, _maxY, _maxZ,
+      [&](const spatialEntry_t &_e) {
+        if (_e.x >= _minX && _e.x <= _maxX && _e.y >= _minY && _e.y <= _maxY && _e.z >= _minZ && _e.z <= _maxZ)
+          _visit(_e.node);
+      });
+  }
+
+  template<typename Visitor>
+  void forEachInRadius(const vector<spatialPoint_t> &_centers, distance_t _radius, Visitor &&_visit) const {
+    vector<pair<long, int>> order(_centers.size());  // (cell, center)
+    for (size_t i = 0; i < _centers.size(); i++) {
+      const spatialPoint_t &c = _centers[i];
+      long key = (cellOf(c.x, minX) * 65536 + cellOf(c.y, minY)) * 65536 + cellOf(c.z, minZ);
+      order[i] = make_pair(key, (int)i);
+    }
+    sort(order.begin(), order.end());
+
+    double limit = ((double)_radius + 1) * ((double)_radius + 1);
+    vector<int> group;
+    for (size_t first = 0; first < order.size(); ) {
+      group.clear();
+      distance_t gMinX = _centers[order[first].second].x, gMaxX = gMinX;
+      distance_t gMinY = _centers[order[first].second].y, gMaxY = gMinY;
+      distance_t gMinZ = _centers[order[first].second].z, gMaxZ = gMinZ;
+      size_t last = first;
+      for ( ; last < order.size() && order[last].first == order[first].first; last++) {
+        const spatialPoint_t &c = _centers[order[last].second];
+        group.push_back(order[last].second);
+        gMinX = min(gMinX, c.x); gMaxX = max(gMaxX, c.x);
+        gMinY = min(gMinY, c.y); gMaxY = max(gMaxY, c.y);
+        gMinZ = min(gMinZ, c.z); gMaxZ = max(gMaxZ, c.z);
+      }
+      forEachCandidate(gMinX - _radius, gMinY - _radius, gMinZ - _radius, gMaxX + _radius, gMaxY + _radius, gMaxZ + _radius,
+        [&](const spatialEntry_t &_e) {
+          for (int center : group) {
+            const spatialPoint_t &c = _centers[center];
+            double d2 = squaredDistance(_e, c.x, c.y, c.z);
+            if (d2 < limit) {
+              distance_t d = (distance_t)sqrt(d2);
+              if (d <= _radius) _visit(center, _e.node, d);
+            }
+          }
+        });
+      first = last;
+    }
+  }
+};
+
+#endif /* SPATIAL_INDEX_H_ */
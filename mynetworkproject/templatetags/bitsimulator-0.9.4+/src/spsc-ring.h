@@ -0,0 +1,94 @@
+/*
+ * Copyright (C) 2017-2019 Dominique Dhoutaut, Thierry Arrabal, Eugen Dedu.
+ *
+ * This file is part of BitSimulator.
+ *
+ * BitSimulator is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * BitSimulator is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with BitSimulator.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef SPSC_RING_H_
+#define SPSC_RING_H_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+using namespace std;
+
+//===========================================================================================================
+//
+//          SPSCRing  (class)
+//
+//===========================================================================================================
+
+// Fixed-size ring handing records from exactly one producer thread to exactly
+// one consumer thread without locks.  Each side writes only its own index, the
+// other one reads it with acquire semantics; the two indexes are kept on
+// separate cache lines.  push() never waits: a full ring drops the record and counts it.
+
+template<typename T>
+class SPSCRing {
+private:
+  vector<T> records;
+  size_t mask;
+
+  static const size_t CACHE_LINE = 64;
+
+  // padding rather than alignas, which plain new ignores before C++17
+  char padding0[CACHE_LINE];
+  atomic<size_t> head;  // next slot to write, producer only
+  char padding1[CACHE_LINE - sizeof(atomic<size_t>)];
+  atomic<size_t> tail;  // next slot to read, consumer only
+  char padding2[CACHE_LINE - sizeof(atomic<size_t>)];
+  atomic<uint64_t> dropped;
+
+public:
+  // _capacity is rounded up to a power of 2
+  explicit SPSCRing(size_t _capacity) : head(0), tail(0), dropped(0) {
+    size_t capacity = 1;
+    while (capacity < _capacity) {
+      capacity <<= 1;
+    }
+    records.resize(capacity);
+    mask = capacity - 1;
+  }
+
+  // producer side
+  bool push(const T &_record) {
+    size_t h = head.load(memory_order_relaxed);
+    if (h - tail.load(memory_order_acquire) > mask) {
+      dropped.store(dropped.load(memory_order_relaxed) + 1, memory_order_relaxed);
+      return false;
+    }
+    records[h & mask] = _record;
+    head.store(h + 1, memory_order_release);
+    return true;
+  }
+
+  // consumer side: calls _consume on every record available, returns their number
+  template<typename F>
+  size_t drain(F _consume) {
+    size_t t = tail.load(memory_order_relaxed);
+    size_t h = head.load(memory_order_acquire);
+    for (size_t i = t; i != h; i++) {
+      _consume(records[i & mask]);
+    }
+    tail.store(h, memory_order_release);
+    return h - t;
+  }
+
+  uint64_t getDropped() const { return dropped.load(memory_order_relaxed); }
+};
+
+#endif /* SPSC_RING_H_ */
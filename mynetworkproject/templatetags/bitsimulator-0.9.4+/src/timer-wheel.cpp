@@ -0,0 +1,156 @@
+/*
+ * Copyright (C) 2017-2019 Dominique Dhoutaut, Thierry Arrabal, Eugen Dedu.
+ *
+ * This file is part of BitSimulator.
+ *
+ * BitSimulator is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * BitSimulator is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with BitSimulator.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <cstring>
+#include "timer-wheel.h"
+
+using namespace std;
+
+//===========================================================================================================
+//
+//          TimerWheel  (class)
+//
+//===========================================================================================================
+
+TimerWheel::TimerWheel() {
+  memset(occupied, 0, sizeof(occupied));
+  currentTick = 0;
+  count = 0;
+}
+
+void TimerWheel::insert(EventPtr _event, long _sequence) {
+  TimerWheelEntry_t entry;
+  entry.date = _event->date;
+  entry.sequence = _sequence;
+  entry.event = _event;
+  place(entry);
+  count++;
+}
+
+void TimerWheel::place(const TimerWheelEntry_t &_entry) {
+  uint64_t tick = (uint64_t)_entry.date >> TICK_BITS;
+  if (tick < currentTick) {
+    ready.push(_entry);
+    return;
+  }
+  for (int level = 0; level < LEVELS; level++) {
+    int shift = SLOT_BITS * (level + 1);
+    if ((tick >> shift) == (currentTick >> shift)) {
+      int slot = (tick >> (SLOT_BITS * level)) & (SLOTS - 1);
+      slots[level][slot].push_back(_entry);
+      occupied[level][slot / 64] |= (uint64_t)1 << (slot % 64);
+      return;
+    }
+  }
+  overflow.push_back(_entry);
+}
+
+int TimerWheel::nextOccupiedSlot(int _level, int _from) const {
+  for (int word = _from / 64; word < SLOTS / 64; word++) {
+    uint64_t bits = occupied[_level][word];
+    if (word == _from / 64)
+      bits &= ~(uint64_t)0 << (_from % 64);
+    if (bits != 0)
+      return word * 64 + __builtin_ctzll(bits);
+  }
+  return -1;
+}
+
+// Moves the events of the current slot of _level to the lower levels
+void TimerWheel::cascade(int _level) {
+  int slot = (currentTick >> (SLOT_BITS * _level)) & (SLOTS - 1);
+  if (slots[_level][slot].empty())
+    return;
+  vector<TimerWheelEntry_t> entries;
+  entries.swap(slots[_level][slot]);
+  occupied[_level][slot / 64] &= ~((uint64_t)1 << (slot % 64));
+  for (auto &entry : entries)
+    place(entry);
+}
+
+void TimerWheel::pullOverflow() {
+  vector<TimerWheelEntry_t> entries;
+  entries.swap(overflow);
+  for (auto &entry : entries)
+    place(entry);
+}
+
+// Moves the events of the next occupied tick to the ready heap
+void TimerWheel::advance() {
+  const uint64_t levelsMask = ((uint64_t)1 << (SLOT_BITS * LEVELS)) - 1;
+
+  while (ready.empty()) {
+    int level;
+    int slot = -1;
+    for (level = 0; level < LEVELS; level++) {
+      int current = (currentTick >> (SLOT_BITS * level)) & (SLOTS - 1);
+      // at the higher levels, the current slot has already been cascaded
+      slot = nextOccupiedSlot(level, level == 0 ? current : current + 1);
+      if (slot >= 0)
+        break;
+    }
+
+    if (slot < 0) {
+      // the wheel is empty: jump to the first overflowing event
+      uint64_t first = (uint64_t)overflow.front().date >> TICK_BITS;
+      for (auto &entry : overflow)
+        first = min(first, (uint64_t)entry.date >> TICK_BITS);
+      currentTick = first & ~levelsMask;
+      pullOverflow();
+      continue;
+    }
+
+    int shift = SLOT_BITS * level;
+    currentTick = (currentTick >> (shift + SLOT_BITS) << (shift + SLOT_BITS)) | ((uint64_t)slot << shift);
+    if (level > 0) {
+      cascade(level);
+      continue;
+    }
+
+    vector<TimerWheelEntry_t> entries;
+    entries.swap(slots[0][slot]);
+    occupied[0][slot / 64] &= ~((uint64_t)1 << (slot % 64));
+    for (auto &entry : entries)
+      ready.push(entry);
+
+    // entering the next slot of the higher levels
+    currentTick++;
+    if ((currentTick & levelsMask) == 0)
+      pullOverflow();
+    for (level = LEVELS - 1; level > 0; level--) {
+      if ((currentTick & (((uint64_t)1 << (SLOT_BITS * level)) - 1)) == 0)
+        cascade(level);
+    }
+  }
+}
+
+const TimerWheelEntry_t &TimerWheel::top() {
+  if (ready.empty())
+    advance();
+  return ready.top();
+}
+
+EventPtr TimerWheel::pop() {
+  if (ready.empty())
+    advance();
+  EventPtr event = ready.top().event;
+  ready.pop();
+  count--;
+  return event;
+}
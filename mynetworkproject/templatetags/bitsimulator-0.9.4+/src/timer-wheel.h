@@ -0,0 +1,95 @@
+/*
+ * Copyright (C) 2017-2019 Dominique Dhoutaut, Thierry Arrabal, Eugen Dedu.
+ *
+ * This file is part of BitSimulator.
+ *
+ * BitSimulator is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * BitSimulator is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with BitSimulator.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef TIMER_WHEEL_H_
+#define TIMER_WHEEL_H_
+
+#include <cstdint>
+#include <queue>
+#include <vector>
+#include "utils.h"
+#include "events.h"
+using namespace std;
+
+typedef struct {
+  simulationTime_t date;
+  long sequence;  // scheduling order, breaks ties between equal dates
+  EventPtr event;
+} TimerWheelEntry_t;
+
+//===========================================================================================================
+//
+//          TimerWheel  (class)
+//
+//===========================================================================================================
+
+// Hierarchical timer wheel holding the periodic and coarse-grained events
+// (packet generation, logging, density estimation), beside the main events
+// map of the Scheduler.
+//
+// Dates are rounded down to ticks of 2^TICK_BITS fs.  Level l has SLOTS
+// slots of 2^(SLOT_BITS*l) ticks each; an event is stored at the lowest level
+// whose current slot range contains it, and moved down one level when the
+// wheel reaches its slot.  Events beyond the highest level wait in an
+// overflow list.  When the wheel reaches a tick, the events of this tick are
+// moved to a small heap ordered by (date, sequence), so that they are
+// returned with exactly the same order as in the events map.
+
+class TimerWheel {
+private:
+  static const int TICK_BITS = 20;  // ~1 ns
+  static const int SLOT_BITS = 8;
+  static const int SLOTS = 1 << SLOT_BITS;
+  static const int LEVELS = 4;
+
+  struct EntryLater {
+    bool operator()(const TimerWheelEntry_t &_a, const TimerWheelEntry_t &_b) const {
+      return _a.date > _b.date || (_a.date == _b.date && _a.sequence > _b.sequence);
+    }
+  };
+
+  vector<TimerWheelEntry_t> slots[LEVELS][SLOTS];
+  uint64_t occupied[LEVELS][SLOTS / 64];
+  vector<TimerWheelEntry_t> overflow;
+  // events of the ticks before currentTick
+  priority_queue<TimerWheelEntry_t, vector<TimerWheelEntry_t>, EntryLater> ready;
+
+  uint64_t currentTick;
+  size_t count;
+
+  void place(const TimerWheelEntry_t &_entry);
+  int nextOccupiedSlot(int _level, int _from) const;
+  void cascade(int _level);
+  void pullOverflow();
+  void advance();
+
+public:
+  TimerWheel();
+
+  void insert(EventPtr _event, long _sequence);
+  bool empty() const { return count == 0; }
+  size_t size() const { return count; }
+
+  // earliest entry, the wheel must not be empty
+  const TimerWheelEntry_t &top();
+  EventPtr pop();
+};
+
+
+#endif /* TIMER_WHEEL_H_ */
@@ -20,6 +20,7 @@
 #include "utils.h"
 #include <cstdarg>
 #include <cassert>
+#include <atomic>
 
 //==============================================================================
 //
@@ -34,6 +35,11 @@ ScenarioParameters::ScenarioParameters(int argc, char **argv, int program) {
 
   scenarioParameters = this;
 
+  // not on the command line of VisualTracer
+  allowMultipleSend = false;
+  outputBufferCapacity = 0;
+  outputBufferDropPolicy = DropPolicy::TAIL;
+
   try {
     string text;
     if (program == 0)
@@ -48,6 +54,9 @@ ScenarioParameters::ScenarioParameters(int argc, char **argv, int program) {
     TCLAP::SwitchArg acceptCollisionedPacketsParam("","acceptCollisionedPackets","Collisioned packets are forwarded to routing agent, it's up to agents to handle them", false);
 
     TCLAP::SwitchArg doNotUseNeighboursListParam("","doNotUseNeighboursList","Save (a lot) of memory in high density scenarios, but slower", false);
+    TCLAP::ValueArg<int> neighboursThreadsParam("","neighboursThreads","Number of threads building the neighbours lists, 0 for the number of cores",false,0,"int");
+    TCLAP::SwitchArg linkShadowingParam("","linkShadowing","Draw the communication range deviation once per link (and per coherence time) instead of per transmission; compatible with the neighbours list", false);
+    TCLAP::ValueArg<long> shadowingCoherenceTimeParam("","shadowingCoherenceTime","With --linkShadowing, redraw the link deviations every such duration (in fs), 0 to never redraw them",false,0,"long");
 
     TCLAP::ValueArg<long> stepLengthParam("s","stepLength","Step length for channel usage mode",false,1000000,"long");
     TCLAP::ValueArg<long> initialTimeSkipParam("","initialTimeSkip","Directly jump to this date",false,0,"long");
@@ -55,7 +64,8 @@ ScenarioParameters::ScenarioParameters(int argc, char **argv, int program) {
     TCLAP::ValueArg<int> nodeZoomParam("","nodeZoom","How big nodes will be displayed",false,3,"int");
     TCLAP::ValueArg<string> complementaryNodeFloatInfoFileNameParam("","complementaryNodeFloatInfoFileName", "File containing a float value per node to be displayed as color scale", false,"","string");
     TCLAP::MultiArg<int> othersNodesToDisplayParam("","cn","IDs of other nodes to display in chronogram mode",false,"long");
-    TCLAP::SwitchArg precomputeStepsParam("", "precomputeSteps", "Precompute display data. May consume a lot of memory!", false);
+    TCLAP::SwitchArg precomputeStepsParam("", "precomputeSteps", "Keep every step in memory instead of a window around the displayed one. May consume a lot of memory!", false);
+    TCLAP::ValueArg<int> stepWindowParam("","stepWindow","Number of steps loaded ahead and kept behind the displayed one",false,8,"int");
 
     // options for both BitSimulator and VisualTracer
     TCLAP::ValueArg<std::string> scenarioDirectoryParam("D","scenarioDirectory", "Directory for this scenario", false,".","string", cmd);
@@ -91,6 +101,9 @@ ScenarioParameters::ScenarioParameters(int argc, char **argv, int program) {
       genericNodesRNGSeedParam = new TCLAP::ValueArg<int>("","genericNodesRNGSeed","Seed used for randomly positioning generic nodes",false,0,"int", cmd);
       cmd.add(acceptCollisionedPacketsParam);
       cmd.add(doNotUseNeighboursListParam);
+      cmd.add(neighboursThreadsParam);
+      cmd.add(linkShadowingParam);
+      cmd.add(shadowingCoherenceTimeParam);
 
       nodePositionNoiseParam = new TCLAP::ValueArg<distance_t>("","nodePositionNoise","Noise added to x, y, and z coordinates of manually positioned nodes, thus avoiding a perfect grid for example",false,0,"int", cmd);
 
@@ -111,6 +124,7 @@ ScenarioParameters::ScenarioParameters(int argc, char **argv, int program) {
 
       //SLR
       slrPathWidthParam = new TCLAP::ValueArg<int>("","slrPathWidth","Width of the SLR path (m)",false,1,"int", cmd);
+      slrCoordinatesCacheParam = new TCLAP::ValueArg<string>("","slrCoordinatesCache","File (in scenario directory) caching SLR coordinates: loaded if it matches the topology and anchors, skipping SLR beacons, written otherwise",false,"","string", cmd);
 
       //HCD
       hcdPathWidthParam = new TCLAP::ValueArg<int>("","hcdPathWidth","Width of the HCD path (m)",false,1,"int", cmd);
@@ -125,7 +139,12 @@ ScenarioParameters::ScenarioParameters(int argc, char **argv, int program) {
 
       // log system
       logAtNodeLevelParam = new TCLAP::SwitchArg("","disableLogsAtNodeLevel","Disable node level logs", cmd, true);
-      logAtRoutingLevelParam = new TCLAP::SwitchArg("","disableLogsAtRoutingLevel","Disable routing agent level logs -- NOT IMPLEMENTED", cmd, true);
+      logAtRoutingLevelParam = new TCLAP::SwitchArg("","disableLogsAtRoutingLevel","Disable routing agent level logs", cmd, true);
+
+      // output buffer
+      allowMultipleSendParam = new TCLAP::SwitchArg("","allowMultipleSend","Transmit concurrently the waiting packets whose beta differs from the ones being transmitted", cmd, false);
+      outputBufferCapacityParam = new TCLAP::ValueArg<int>("","outputBufferCapacity","Maximum number of packets waiting for transmission in a node, 0 for unbounded",false,0,"int", cmd);
+      outputBufferDropPolicyParam = new TCLAP::ValueArg<string>("","outputBufferDropPolicy","Packet dropped when the output buffer is full: tail (the new one) or head (the oldest one waiting)",false,"tail","string", cmd);
 
       // sleep system
       sleepRNGSeedParam = new TCLAP::ValueArg<int>("","sleepRNGSeed","RNG seed for the sleeping system",false,0,"int", cmd);
@@ -135,6 +154,8 @@ ScenarioParameters::ScenarioParameters(int argc, char **argv, int program) {
       //activate DEDeN
       dedenParam = new TCLAP::SwitchArg("","deden","Enable neighbours estimation using DEDeN", cmd, false);
       dedenRNGSeedParam = new TCLAP::ValueArg<int>("","dedenRNGSeed","RNG seed for deden",false,0,"int", cmd);
+      dedenOracleParam = new TCLAP::SwitchArg("","dedenOracle","Set estimated neighbours from the real neighbours count instead of simulating DEDeN probes; enables --deden", cmd, false);
+      dedenOracleErrorParam = new TCLAP::ValueArg<string>("","dedenOracleError","Error added by the DEDeN oracle, bounded by D1ErrorMax: none, uniform or normal",false,"normal","string", cmd);
 
     } else {  // VisualTracer-only options
       cmd.add(chronoParam);
@@ -142,6 +163,7 @@ ScenarioParameters::ScenarioParameters(int argc, char **argv, int program) {
       cmd.add(complementaryNodeFloatInfoFileNameParam);
       cmd.add(othersNodesToDisplayParam);
       cmd.add(precomputeStepsParam);
+      cmd.add(stepWindowParam);
       cmd.add(stepLengthParam);
       cmd.add(initialTimeSkipParam);
     }
@@ -156,6 +178,9 @@ ScenarioParameters::ScenarioParameters(int argc, char **argv, int program) {
       graphicMode = graphicModeParam.getValue();
       acceptCollisionedPackets = acceptCollisionedPacketsParam.getValue();
       doNotUseNeighboursList = doNotUseNeighboursListParam.getValue();
+      neighboursThreads = neighboursThreadsParam.getValue();
+      linkShadowing = linkShadowingParam.getValue();
+      shadowingCoherenceTime = shadowingCoherenceTimeParam.getValue();
 
       nodePositionNoise = nodePositionNoiseParam->getValue();
       slrBackoffRedundancy = slrBackoffRedundancyParam->getValue();
@@ -164,12 +189,28 @@ ScenarioParameters::ScenarioParameters(int argc, char **argv, int program) {
       slrBackoffBeaconMultiplier=slrBackoffBeaconMultiplierParam->getValue();
       backoffFloodingRNGSeed = backoffFloodingRNGSeedParam->getValue();
       slrPathWidth = slrPathWidthParam->getValue();
+      slrCoordinatesCacheFileName = slrCoordinatesCacheParam->getValue();
 
       hcdPathWidth = hcdPathWidthParam->getValue();
 
       logAtNodeLevel = logAtNodeLevelParam->getValue();
       logAtRoutingLevel = logAtRoutingLevelParam->getValue();
 
+      allowMultipleSend = allowMultipleSendParam->getValue();
+      outputBufferCapacity = outputBufferCapacityParam->getValue();
+      if (outputBufferCapacity < 0) {
+        cerr << "*** ERROR *** The output buffer capacity cannot be negative" << endl;
+        exit(EXIT_FAILURE);
+      }
+      if (outputBufferDropPolicyParam->getValue() == "tail")
+        outputBufferDropPolicy = DropPolicy::TAIL;
+      else if (outputBufferDropPolicyParam->getValue() == "head")
+        outputBufferDropPolicy = DropPolicy::HEAD;
+      else {
+        cerr << "*** ERROR *** Invalid output buffer drop policy \"" << outputBufferDropPolicyParam->getValue() << "\". Expected \"tail\" or \"head\"" << endl;
+        exit(EXIT_FAILURE);
+      }
+
       awakenDuration = awakenDurationParam->getValue();
       awakenNodes = awakenNodesParam->getValue();
       sleepRNGSeed = sleepRNGSeedParam->getValue();
@@ -187,6 +228,10 @@ ScenarioParameters::ScenarioParameters(int argc, char **argv, int program) {
       if (awakenNodesParam->isSet() || awakenDurationParam->isSet())
         dedenIsEnabled = true;
       dedenRNGSeed= dedenRNGSeedParam->getValue();
+      dedenOracle = dedenOracleParam->getValue();
+      if (dedenOracle)
+        dedenIsEnabled = true;
+      dedenOracleError = dedenOracleErrorParam->getValue();
     } else {
       stepDuration = stepLengthParam.getValue();
       initialTimeSkip = initialTimeSkipParam.getValue();
@@ -195,6 +240,7 @@ ScenarioParameters::ScenarioParameters(int argc, char **argv, int program) {
       complementaryNodeFloatInfoFileName = complementaryNodeFloatInfoFileNameParam.getValue();
       othersNodesToDisplayVector = othersNodesToDisplayParam.getValue();
       precomputeSteps = precomputeStepsParam.getValue();
+      stepWindow = stepWindowParam.getValue();
     }
   } catch (TCLAP::ArgException &e) {
     cerr << "*** ERROR *** " << e.error() << " for arg " << e.argId() << std::endl;
@@ -231,6 +277,16 @@ ScenarioParameters::ScenarioParameters(int argc, char **argv, int program) {
 
       if (dedenParam == nullptr || !dedenParam->isSet())
         dedenIsEnabled = enabled == "true";
+
+      std::string oracle;
+      queryStringAttr(dedenConfig, "oracle", oracle, false, nullptr,
+        "false", "");
+      if (!dedenOracleParam->isSet())
+        dedenOracle = oracle == "true";
+      if (dedenOracle)
+        dedenIsEnabled = true;
+      queryStringAttr(dedenConfig, "oracleError", dedenOracleError, false, dedenOracleErrorParam,
+        "normal", "");
     }
   }
 
@@ -267,8 +323,8 @@ ScenarioParameters::ScenarioParameters(int argc, char **argv, int program) {
   minimumIntervalBetweenReceiveAndSend = queryIntAttribute(nanoWirelessElement,"minimumIntervalBetweenReceiveAndSend");
   queryIntAttr(nanoWirelessElement, "binaryPayloadRNGSeed", binaryPayloadRNGSeed, false, binaryPayloadRNGSeedParam, 0, "no \"binaryPayloadRNGSeed\" attribute in \"nanoWireless\" element in "+configurationFileCompleteName);
 
-  if (program == 0 && !doNotUseNeighboursList && communicationRangeStandardDeviation != 0) {
-    cerr << "*** ERROR *** Incompatible parameters. You must not use neighbours list pre-computation if you intend to use non zero standard deviation of the communication range. Add --doNotUseNeighboursList to your command line" << endl;
+  if (program == 0 && !doNotUseNeighboursList && !linkShadowing && communicationRangeStandardDeviation != 0) {
+    cerr << "*** ERROR *** Incompatible parameters. You must not use neighbours list pre-computation if you intend to use non zero standard deviation of the communication range. Add --doNotUseNeighboursList or --linkShadowing to your command line" << endl;
     exit(EXIT_FAILURE);
   }
   displayParameters();
@@ -511,16 +567,54 @@ void ScenarioParameters::parseLogSystemElement(tinyxml2::XMLElement *_parent) {
 
   queryStringAttr(logSystemElement, "baseName", outputBaseName, false, outputBaseNameParam, "", "no \"baseName\" attribute in \"logSystem\" element, using default");
 
+  intervalLogInterval = 0;
+  intervalLogEndTime = 0;
+
   tinyxml2::XMLElement *node;
   node = logSystemElement->FirstChildElement();
   string outputFileName;
   while (node != nullptr) {
+    if (string(node->Name()) == "filter") {
+      logFilterInfo_t filter;
+      // every attribute but format is optional, without warning
+      queryStringAttr(node, "format", filter.format, true, nullptr, "", "no \"format\" attribute in <filter> element");
+      filter.enabled = true;
+      if (node->QueryBoolAttribute("enabled", &filter.enabled) == tinyxml2::XML_WRONG_ATTRIBUTE_TYPE) {
+        cerr << "*** ERROR *** \"enabled\" attribute of <filter> element for format \"" << filter.format << "\" must be true or false" << endl;
+        exit(EXIT_FAILURE);
+      }
+      filter.nodes = node->Attribute("nodes") != nullptr ? node->Attribute("nodes") : "";
+      filter.flows = node->Attribute("flows") != nullptr ? node->Attribute("flows") : "";
+      queryLongAttr(node, "from_fs", "from_ns", filter.from, false, nullptr, 0, "");
+      queryLongAttr(node, "to_fs", "to_ns", filter.to, false, nullptr, -1, "");
+      filter.sample = 1;
+      if (node->QueryIntAttribute("sample", &filter.sample) == tinyxml2::XML_WRONG_ATTRIBUTE_TYPE) {
+        cerr << "*** ERROR *** \"sample\" attribute of <filter> element for format \"" << filter.format << "\" must be an integer" << endl;
+        exit(EXIT_FAILURE);
+      }
+      logFilters.push_back(filter);
+      node = node->NextSiblingElement();
+      continue;
+    }
+
     //outputFileName = queryStringAttribute(node,"output");
     string output, suffix, io;
     queryStringAttr(node, "output", output, true, nullptr, "", "no \"output\" attribute in child of <logSystem> element");
     queryStringAttr(node, "suffix", suffix, false, nullptr, "", "no \"suffix\" attribute in child of <logSystem> element using none");
     queryStringAttr(node, "io", io, false, nullptr, "stream", "no \"io\" attribute in child of <logSystem> element");
-    mapOutputFiles.insert(pair<string,logSystemInfo_t>(node->Name(), {output, suffix, io}));
+    long shardDuration;
+    int shardRecords = 0;
+    queryLongAttr(node, "shardDuration_fs", "shardDuration_ns", shardDuration, false, nullptr, 0, "");
+    node->QueryIntAttribute("shardRecords", &shardRecords);
+    mapOutputFiles.insert(pair<string,logSystemInfo_t>(node->Name(), {output, suffix, io, shardDuration, shardRecords}));
+    if (string(node->Name()) == "IntervalLog" && output != "") {
+      queryLongAttr(node, "interval_fs", "interval_ns", intervalLogInterval, true, nullptr, 0, "no \"interval_fs\" nor \"interval_ns\" attribute in <IntervalLog> element");
+      queryLongAttr(node, "endTime_fs", "endTime_ns", intervalLogEndTime, false, nullptr, 0, "");
+      if (intervalLogInterval <= 0) {
+        cerr << "*** ERROR *** interval of <IntervalLog> must be positive" << endl;
+        exit(EXIT_FAILURE);
+      }
+    }
     node = node->NextSiblingElement();
   }
 }
@@ -555,6 +649,12 @@ void ScenarioParameters::displayParameters() {
   cout << "  backoff window width:                   " << defaultBackoffWindowWidth << endl;
   cout << "  maximum concurrent receptions:          " << maxConcurrentReceptions << endl;
   cout << "  binary payload RNG seed:                " << binaryPayloadRNGSeed << endl;
+  cout << "  output buffer capacity:                 ";
+  if (outputBufferCapacity == 0)
+    cout << "unbounded" << endl;
+  else
+    cout << outputBufferCapacity << ", drop " << (outputBufferDropPolicy == DropPolicy::TAIL ? "tail" : "head") << endl;
+  cout << "  multiple send:                          " << (allowMultipleSend ? "yes" : "no") << endl;
   cout << endl;
 
   cout << "\033[36;1mRouting agent: \033[0m" << endl;
@@ -578,6 +678,8 @@ void ScenarioParameters::displayParameters() {
   cout << "   number of tics per round:         " << D1MaxTic << endl;
   cout << "   maximum number of rounds:         " << D1MaxRound << endl;
   cout << "   minimum packets for termination:  " << D1MinPacketsForTermination << endl;
+  if (dedenOracle)
+    cout << "   oracle mode, error:               " << dedenOracleError << endl;
 
   cout << "\033[36;1m================================================\033[0m" << endl;
 }
@@ -623,6 +725,13 @@ NodesArea::NodesArea() {
     this->sizeY = 0;
     this->sizeZ = 0;
 
+    this->meanX = 0;
+    this->meanY = 0;
+    this->meanZ = 0;
+    this->deviationX = 0;
+    this->deviationY = 0;
+    this->deviationZ = 0;
+
     this->nodesCount = 0;
     this->positionRNGSeed = 0;
 }
@@ -641,13 +750,6 @@ void NodesArea::addAreaFromXMLElement( tinyxml2::XMLElement *_xmlElement ) {
     NodesArea *newArea = this;
     const char* distrib = nullptr;
 
-    distance_t meanX=0;
-    distance_t meanY=0;
-    distance_t meanZ=0;
-    distance_t deviationX = 0;
-    distance_t deviationY = 0;
-    distance_t deviationZ = 0;
-
     if ( strcmp( _xmlElement->Name(), "world") == 0) {
         //
         // If the XMLElement is the World itself, we just update the current NodesArea
@@ -767,12 +869,12 @@ void NodesArea::addAreaFromXMLElement( tinyxml2::XMLElement *_xmlElement ) {
             }
 
             if ( newArea->distribution == NodesAreaDistribution::NORMAL ) {
-                meanX = ScenarioParameters::queryLongAttribute( _xmlElement, "meanX_nm", "meanX_mm");
-                meanY = ScenarioParameters::queryLongAttribute( _xmlElement, "meanY_nm", "meanY_mm");
-                meanZ = ScenarioParameters::queryLongAttribute( _xmlElement, "meanZ_nm", "meanZ_mm");
-                deviationX = ScenarioParameters::queryLongAttribute( _xmlElement, "deviationX_nm", "deviationX_mm");
-                deviationY = ScenarioParameters::queryLongAttribute( _xmlElement, "deviationY_nm", "deviationY_mm");
-                deviationZ = ScenarioParameters::queryLongAttribute( _xmlElement, "deviationZ_nm", "deviationZ_mm");
+                newArea->meanX = ScenarioParameters::queryLongAttribute( _xmlElement, "meanX_nm", "meanX_mm");
+                newArea->meanY = ScenarioParameters::queryLongAttribute( _xmlElement, "meanY_nm", "meanY_mm");
+                newArea->meanZ = ScenarioParameters::queryLongAttribute( _xmlElement, "meanZ_nm", "meanZ_mm");
+                newArea->deviationX = ScenarioParameters::queryLongAttribute( _xmlElement, "deviationX_nm", "deviationX_mm");
+                newArea->deviationY = ScenarioParameters::queryLongAttribute( _xmlElement, "deviationY_nm", "deviationY_mm");
+                newArea->deviationZ = ScenarioParameters::queryLongAttribute( _xmlElement, "deviationZ_nm", "deviationZ_mm");
             }
         } else {
             cout << "NO DISTRIBUTION FOUND" << endl;
@@ -793,49 +895,96 @@ void NodesArea::addAreaFromXMLElement( tinyxml2::XMLElement *_xmlElement ) {
         this->children.push_back( newArea );
     }
 
+    // nodes are generated later, by forEachNodePosition()
+
     //
-    // We generate the nodes in this NodesArea
+    // We look for <area> children in the XMLElement and recursively add them to the NodesArea tree
     //
+    tinyxml2::XMLElement *xmlChild;
+    xmlChild = _xmlElement->FirstChildElement("area");
+    while ( xmlChild != nullptr ) {
+        newArea->addAreaFromXMLElement( xmlChild );
+
+        xmlChild = xmlChild->NextSiblingElement("area");
+    }
+}
+
+void NodesArea::print( string _shift) {
+    vector<NodesArea*>::iterator it;
+
+    switch ( this->shape ) {
+        case NodesAreaShape::RECTANGLE:
+            cout << _shift << "- RECTANGLE global(" << this->x << "," << this->y << "," << this->z << ") local(" << localX << "," << localY << "," << localZ << ") size: " << this->sizeX << " x " << this->sizeY << " x " << this->sizeZ << endl;
+            break;
+        case NodesAreaShape::RECTANGLE_HOLE:
+            cout << _shift << "- RECTANGLE_HOLE global(" << this->x << "," << this->y << "," << this->z << ") local(" << localX << "," << localY << "," << localZ << ") size: " << this->sizeX << " x " << this->sizeY << " x " << this->sizeZ << endl;
+            break;
+        case NodesAreaShape::ELLIPSE:
+            cout << _shift << "- ELLIPSE global(" << this->x << "," << this->y << "," << this->z << ") local(" << localX << "," << localY << "," << localZ << ") size: " << this->sizeX << " x " << this->sizeY << " x " << this->sizeZ << endl;
+            break;
+        default:
+            cout << "*** ERROR: unknown NodesAreaShape ***" << endl;
+            exit(EXIT_FAILURE);
+            break;
+    }
+
+    switch ( this->distribution ) {
+        case NodesAreaDistribution::UNIFORM:
+            cout << _shift << "  UNIFORM distribution. NodesCount: " << this->nodesCount << "  RNGSeed: " << this->positionRNGSeed << endl;
+            break;
+        default:
+            cout << _shift << "  no distribution" << endl;
+            break;
+    }
+
+    for ( it=this->children.begin(); it != this->children.end(); it++) {
+        (*it)->print( _shift + "  " );
+    }
+}
+
+// own nodes of the area, in its coordinates; each area has its own RNG, so
+// areas can be generated in any order, or at the same time
+void NodesArea::generateNodes() {
     // When generating nodes, be sure to not add nodes outside the current shape
 
-    newArea->positionsRandomGenerator = new mt19937_64(newArea->positionRNGSeed);
+    mt19937_64 positionsRandomGenerator(this->positionRNGSeed);
 
-    uniform_int_distribution<distance_t> uniformXDistribution(0, newArea->sizeX);
-    uniform_int_distribution<distance_t> uniformYDistribution(0, newArea->sizeY);
-    uniform_int_distribution<distance_t> uniformZDistribution(0, newArea->sizeZ);
+    uniform_int_distribution<distance_t> uniformXDistribution(0, this->sizeX);
+    uniform_int_distribution<distance_t> uniformYDistribution(0, this->sizeY);
+    uniform_int_distribution<distance_t> uniformZDistribution(0, this->sizeZ);
 
     normal_distribution<double> normalXDistribution(meanX, deviationX);
     normal_distribution<double> normalYDistribution(meanY, deviationY);
     normal_distribution<double> normalZDistribution(meanZ, deviationZ);
 
     distance_t xx,yy,zz;
-    double rx = newArea->sizeX/2;
-    double ry = newArea->sizeY/2;
-    double rz = newArea->sizeZ/2;
+    double rx = this->sizeX/2;
+    double ry = this->sizeY/2;
+    double rz = this->sizeZ/2;
 
     double belongsToEllipse;
 
-    switch ( newArea->shape ) {
+    switch ( this->shape ) {
         case NodesAreaShape::RECTANGLE:
 
-            switch ( newArea->distribution ) {
+            switch ( this->distribution ) {
                 case NodesAreaDistribution::UNIFORM:
                     int i;
-                    for (i=0; i<newArea->nodesCount; i++) {
-                        xx = uniformXDistribution(*newArea->positionsRandomGenerator);
-                        yy = uniformYDistribution(*newArea->positionsRandomGenerator);
-                        zz = uniformZDistribution(*newArea->positionsRandomGenerator);
-                        newArea->nodes.push_back(NodePosition(xx,yy,zz));
+                    for (i=0; i<this->nodesCount; i++) {
+                        xx = uniformXDistribution(positionsRandomGenerator);
+                        yy = uniformYDistribution(positionsRandomGenerator);
+                        zz = uniformZDistribution(positionsRandomGenerator);
+                        this->nodes.push_back(NodePosition(xx,yy,zz));
                     }
                     break;
                 case NodesAreaDistribution::NORMAL:
-                    for (i=0; i<newArea->nodesCount; i++) {
+                    for (i=0; i<this->nodesCount; i++) {
                         do {
-                            xx = normalXDistribution(*newArea->positionsRandomGenerator);
-                            yy = normalYDistribution(*newArea->positionsRandomGenerator);
-                            zz = normalZDistribution(*newArea->positionsRandomGenerator);
-                        } while ( xx < 0 || xx > newArea->sizeX || yy < 0 || yy > newArea->sizeY || zz < 0 || zz > newArea->sizeZ );
-                        newArea->nodes.push_back(NodePosition(xx,yy,zz));
+                            xx = normalXDistribution(positionsRandomGenerator);
+                            yy = normalYDistribution(positionsRandomGenerator);
+                            zz = normalZDistribution(positionsRandomGenerator);
+                        } while ( xx < 0 || xx > this->sizeX || yy < 0 || yy > this->sizeY || zz < 0 || zz > this->sizeZ );
+                        this->nodes.push_back(NodePosition(xx,yy,zz));
                     }
 
                     break;
@@ -844,21 +993,21 @@ void NodesArea::addAreaFromXMLElement( tinyxml2::XMLElement *_xmlElement ) {
             }
             break;
         case NodesAreaShape::ELLIPSE:
-            switch ( newArea->distribution ) {
+            switch ( this->distribution ) {
                 case NodesAreaDistribution::UNIFORM:
                     int i;
-                    for (i=0; i<newArea->nodesCount; i++) {
+                    for (i=0; i<this->nodesCount; i++) {
                         do {
-                            xx = uniformXDistribution(*newArea->positionsRandomGenerator) - newArea->sizeX/2;
-                            yy = uniformYDistribution(*newArea->positionsRandomGenerator) - newArea->sizeY/2;
-                            zz = uniformZDistribution(*newArea->positionsRandomGenerator) - newArea->sizeZ/2;
+                            xx = uniformXDistribution(positionsRandomGenerator) - this->sizeX/2;
+                            yy = uniformYDistribution(positionsRandomGenerator) - this->sizeY/2;
+                            zz = uniformZDistribution(positionsRandomGenerator) - this->sizeZ/2;
 
                             belongsToEllipse = 0;
                             if ( rx != 0 ) belongsToEllipse += (xx*xx)/(rx*rx);
                             if ( ry != 0 ) belongsToEllipse += (yy*yy)/(ry*ry);
                             if ( rz != 0 ) belongsToEllipse += (zz*zz)/(rz*rz);
                         } while ( belongsToEllipse > 1);
-                        newArea->nodes.push_back(NodePosition(xx,yy,zz));
+                        this->nodes.push_back(NodePosition(xx,yy,zz));
                     }
                     break;
                 default:
@@ -868,106 +1017,96 @@ void NodesArea::addAreaFromXMLElement( tinyxml2::XMLElement *_xmlElement ) {
         default:
             break;
     }
+}
 
-    //
-    // We look for <area> children in the XMLElement and recursively add them to the NodesArea tree
-    //
-    tinyxml2::XMLElement *xmlChild;
-    xmlChild = _xmlElement->FirstChildElement("area");
-    while ( xmlChild != nullptr ) {
-        newArea->addAreaFromXMLElement( xmlChild );
-
-        xmlChild = xmlChild->NextSiblingElement("area");
+void NodesArea::collectAreas( vector<NodesArea*> &_areas ) {
+    _areas.push_back( this );
+    for (auto childIt=this->children.begin(); childIt!=this->children.end(); childIt++) {
+        (*childIt)->collectAreas( _areas );
     }
 }
 
-void NodesArea::print( string _shift) {
-    vector<NodesArea*>::iterator it;
+// position given in the coordinates of this area
+bool NodesArea::isInside( const NodePosition &_position ) {
+    double rx = this->sizeX/2;
+    double ry = this->sizeY/2;
+    double rz = this->sizeZ/2;
+    double belongsToEllipse;
 
     switch ( this->shape ) {
         case NodesAreaShape::RECTANGLE:
-            cout << _shift << "- RECTANGLE global(" << this->x << "," << this->y << "," << this->z << ") local(" << localX << "," << localY << "," << localZ << ") size: " << this->sizeX << " x " << this->sizeY << " x " << this->sizeZ << endl;
-            break;
         case NodesAreaShape::RECTANGLE_HOLE:
-            cout << _shift << "- RECTANGLE_HOLE global(" << this->x << "," << this->y << "," << this->z << ") local(" << localX << "," << localY << "," << localZ << ") size: " << this->sizeX << " x " << this->sizeY << " x " << this->sizeZ << endl;
-            break;
+            return _position.x >= 0 && _position.x <= this->sizeX && _position.y >= 0 && _position.y <= this->sizeY && _position.z > 0 && _position.z <= this->sizeZ;
         case NodesAreaShape::ELLIPSE:
-            cout << _shift << "- ELLIPSE global(" << this->x << "," << this->y << "," << this->z << ") local(" << localX << "," << localY << "," << localZ << ") size: " << this->sizeX << " x " << this->sizeY << " x " << this->sizeZ << endl;
-            break;
+            belongsToEllipse = 0;
+            if ( rx != 0 ) belongsToEllipse += (_position.x*_position.x)/(rx*rx);
+            if ( ry != 0 ) belongsToEllipse += (_position.y*_position.y)/(ry*ry);
+            if ( rz != 0 ) belongsToEllipse += (_position.z*_position.z)/(rz*rz);
+            return belongsToEllipse < 1;
         default:
-            cout << "*** ERROR: unknown NodesAreaShape ***" << endl;
-            exit(EXIT_FAILURE);
-            break;
-    }
-
-    switch ( this->distribution ) {
-        case NodesAreaDistribution::UNIFORM:
-            cout << _shift << "  UNIFORM distribution. NodesCount: " << this->nodesCount << "  RNGSeed: " << this->positionRNGSeed << endl;
-            break;
-        default:
-            cout << _shift << "  no distribution" << endl;
-            break;
+            return false;
     }
+}
 
-    for ( it=this->children.begin(); it != this->children.end(); it++) {
-        (*it)->print( _shift + "  " );
+// A hole removes from its parent the nodes which come before it: the parent
+// own nodes and those of its previous children.  Rather than erasing them, a
+// node of the parent is checked against the holes following its origin.
+bool NodesArea::isInHole( const NodePosition &_position, size_t _firstChild ) {
+    for (size_t c = _firstChild; c < this->children.size(); c++) {
+        NodesArea *hole = this->children[c];
+        if ( hole->shape == NodesAreaShape::RECTANGLE_HOLE
+            && _position.x >= hole->x && _position.x <= (hole->x+hole->sizeX)
+            && _position.y >= hole->y && _position.y <= (hole->y+hole->sizeY)
+            && _position.z >= hole->z && _position.z <= (hole->z+hole->sizeZ) ) {
+            return true;
+        }
     }
+    return false;
 }
 
-vector<NodePosition> NodesArea::getNodesPositionsVector() {
-    distance_t childX, childY, childZ;
-    distance_t nX, nY, nZ;
-
-    double rx = this->sizeX/2;
-    double ry = this->sizeY/2;
-    double rz = this->sizeZ/2;
-
-    double belongsToEllipse;
-    cout << "getNodesPositionsVector **********************";
-    if ( this->shape == NodesAreaShape::RECTANGLE ) cout << " RECTANGLE" << endl;
-    if ( this->shape == NodesAreaShape::ELLIPSE ) cout << " ELLIPSE" << endl;
-    if ( this->shape == NodesAreaShape::RECTANGLE_HOLE ) cout << " RECTANGLE_HOLE" << endl;
-
-    for (auto childIt=this->children.begin(); childIt!=this->children.end(); childIt++) {
-        vector<NodePosition> childNodesPositionsVector = (*childIt)->getNodesPositionsVector();
-        childX = (*childIt)->localX;
-        childY = (*childIt)->localY;
-        childZ = (*childIt)->localZ;
-
-        for (auto nodeIt=childNodesPositionsVector.begin(); nodeIt!=childNodesPositionsVector.end(); nodeIt++) {
-            nX = nodeIt->x+childX;
-            nY = nodeIt->y+childY;
-            nZ = nodeIt->z+childZ;
-
-            switch ( this->shape ) {
-                case NodesAreaShape::RECTANGLE:
-                case NodesAreaShape::RECTANGLE_HOLE:
-                    if (nX >= 0 && nX <= this->sizeX && nY >= 0 && nY <= this->sizeY && nZ > 0 && nZ <= this->sizeZ ) {
-                        this->nodes.push_back(NodePosition(nX,nY,nZ));
-                    }
-                    break;
-                case NodesAreaShape::ELLIPSE:
-                    belongsToEllipse = 0;
-                    if ( rx != 0 ) belongsToEllipse += (nX*nX)/(rx*rx);
-                    if ( ry != 0 ) belongsToEllipse += (nY*nY)/(ry*ry);
-                    if ( rz != 0 ) belongsToEllipse += (nZ*nZ)/(rz*rz);
-                    if ( belongsToEllipse < 1) this->nodes.push_back(NodePosition(nX,nY,nZ));
-                    break;
-                default:
-                    break;
-            }
+// own nodes first, then those of the children in order, in the coordinates of this area
+void NodesArea::streamNodes( const function<void(const NodePosition&)> &_operation ) {
+    for (auto it=this->nodes.begin(); it!=this->nodes.end(); it++) {
+        if ( !isInHole( *it, 0 ) ) {
+            _operation( *it );
         }
     }
-
-    if ( this->shape == NodesAreaShape::RECTANGLE_HOLE ) {
-        for (auto it=parent->nodes.begin(); it!=parent->nodes.end(); ) {
-            if ( it->x >= x && it->x <= (x+sizeX) && it->y >= y && it->y <= (y+sizeY) && it->z >= z && it->z <= (z+sizeZ) ) {
-                it = parent->nodes.erase( it );
-            } else {
-                it++;
+    vector<NodePosition>().swap( this->nodes );
+
+    for (size_t c = 0; c < this->children.size(); c++) {
+        NodesArea *child = this->children[c];
+        child->streamNodes( [&]( const NodePosition &_position ) {
+            NodePosition position( _position.x + child->localX, _position.y + child->localY, _position.z + child->localZ );
+            if ( isInside( position ) && !isInHole( position, c + 1 ) ) {
+                _operation( position );
             }
+        });
+    }
+}
+
+// Calls _operation on the position of every node of the area tree, without
+// building the whole list: the areas generate their own nodes at the same
+// time, then these are streamed through the tree.
+void NodesArea::forEachNodePosition( const function<void(const NodePosition&)> &_operation ) {
+    vector<NodesArea*> areas;
+    collectAreas( areas );
+
+    atomic<size_t> nextArea(0);
+    auto worker = [&]() {
+        size_t a;
+        while ( (a = nextArea++) < areas.size() ) {
+            areas[a]->generateNodes();
         }
+    };
+    size_t threads = min( (size_t)max(1u, thread::hardware_concurrency()), areas.size() );
+    vector<thread> pool;
+    for (size_t t = 1; t < threads; t++) {
+        pool.push_back( thread(worker) );
+    }
+    worker();
+    for (auto &t : pool) {
+        t.join();
     }
 
-    return this->nodes;
+    streamNodes( _operation );
 }
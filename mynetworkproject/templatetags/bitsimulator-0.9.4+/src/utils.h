@@ -33,6 +33,7 @@
 #include <set>
 #include <map>
 #include <exception>
+#include <functional>
 
 #include <tclap/CmdLine.h>
 #include <tinyxml2.h>
@@ -76,6 +77,12 @@ enum class NodesAreaDistribution {
     NORMAL
 };
 
+// which packet is lost when a full output buffer receives one more
+enum class DropPolicy {
+    TAIL,  // the new one
+    HEAD   // the oldest one waiting
+};
+
 class NodesArea;
 
 //===========================================================================================================
@@ -143,6 +150,9 @@ private:
   TCLAP::ValueArg<int> *binaryPayloadRNGSeedParam;
 
   bool doNotUseNeighboursList;
+  int neighboursThreads;
+  bool linkShadowing;
+  simulationTime_t shadowingCoherenceTime;
 
   // Agents
   string routingAgentName;
@@ -174,8 +184,11 @@ private:
 
   // log system
   map<string,logSystemInfo_t> mapOutputFiles;
+  vector<logFilterInfo_t> logFilters;
   string outputBaseName;
   TCLAP::ValueArg<string> *outputBaseNameParam;
+  simulationTime_t intervalLogInterval;  // 0 when the interval log is disabled
+  simulationTime_t intervalLogEndTime;   // 0 to log until the end of the simulation
 
   // graphic mode
   bool graphicMode;
@@ -199,6 +212,8 @@ private:
   //slr
   int slrPathWidth;
   TCLAP::ValueArg<int> *slrPathWidthParam;
+  string slrCoordinatesCacheFileName;
+  TCLAP::ValueArg<string> *slrCoordinatesCacheParam;
 
   //hcd
   int hcdPathWidth;
@@ -225,6 +240,10 @@ private:
   //simulation mode
   bool allowMultipleSend;
   TCLAP::SwitchArg *allowMultipleSendParam;
+  int outputBufferCapacity;
+  TCLAP::ValueArg<int> *outputBufferCapacityParam;
+  DropPolicy outputBufferDropPolicy;
+  TCLAP::ValueArg<string> *outputBufferDropPolicyParam;
 
   //sleeping system
   bool sleepIsEnabled;
@@ -240,6 +259,10 @@ private:
   TCLAP::SwitchArg *dedenParam;
   int dedenRNGSeed;
   TCLAP::ValueArg<int> *dedenRNGSeedParam;
+  bool dedenOracle;
+  TCLAP::SwitchArg *dedenOracleParam;
+  string dedenOracleError;
+  TCLAP::ValueArg<string> *dedenOracleErrorParam;
 
 
   // ##COMMANDLINE NEW OPTIONS
@@ -252,6 +275,7 @@ private:
   string complementaryNodeFloatInfoFileName;
   vector <int>othersNodesToDisplayVector;
   bool precomputeSteps;
+  int stepWindow;
   
   NodesArea *rootNodesArea;
 
@@ -285,6 +309,9 @@ public:
   static distance_t getWorldZSize() { return(scenarioParameters->worldZSize); }
   static vector<NodeInfo> getVectNodeInfo() { return(scenarioParameters->vectNodeInfo); }
   static map<string,logSystemInfo_t> getMapOutPutFiles() { return(scenarioParameters->mapOutputFiles); }
+  static vector<logFilterInfo_t> getLogFilters() { return(scenarioParameters->logFilters); }
+  static simulationTime_t getIntervalLogInterval() { return(scenarioParameters->intervalLogInterval); }
+  static simulationTime_t getIntervalLogEndTime() { return(scenarioParameters->intervalLogEndTime); }
   static string getOutputBaseName() { return(scenarioParameters->outputBaseName); }
   static int getGenericNodesNumber() { return(scenarioParameters->genericNodesNumber); }
   static int getGenericNodesRNGSeed() { return(scenarioParameters->genericNodesRNGSeed); }
@@ -302,6 +329,9 @@ public:
   static bool getGraphicMode() { return(scenarioParameters->graphicMode); }
   static string getRoutingAgentName() { return(scenarioParameters->routingAgentName); }
   static bool getDoNotUseNeighboursList() { return(scenarioParameters->doNotUseNeighboursList); }
+  static int getNeighboursThreads() { return(scenarioParameters->neighboursThreads); }
+  static bool getLinkShadowing() { return(scenarioParameters->linkShadowing); }
+  static simulationTime_t getShadowingCoherenceTime() { return(scenarioParameters->shadowingCoherenceTime); }
   static bool getAcceptCollisionedPackets() { return(scenarioParameters->acceptCollisionedPackets); }
   static int getBinaryPayloadRNGSeed() { return(scenarioParameters->binaryPayloadRNGSeed); }
 
@@ -317,6 +347,7 @@ public:
 
   //slr
   static int getSlrPathWidth() { return(scenarioParameters->slrPathWidth); }
+  static string getSlrCoordinatesCacheFileName() { return(scenarioParameters->slrCoordinatesCacheFileName); }
 
   //hcd
   static int getHcdPathWidth() { return(scenarioParameters->hcdPathWidth); }
@@ -335,6 +366,9 @@ public:
   static bool getLogAtRoutingLevel() { return scenarioParameters->logAtRoutingLevel; }
 
   //sleeping system
+  static bool getAllowMultipleSend() { return scenarioParameters->allowMultipleSend; }
+  static int getOutputBufferCapacity() { return scenarioParameters->outputBufferCapacity; }
+  static DropPolicy getOutputBufferDropPolicy() { return scenarioParameters->outputBufferDropPolicy; }
   static bool getSleep() { return scenarioParameters->sleepIsEnabled; }
   static int getAwakenDuration () { return scenarioParameters->awakenDuration; }
   static int getAwakenNodes () {return scenarioParameters->awakenNodes; }
@@ -343,6 +377,8 @@ public:
   //Activate DEDEN
   static bool getDeden() { return scenarioParameters->dedenIsEnabled; }
   static int getDedenRNGSeed() {return scenarioParameters->dedenRNGSeed;}
+  static bool getDedenOracle() { return scenarioParameters->dedenOracle; }
+  static string getDedenOracleError() { return scenarioParameters->dedenOracleError; }
 
   static long getStepDuration() { return(scenarioParameters->stepDuration); }
   static long getInitialTimeSkip() { return(scenarioParameters->initialTimeSkip); }
@@ -351,6 +387,7 @@ public:
   static string getComplementaryNodeFloatInfoFileName() { return(scenarioParameters->complementaryNodeFloatInfoFileName); }
   static vector<int> getOthersNodesToDisplay() { return(scenarioParameters->othersNodesToDisplayVector); }
   static bool getPrecomputeSteps() { return scenarioParameters->precomputeSteps; }
+  static int getStepWindow() { return scenarioParameters->stepWindow; }
 
   static string getDefaultExtension() {return ".log";}
 
@@ -394,7 +431,7 @@ public:
         void addAreaFromXMLElement( tinyxml2::XMLElement *_xmlElement );
 
         void print( string _shift);
-        vector<NodePosition> getNodesPositionsVector();
+        void forEachNodePosition( const function<void(const NodePosition&)> &_operation );
 
 private:
         distance_t x,y,z;                   // global coordinates (relative to the whole world)
@@ -402,12 +439,19 @@ private:
 
         distance_t sizeX, sizeY, sizeZ;
 
-        mt19937_64 *positionsRandomGenerator;
+        distance_t meanX, meanY, meanZ;     // NORMAL distribution only
+        distance_t deviationX, deviationY, deviationZ;
 
         NodesArea *parent;
         vector<NodesArea*> children;
 
-        vector<NodePosition> nodes;
+        vector<NodePosition> nodes;         // own nodes, between generation and streaming
+
+        void collectAreas( vector<NodesArea*> &_areas );
+        void generateNodes();
+        bool isInside( const NodePosition &_position );
+        bool isInHole( const NodePosition &_position, size_t _firstChild );
+        void streamNodes( const function<void(const NodePosition&)> &_operation );
 };
 
 #endif /* UTILS_H_ */
@@ -21,7 +21,13 @@
 #include <iostream>
 #include <vector>
 #include <list>
+#include <map>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
 #include <stdio.h>
+#include <unistd.h>
 #include <SDL2/SDL.h>
 #include <SDL2/SDL_ttf.h>
 #include <SDL2/SDL2_gfxPrimitives.h>
@@ -160,7 +166,7 @@ namespace Data {
 }
 
 
-// data structures for holding precomputed visualisation data.
+// data structures for holding loaded visualisation data.
 using histData = array<int, DisplayProperties::histoElemNumber>;
 using NodeVect = vector<GraphicNode>;
 
@@ -337,6 +343,15 @@ void initialiseVisualizer(NodeVect &vectGraphicNode) {
 
   }
 
+  // logs written with io="gz", or sharded logs
+  string shardsIndexName = ScenarioParameters::getScenarioDirectory() + "/" + ScenarioParameters::getOutputBaseName() + separator + "events.index";
+  if (access(eventsFileName.c_str(), R_OK) != 0) {
+    if (access((eventsFileName + ".gz").c_str(), R_OK) == 0) {
+      eventsFileName += ".gz";
+    } else if (access(shardsIndexName.c_str(), R_OK) == 0) {
+      eventsFileName = shardsIndexName;
+    }
+  }
   cout << "Opening events file: " << eventsFileName << endl;
   cout << "... ";
   Data::eventsFile = fopen(eventsFileName.c_str(),"r");
@@ -626,13 +641,19 @@ simulationTime_t getStepStartTime(StepData& data, simulationTime_t firstEvent) {
 }
 
 
-void loadStep(StepData& data) {
-  static int id;
-  static long time=-1;
-  static string type;
+// where the reading of the log stands between two steps: the first event
+// beyond the previous step, already read, and the position of its line.
+struct StepCursor {
+  int id = 0;
+  long time = -1;
+  string type;
+  bool dataAvailable = false;
+  logPosition_t position;
+};
 
+void loadStep(StepData& data, StepCursor& cursor) {
   LogOutput::LineType res;
-  static bool dataAvailable = false;
+  logPosition_t linePosition;
 
   data.nbEvents = 0;
 
@@ -644,13 +665,18 @@ void loadStep(StepData& data) {
 
   std::cout << "loadStep [" << data.startTime << ", " << data.stepDuration << "]\n";
 
-  while (dataAvailable || time < data.startTime + data.stepDuration) {
-    if (dataAvailable) {
+  // with a sharded log, jump over the shards ending before this step
+  if (!cursor.dataAvailable) {
+    Data::output.seek(data.startTime);
+  }
+
+  while (cursor.dataAvailable || cursor.time < data.startTime + data.stepDuration) {
+    if (cursor.dataAvailable) {
       // if the event is too late for this step...
-      if (time >= data.startTime + data.stepDuration) {
+      if (cursor.time >= data.startTime + data.stepDuration) {
         if (data.nbEvents == 0) {
           // well, just move the step.
-          data.startTime = getStepStartTime(data, time);
+          data.startTime = getStepStartTime(data, cursor.time);
         }
         else {
           // unless, of course, it already has events.
@@ -659,25 +685,28 @@ void loadStep(StepData& data) {
       }
 
       // save the last loaded line of data.
-      injectStepData(data, type, id, time);
-      time = -1;
+      injectStepData(data, cursor.type, cursor.id, cursor.time);
+      cursor.time = -1;
       data.nbEvents += 1;
-      dataAvailable = false;
+      cursor.dataAvailable = false;
     }
 
+    linePosition = Data::output.tell();
     res = Data::output.readNextLine();
     if (res == LogOutput::LineType::END_OF_FILE) {
-      dataAvailable = false;
+      cursor.dataAvailable = false;
+      cursor.position = linePosition;
       break;
     }
     else if (res == LogOutput::LineType::DATA) {
-      type = Data::output.currentLineFormatKey();
-      if (type.compare("r") == 0 || type.compare("s") == 0 ||
-        type.compare("c") == 0 || type.compare("i") == 0 ) {
-
-        time = Data::output.getLogItemLongValue("time");
-        id = Data::output.getLogItemIntValue("nodeID");
-        dataAvailable = true;
+      cursor.type = Data::output.currentLineFormatKey();
+      if (cursor.type.compare("r") == 0 || cursor.type.compare("s") == 0 ||
+        cursor.type.compare("c") == 0 || cursor.type.compare("i") == 0 ) {
+
+        cursor.time = Data::output.getLogItemLongValue("time");
+        cursor.id = Data::output.getLogItemIntValue("nodeID");
+        cursor.dataAvailable = true;
+        cursor.position = linePosition;
       }
       else {
         // Just read a commented line in the log file.
@@ -690,16 +719,165 @@ void loadStep(StepData& data) {
   return;
 }
 
-bool advanceStep(StepData& data, simulationTime_t startTime) {
-  static int nbEventsTotal = 0;
 
-  clearStepData(data);
-  data.startTime = startTime;
-  loadStep(data);
+//==============================================================================
+//
+//          StepWindow  (class)
+//
+//==============================================================================
+
+// Steps of the map mode, kept in a window around the displayed one.  A loader
+// thread owns the events log: it loads the displayed step first, then the
+// next ones, then the previous ones, and forgets the steps leaving the window,
+// so memory does not grow with the length of the trace.  The log position of
+// the first line of every step met is kept, to reload a forgotten step
+// without reading the log again from its beginning.
+class StepWindow {
+private:
+  typedef struct {
+    simulationTime_t startTime;
+    logPosition_t position;
+  } stepStart_t;
+
+  const NodeVect& nodes;
+  size_t radius;
+
+  mutex windowMutex;
+  condition_variable windowCondition;
+  map<size_t, shared_ptr<const StepData>> steps;
+  vector<stepStart_t> starts;  // start of the steps met so far
+  size_t stepCount;            // known once the end of the log is met
+  size_t current;
+  bool stopping;
+
+  // loader thread only
+  StepCursor cursor;
+  size_t cursorStep;           // step the cursor is ready to load
+  thread loader;
+
+  bool isMissing(size_t _step) {
+    return _step < starts.size() && _step < stepCount && steps.count(_step) == 0;
+  }
+
+  // chooses the step to load next, with windowMutex held
+  bool nextStepToLoad(size_t& _step) {
+    if (isMissing(current)) {
+      _step = current;
+      return true;
+    }
+    for (size_t i = 1; i <= radius && current + i < starts.size(); i++) {
+      if (isMissing(current + i)) {
+        _step = current + i;
+        return true;
+      }
+    }
+    for (size_t i = 1; i <= radius && i <= current; i++) {
+      if (isMissing(current - i)) {
+        _step = current - i;
+        return true;
+      }
+    }
+    // a step far ahead was asked: walk up to it
+    if (current >= starts.size() && starts.size() - 1 < stepCount) {
+      _step = starts.size() - 1;
+      return true;
+    }
+    return false;
+  }
+
+  void loaderLoop() {
+    unique_lock<mutex> lock(windowMutex);
+    while (true) {
+      size_t step = 0;
+      windowCondition.wait(lock, [&] { return stopping || nextStepToLoad(step); });
+      if (stopping) {
+        return;
+      }
+      stepStart_t start = starts[step];
+      lock.unlock();
+
+      if (step != cursorStep) {
+        // a forgotten step: go back to its first line
+        cursor = StepCursor();
+        Data::output.seek(start.position);
+      }
+      shared_ptr<StepData> data = make_shared<StepData>();
+      data->vectGraphicNode = nodes;
+      clearStepData(*data);
+      data->startTime = start.startTime;
+      loadStep(*data, cursor);
+      cursorStep = step + 1;
+
+      lock.lock();
+      if (data->nbEvents == 0 && step > 0) {
+        stepCount = step;
+      } else {
+        steps[step] = data;
+        if (starts.size() == step + 1) {
+          starts.push_back({ data->startTime + data->stepDuration, cursor.position });
+        }
+      }
+      for (auto it = steps.begin(); it != steps.end(); ) {
+        size_t distance = (it->first > current) ? it->first - current : current - it->first;
+        if (distance > radius) {
+          it = steps.erase(it);
+        } else {
+          ++it;
+        }
+      }
+      windowCondition.notify_all();
+    }
+  }
+
+public:
+  // _radius: number of steps loaded ahead and kept behind the displayed one
+  StepWindow(const NodeVect& _nodes, size_t _radius) : nodes(_nodes) {
+    radius = (_radius > 0) ? _radius : 1;
+    stepCount = numeric_limits<size_t>::max();
+    current = 0;
+    stopping = false;
+    cursorStep = 0;
+    starts.push_back({ 0, Data::output.tell() });
+    loader = thread(&StepWindow::loaderLoop, this);
+  }
+
+  ~StepWindow() {
+    stop();
+  }
 
-  nbEventsTotal += data.nbEvents;
+  // waits for a step to be loaded, and moves the window around it;
+  // nullptr when the log ends before this step
+  shared_ptr<const StepData> get(size_t _step) {
+    unique_lock<mutex> lock(windowMutex);
+    size_t previous = current;
+    current = _step;
+    windowCondition.notify_all();
+    windowCondition.wait(lock, [&] { return steps.count(_step) != 0 || _step >= stepCount; });
+    if (_step >= stepCount) {
+      current = previous;
+      windowCondition.notify_all();
+      return nullptr;
+    }
+    return steps[_step];
+  }
 
-  return data.nbEvents != 0;
+  void stop() {
+    {
+      lock_guard<mutex> lock(windowMutex);
+      stopping = true;
+    }
+    windowCondition.notify_all();
+    if (loader.joinable()) {
+      loader.join();
+    }
+  }
+};
+
+size_t getStepWindowRadius() {
+  if (ScenarioParameters::getPrecomputeSteps()) {
+    return numeric_limits<size_t>::max();
+  }
+  return max(ScenarioParameters::getStepWindow(), 1);
 }
 
 void drawText(int _xPos, int _yPos, string _text, SDL_Color _color) {
@@ -856,35 +1034,8 @@ void renderStep(int stepNum, const StepData& data) {
   SDL_RenderPresent(DisplayProperties::renderer);
 }
 
-list<StepData> precomputeMapData(NodeVect& nodes) {
-  // precompute step data.
-  list<StepData> data;
-
-  bool hasMoreData = true;
-  simulationTime_t currentTime = 0;
-  while (hasMoreData) {
-    StepData step;
-    step.vectGraphicNode = nodes;
-
-    hasMoreData = advanceStep(step, currentTime);
-    currentTime = step.startTime + step.stepDuration;
-
-
-    if (hasMoreData) {
-      data.push_back(step);
-      if (data.size() % 10 == 0) {
-        std::cout << "loaded " << data.size() << " steps...\n";
-      }
-    }
-  }
-
-  std::cout << "finished loading " << data.size() << " steps.\n";
-
-  return data;
-}
-
 bool processSDLEvent(long unsigned int& currentStep,
-  list<StepData>::iterator& iterator, list<StepData>& data) {
+  shared_ptr<const StepData>& step, StepWindow& window) {
 
   SDL_Event evt;
   bool render = false;
@@ -894,27 +1045,17 @@ bool processSDLEvent(long unsigned int& currentStep,
   if(evt.type == SDL_KEYDOWN) {
     if (evt.key.keysym.sym == SDLK_SPACE ||
       evt.key.keysym.sym == SDLK_g) {
-      if (!ScenarioParameters::getPrecomputeSteps()) {
-        // advance by one more step.
-        bool hasMoreData = advanceStep(*iterator,
-          iterator->startTime + iterator->stepDuration);
-        if (hasMoreData) {
-          ++currentStep;
-          render = true;
-        }
-      }
-      else {
-        if (iterator != --data.end()) {
-          ++iterator;
-          ++currentStep;
-          render = true;
-        }
+      // advance by one more step.
+      shared_ptr<const StepData> next = window.get(currentStep + 1);
+      if (next) {
+        step = next;
+        ++currentStep;
+        render = true;
       }
     }
-    if (evt.key.keysym.sym == SDLK_f &&
-      ScenarioParameters::getPrecomputeSteps()) {
-      if (iterator != data.begin()) {
-        --iterator;
+    if (evt.key.keysym.sym == SDLK_f) {
+      if (currentStep > 0) {
+        step = window.get(currentStep - 1);
         --currentStep;
         render = true;
       }
@@ -968,18 +1109,20 @@ bool processSDLEvent(long unsigned int& currentStep,
       render = true;
     }
     if (evt.key.keysym.sym == SDLK_q && evt.key.keysym.mod && KMOD_LCTRL != 0) {
+      window.stop();
       SDL_Quit();
       exit(0);
     }
   }
   if(evt.type == SDL_QUIT) {
+    window.stop();
     SDL_Quit();
     exit(0);
   }
 
   // if there are further events, process immediately.
   if (SDL_PollEvent(NULL) == 1) {
-    render = render || processSDLEvent(currentStep, iterator, data// , cont
+    render = render || processSDLEvent(currentStep, step, window// , cont
       );
   }
 
@@ -987,30 +1130,20 @@ bool processSDLEvent(long unsigned int& currentStep,
 }
 
 void mainSDLLoopMap(NodeVect& nodes) {
-  list<StepData> data;
-  if (ScenarioParameters::getPrecomputeSteps()) {
-    data = precomputeMapData(nodes);
-  }
-  else {
-    // load just one step.
-    StepData step;
-    step.vectGraphicNode = nodes;
-    advanceStep(step, 0);
-    data.push_back(step);
-  }
+  StepWindow window(nodes, getStepWindowRadius());
 
   initialiseSDL();
 
   bool programrunning = true;
   long unsigned int currentStep = 0;
-  auto iterator = data.begin();
+  shared_ptr<const StepData> step = window.get(currentStep);
 
-  renderStep(currentStep, *iterator);
+  renderStep(currentStep, *step);
   while (programrunning) {
-    bool render = processSDLEvent(currentStep, iterator, data);
+    bool render = processSDLEvent(currentStep, step, window);
 
     if (render) {
-      renderStep(currentStep, *iterator);
+      renderStep(currentStep, *step);
     }
   }
 }
@@ -1108,33 +1241,24 @@ void glRenderStep(Renderer& render, int stepNum, const StepData& data) {
 }
 
 bool glProcessSDLEvent(Renderer& renderer, long unsigned int& currentStep,
-  list<StepData>::iterator& iterator, list<StepData>& data) {
+  shared_ptr<const StepData>& step, StepWindow& window) {
   SDL_Event evt;
   bool reprocess = false;
   while (SDL_PollEvent(&evt)) {
     if(evt.type == SDL_KEYDOWN) {
       if (evt.key.keysym.sym == SDLK_SPACE ||
         evt.key.keysym.sym == SDLK_g) {
-        if (!ScenarioParameters::getPrecomputeSteps()) {
-          // advance by one more step.
-          bool hasMoreData = advanceStep(*iterator,
-            iterator->startTime + iterator->stepDuration);
-          if (hasMoreData) {
-            ++currentStep;
-            reprocess = true;
-          }
-        }
-        else {
-          if (iterator != --data.end()) {
-            ++iterator;
-            ++currentStep;
-            reprocess = true;
-          }
+        // advance by one more step.
+        shared_ptr<const StepData> next = window.get(currentStep + 1);
+        if (next) {
+          step = next;
+          ++currentStep;
+          reprocess = true;
         }
       }
-      if (evt.key.keysym.sym == SDLK_f && ScenarioParameters::getPrecomputeSteps()) {
-        if (iterator != data.begin()) {
-          --iterator;
+      if (evt.key.keysym.sym == SDLK_f) {
+        if (currentStep > 0) {
+          step = window.get(currentStep - 1);
           --currentStep;
           reprocess = true;
         }
@@ -1221,6 +1345,7 @@ bool glProcessSDLEvent(Renderer& renderer, long unsigned int& currentStep,
       }
       if (evt.key.keysym.sym == SDLK_q && evt.key.keysym.mod &&
         KMOD_LCTRL != 0) {
+        window.stop();
         SDL_Quit();
         exit(0);
       }
@@ -1231,6 +1356,7 @@ bool glProcessSDLEvent(Renderer& renderer, long unsigned int& currentStep,
       }
     }
     else if (evt.type == SDL_QUIT) {
+      window.stop();
       SDL_Quit();
       exit(0);
     }
@@ -1275,17 +1401,7 @@ void glRecenterView(Renderer& renderer, const vector<GraphicNode>& nodes) {
 }
 
 void mainGLLoopMap(NodeVect& nodes) {
-  list<StepData> data;
-  if (ScenarioParameters::getPrecomputeSteps()) {
-    data = precomputeMapData(nodes);
-  }
-  else {
-    // load just one step.
-    StepData step;
-    step.vectGraphicNode = nodes;
-    advanceStep(step, 0);
-    data.push_back(step);
-  }
+  StepWindow window(nodes, getStepWindowRadius());
 
   Renderer renderer;
   std::string title("VisualTracer " VERSION);
@@ -1293,16 +1409,16 @@ void mainGLLoopMap(NodeVect& nodes) {
 
   bool programrunning = true;
   long unsigned int currentStep = 0;
-  auto iterator = data.begin();
+  shared_ptr<const StepData> step = window.get(currentStep);
 
-  glRenderStaticStep(renderer, *iterator);
-  glRecenterView(renderer, iterator->vectGraphicNode);
+  glRenderStaticStep(renderer, *step);
+  glRecenterView(renderer, step->vectGraphicNode);
 
-  glRenderStep(renderer, currentStep, *iterator);
+  glRenderStep(renderer, currentStep, *step);
   while (programrunning) {
-    bool reprocess = glProcessSDLEvent(renderer, currentStep, iterator, data);
+    bool reprocess = glProcessSDLEvent(renderer, currentStep, step, window);
     if (reprocess) {
-      glRenderStep(renderer, currentStep, *iterator);
+      glRenderStep(renderer, currentStep, *step);
     }
     glDrawDrawingModesStates(renderer);
     renderer.redraw();
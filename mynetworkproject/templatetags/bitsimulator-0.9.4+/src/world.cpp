@@ -21,6 +21,7 @@
 #include "utils.h"
 #include "scheduler.h"
 #include "world.h"
+#include "interval-log.h"
 
 #include "agents/deden-agent.h"
 #include "agents/incident-observer-agent.h"
@@ -31,6 +32,7 @@
 #include "agents/backoff-deviation-routing-agent.h"
 #include "agents/hcd-routing-agent.h"
 #include "agents/cbr-application-agent.h"
+#include "agents/trace-application-agent.h"
 #include "agents/backoff-flooding-routing-agent.h"
 #include "agents/backoff-flooding-ring-routing-agent.h"
 #include "agents/proba-flooding-routing-agent.h"
@@ -38,6 +40,7 @@
 #include "agents/slr-routing-agent.h"
 #include "agents/slr-backoff-routing-agent.h"
 #include "agents/slr-backoff-routing-agent3.h"
+#include "agents/slr-coordinates-cache.h"
 #include "agents/slr-ring-routing-agent.h"
 #include "agents/slr-deviation-routing-agent.h"
 
@@ -65,11 +68,11 @@ namespace DisplayProperties {
 //==============================================================================
 
 World *World::myWorld = nullptr;
-mt19937_64 *World::shadowingCommunicationRangeRandomGenerator = nullptr;
 normal_distribution<double> World::shadowingCommunicationRangeDistribution;
 
-World::World() {
+World::World() : drawRing(drawRingCapacity) {
   cout << "Creating World ..." << endl;
+  myWorld = this;  // the nodes count their neighbours through it in printWorldInfo
 
   sizeX = ScenarioParameters::getWorldXSize();
   sizeY = ScenarioParameters::getWorldYSize();
@@ -77,8 +80,9 @@ World::World() {
   cout << "  World size [ " << sizeX << ", " << sizeY << ", " << sizeZ << " ]" << endl;
 
   ptrNodes3D = nullptr;
+  mobility = nullptr;
+  positionsDate = -1;
 
-  shadowingCommunicationRangeRandomGenerator = new mt19937_64( 42 );
   World::shadowingCommunicationRangeDistribution = normal_distribution<double>(0.0,ScenarioParameters::getCommunicationRangeStandardDeviation());
 
   initNodes();
@@ -87,6 +91,7 @@ World::World() {
 }
 
 World::~World() {
+  delete mobility;
   if (ptrNodes3D != nullptr) {
     for(int i=0; i<gridXSize; i++) {
       for(int j=0; j<gridYSize; j++) {
@@ -161,16 +166,14 @@ void World::initNodes() {
   uniform_int_distribution<distance_t> posZUniformDistribution(0, ScenarioParameters::getWorldZSize());
 
   int generatedNodesCount = 0;
-  vector<NodePosition> nodesPositionsVector = ScenarioParameters::getRootNodesArea()->getNodesPositionsVector();
-
-  for (auto it=nodesPositionsVector.begin(); it<nodesPositionsVector.end(); it++) {
+  ScenarioParameters::getRootNodesArea()->forEachNodePosition( [&]( const NodePosition &_position ) {
     if (sleep)
-      newNode = new SleepingNode(Node::getNextId(), it->x, it->y, it->z);
+      newNode = new SleepingNode(Node::getNextId(), _position.x, _position.y, _position.z);
     else
-      newNode = new Node(Node::getNextId(), it->x, it->y, it->z);
+      newNode = new Node(Node::getNextId(), _position.x, _position.y, _position.z);
     vectNodes.push_back(newNode);
     generatedNodesCount++;
-  }
+  });
 
   cout << "  random nodes generated: " << generatedNodesCount << endl;
 
@@ -200,12 +203,12 @@ void World::initNodes() {
     (*currentNodeIt)->setCommunicationRangeStandardDeviation( ScenarioParameters::getCommunicationRangeStandardDeviation() );
   }
 
+  spatialIndex.build(vectNodes, ScenarioParameters::getCommunicationRange());
+  mobility = MobilityModel::create(vectNodes);
+
   //
   // neighborhood construction
   //
-  int counter=0;
-  distance_t distance;
-
   if ( ScenarioParameters::getDoNotUseNeighboursList() ) {
     gridXSize = (int)ceil(ScenarioParameters::getWorldXSize() / ScenarioParameters::getCommunicationRange() ) + 1;
     if (gridXSize == 0) gridXSize = 1;
@@ -266,107 +269,173 @@ void World::initNodes() {
       exit(-1);
     }
 
-    //
-    // slower but simpler neighbours search
-    //
-
-    bool slowButSure = false;
-    if (slowButSure) {
-      for (auto currentNodeIt = vectNodes.begin(); currentNodeIt != vectNodes.end(); currentNodeIt++) {
-        counter++;
-        //neighboursFile << (*currentNodeIt)->getId() << " ";
-        fprintf(neighboursFile,"%d ", (*currentNodeIt)->getId());
-        for (auto it = vectNodes.begin(); it != vectNodes.end(); it++) {
-          distance = (*currentNodeIt)->distance(*it);
-          if (currentNodeIt != it && distance <= ScenarioParameters::getCommunicationRange() ) {
-            (*currentNodeIt)->addNeighbour(distance,*it);
-            //neighboursFile << distance << " " << (*it)->getId() << " ";
-            fprintf(neighboursFile,"%d ",  (*it)->getId() );
-          }
-        }
-        //neighboursFile << endl;
-        fprintf(neighboursFile,"\n");
-      }
-      cout << "  " << counter << " nodes processed" << endl;
-    } else {
-      int xs = (int)ceil(ScenarioParameters::getWorldXSize() / ScenarioParameters::getCommunicationRange() ) + 1;
-      if (xs == 0) xs = 1;
-      int ys = (int)ceil(ScenarioParameters::getWorldYSize() / ScenarioParameters::getCommunicationRange() ) + 1;
-      if (ys == 0) ys = 1;
-      int zs = (int)ceil(ScenarioParameters::getWorldZSize() / ScenarioParameters::getCommunicationRange() ) + 1;
-      if (zs == 0) zs = 1;
-
-      int xn, yn, zn;
-      vector<Node*> ***ptr3D=NULL;
-      ptr3D=new vector<Node*>**[xs];
-
-      for(int i=0; i<xs; i++) {
-        ptr3D[i] = new vector<Node*>*[ys];
-        for(int j=0; j<ys; j++)
-          ptr3D[i][j] = new vector<Node*>[zs];
-      }
+    buildNeighboursLists(neighboursFile, ScenarioParameters::getCommunicationRange() + getNeighboursSkin());
+    fclose(neighboursFile);
+  }
+  // vectNodes[3]->drawLocalView(2000000000, 2200000000);
+  // vectNodes[2]->drawLocalView(2000000000, 2200000000);
+}
 
-      cout << "  fast neighbours search grid size: "<< xs << " " << ys << " " << zs << endl;
-      for (auto currentNodeIt = vectNodes.begin(); currentNodeIt != vectNodes.end(); currentNodeIt++) {
-        xn = (int)floor( (*currentNodeIt)->getXPos() / (ScenarioParameters::getCommunicationRange()) );
-        yn = (int)floor( (*currentNodeIt)->getYPos() / (ScenarioParameters::getCommunicationRange()) );
-        zn = (int)floor( (*currentNodeIt)->getZPos() / (ScenarioParameters::getCommunicationRange()) );
-
-        if (xn > xs || yn > ys || zn > zs) {
-          cout << "*** ERROR ** invalid coordinates: (" <<
-            (*currentNodeIt)->getXPos() << "," <<
-            (*currentNodeIt)->getYPos() << "," <<
-            (*currentNodeIt)->getZPos() << ") in World size: (" <<
-            ScenarioParameters::getWorldXSize() << "," <<
-            ScenarioParameters::getWorldYSize() << "," <<
-            ScenarioParameters::getWorldZSize() << ")\n";
-          exit(EXIT_FAILURE);
-        }
+// Builds the neighbours lists of all the nodes on several threads, with the
+// nodes closer than _radius.  Nodes are handled by blocks taken in turn by
+// the threads, each block filling its own buffers; completed blocks are then
+// appended in node order to the neighbour table and to the neighbours file
+// (if any), so that both, and the order in which receptions are scheduled,
+// do not depend on the number of threads.
+void World::buildNeighboursLists(FILE *_neighboursFile, distance_t _radius) {
+  typedef struct {
+    vector<neighbour_t> neighbours;
+    vector<int> counts;
+    string text;
+  } neighboursBlock_t;
+
+  const size_t blockSize = 1024;
+  distance_t range = _radius;
+  bool writeFile = _neighboursFile != nullptr;  // the first build, the others being done for mobility
+
+  int xs = (int)ceil(ScenarioParameters::getWorldXSize() / range ) + 1;
+  if (xs == 0) xs = 1;
+  int ys = (int)ceil(ScenarioParameters::getWorldYSize() / range ) + 1;
+  if (ys == 0) ys = 1;
+  int zs = (int)ceil(ScenarioParameters::getWorldZSize() / range ) + 1;
+  if (zs == 0) zs = 1;
+
+  // flat grid: the nodes of a cell are contiguous in cellNodes, in vectNodes order
+  size_t nodesCount = vectNodes.size();
+  vector<size_t> nodeCell(nodesCount);
+  vector<size_t> cellStart((size_t)xs * ys * zs + 1, 0);
+  vector<Node*> cellNodes(nodesCount);
+
+  if (writeFile)
+    cout << "  fast neighbours search grid size: "<< xs << " " << ys << " " << zs << endl;
+  for (size_t i = 0; i < nodesCount; i++) {
+    Node *node = vectNodes[i];
+    int xn = (int)floor( node->getXPos() / range );
+    int yn = (int)floor( node->getYPos() / range );
+    int zn = (int)floor( node->getZPos() / range );
+
+    if (xn < 0 || yn < 0 || zn < 0 || xn >= xs || yn >= ys || zn >= zs) {
+      cout << "*** ERROR ** invalid coordinates: (" <<
+        node->getXPos() << "," <<
+        node->getYPos() << "," <<
+        node->getZPos() << ") in World size: (" <<
+        ScenarioParameters::getWorldXSize() << "," <<
+        ScenarioParameters::getWorldYSize() << "," <<
+        ScenarioParameters::getWorldZSize() << ")\n";
+      exit(EXIT_FAILURE);
+    }
+    nodeCell[i] = ((size_t)xn * ys + yn) * zs + zn;
+    cellStart[nodeCell[i] + 1]++;
+  }
+  for (size_t c = 1; c < cellStart.size(); c++) {
+    cellStart[c] += cellStart[c - 1];
+  }
+  vector<size_t> cellFill(cellStart.begin(), cellStart.end() - 1);
+  for (size_t i = 0; i < nodesCount; i++) {
+    cellNodes[cellFill[nodeCell[i]]++] = vectNodes[i];
+  }
 
-        ptr3D[xn][yn][zn].push_back((*currentNodeIt));
+  // same scan order as the grid of sendPacketToNeighbours, then sorted by
+  // distance, equal distances keeping the scan order
+  auto processBlock = [&](size_t _first, neighboursBlock_t &_block) {
+    char number[48];
+    size_t last = min(_first + blockSize, nodesCount);
+    for (size_t i = _first; i < last; i++) {
+      Node *node = vectNodes[i];
+      size_t begin = _block.neighbours.size();
+      if (writeFile) {
+        snprintf(number, sizeof(number), "%d ", node->getId());
+        _block.text += number;
       }
 
-      for (auto currentNodeIt = vectNodes.begin(); currentNodeIt != vectNodes.end(); currentNodeIt++) {
-        counter++;
-        //neighboursFile << (*currentNodeIt)->getId() << " ";
-        fprintf(neighboursFile,"%d ", (*currentNodeIt)->getId());
-
-        xn = (int)floor((*currentNodeIt)->getXPos() / (ScenarioParameters::getCommunicationRange()) );
-        yn = (int)floor((*currentNodeIt)->getYPos() / (ScenarioParameters::getCommunicationRange()) );
-        zn = (int)floor((*currentNodeIt)->getZPos() / (ScenarioParameters::getCommunicationRange()) );
-
-        for (int d=xn-1; d<=xn+1; d++) {
-          for (int e=yn-1; e<=yn+1; e++) {
-            for (int f=zn-1; f<=zn+1; f++) {
-              if (d >= 0 && d < xs && e >= 0 && e < ys && f >= 0 && f < zs) {
-                for (auto it = ptr3D[d][e][f].begin(); it != ptr3D[d][e][f].end(); it++) {
-                  distance = (*currentNodeIt)->distance(*it);
-                  if ((*currentNodeIt)->getId() != (*it)->getId() && distance <= ScenarioParameters::getCommunicationRange() ) {
-                    (*currentNodeIt)->addNeighbour(distance,*it);
-                    //neighboursFile << distance << " " << (*it)->getId() << " ";
-                    fprintf(neighboursFile, "%ld %d ", distance, (*it)->getId());
+      int xn = (int)floor( node->getXPos() / range );
+      int yn = (int)floor( node->getYPos() / range );
+      int zn = (int)floor( node->getZPos() / range );
+      for (int d=xn-1; d<=xn+1; d++) {
+        for (int e=yn-1; e<=yn+1; e++) {
+          for (int f=zn-1; f<=zn+1; f++) {
+            if (d >= 0 && d < xs && e >= 0 && e < ys && f >= 0 && f < zs) {
+              size_t cell = ((size_t)d * ys + e) * zs + f;
+              for (size_t k = cellStart[cell]; k < cellStart[cell + 1]; k++) {
+                Node *other = cellNodes[k];
+                distance_t distance = node->distance(other);
+                if (node->getId() != other->getId() && distance <= range) {
+                  _block.neighbours.push_back({ distance, other });
+                  if (writeFile) {
+                    snprintf(number, sizeof(number), "%ld %d ", distance, other->getId());
+                    _block.text += number;
                   }
                 }
               }
             }
           }
         }
-        //neighboursFile << endl;
-        fprintf(neighboursFile,"\n");
       }
+      if (writeFile)
+        _block.text += "\n";
+      stable_sort(_block.neighbours.begin() + begin, _block.neighbours.end(),
+        [](const neighbour_t &_a, const neighbour_t &_b) { return _a.distance < _b.distance; });
+      _block.counts.push_back((int)(_block.neighbours.size() - begin));
+    }
+  };
 
-      cout << "  " << counter << " nodes processed" << endl;
+  int threads = ScenarioParameters::getNeighboursThreads();
+  if (threads <= 0) {
+    threads = max(1u, thread::hardware_concurrency());
+  }
+
+  // blocks are built by rounds, to bound the memory used by pending text
+  size_t blocksCount = (nodesCount + blockSize - 1) / blockSize;
+  size_t roundBlocks = 8 * threads;
+  vector<size_t> nodeOffset(nodesCount);
+  neighbourTable.clear();
+
+  for (size_t firstBlock = 0; firstBlock < blocksCount; firstBlock += roundBlocks) {
+    size_t lastBlock = min(firstBlock + roundBlocks, blocksCount);
+    vector<neighboursBlock_t> blocks(lastBlock - firstBlock);
+    atomic<size_t> nextBlock(firstBlock);
+
+    auto worker = [&]() {
+      size_t b;
+      while ((b = nextBlock++) < lastBlock) {
+        processBlock(b * blockSize, blocks[b - firstBlock]);
+      }
+    };
+    vector<thread> pool;
+    for (int t = 1; t < threads; t++) {
+      pool.push_back(thread(worker));
+    }
+    worker();
+    for (auto &t : pool) {
+      t.join();
+    }
 
-      for(int i=0; i<xs; i++) {
-        for(int j=0; j<ys; j++)
-          delete[] ptr3D[i][j];
-        delete[] ptr3D[i];
+    for (size_t b = firstBlock; b < lastBlock; b++) {
+      neighboursBlock_t &block = blocks[b - firstBlock];
+      if (writeFile)
+        fwrite(block.text.data(), 1, block.text.size(), _neighboursFile);
+      size_t offset = neighbourTable.size();
+      for (size_t k = 0; k < block.counts.size(); k++) {
+        nodeOffset[b * blockSize + k] = offset;
+        offset += block.counts[k];
       }
-      delete ptr3D;
+      neighbourTable.insert(neighbourTable.end(), block.neighbours.begin(), block.neighbours.end());
     }
   }
-  // vectNodes[3]->drawLocalView(2000000000, 2200000000);
-  // vectNodes[2]->drawLocalView(2000000000, 2200000000);
+
+  // the table does not move any more
+  for (size_t i = 0; i < nodesCount; i++) {
+    size_t end = (i + 1 < nodesCount) ? nodeOffset[i + 1] : neighbourTable.size();
+    vectNodes[i]->setNeighbours(neighbourTable.data() + nodeOffset[i], (int)(end - nodeOffset[i]));
+  }
+
+  if (ScenarioParameters::getLinkShadowing() && ScenarioParameters::getCommunicationRangeStandardDeviation() != 0) {
+    linkShadowingTable.assign(neighbourTable.size(), 0);
+    linkShadowingEpochs.assign(nodesCount, -1);
+  }
+
+  if (writeFile)
+    cout << "  " << nodesCount << " nodes processed" << endl;
 }
 
 void World::printWorldInfo () {
@@ -397,12 +466,14 @@ void World::printWorldInfo () {
 void World::initAgents() {
   // TODO : Initialise only the agent used
 
+  SLRCoordinatesCache::initialize();
   ManualRoutingAgent::initializeAgent();
   SLRRoutingAgent::initializeAgent();
   SLRRingRoutingAgent::initializeAgent();
   SLRBackoffRoutingAgent::initializeAgent();
   SLRBackoffRoutingAgent3::initializeAgent();
   CBRApplicationAgent::initializeAgent();
+  TraceApplicationAgent::initializeAgent();
   //D1DensityEstimatorAgent::initialize();
   D11DensityEstimatorAgent::initialize();
   D2DensityEstimatorAgent::initializeAgent();
@@ -412,6 +483,7 @@ void World::initAgents() {
   BackoffFloodingRingRoutingAgent::initializeAgent();
   IncidentObserverAgent::initializeAgent();
   GatewayServerAgent::initializeAgent();
+  IntervalLog::initialize();
 }
 
 void World::initSDL() {
@@ -465,94 +537,99 @@ void World::visualizationLoop(World *world) {
   bool programrunning = true;
   simulationTime_t now;
   simulationTime_t before = 0;
+  unsigned int lastFrame = SDL_GetTicks();
+
+  // the ring is drained often so that it does not overflow, but a frame shows
+  // only the last event of each node since the previous frame
+  const int drainPeriod = 20;    // ms
+  const unsigned int framePeriod = 500;  // ms
+  vector<int> frameSlot(world->vectNodes.size(), -1);
+  vector<drawRecord_t> frameRecords;
 
   while (programrunning) {
-    SDL_WaitEventTimeout(&evt,500);
-    if ((evt.type == SDL_KEYDOWN && evt.key.keysym.sym == SDLK_q && evt.key.keysym.mod && KMOD_LCTRL != 0)
-        || evt.type == SDL_QUIT
+    bool hasEvent = SDL_WaitEventTimeout(&evt, drainPeriod) == 1;
+    if ((hasEvent && evt.type == SDL_KEYDOWN && evt.key.keysym.sym == SDLK_q && evt.key.keysym.mod && KMOD_LCTRL != 0)
+        || (hasEvent && evt.type == SDL_QUIT)
         || endVisualization) {
       programrunning = false;
     }
 
+    world->drawRing.drain([&](const drawRecord_t &record) {
+      if (frameSlot[record.nodeId] < 0) {
+        frameSlot[record.nodeId] = frameRecords.size();
+        frameRecords.push_back(record);
+      } else {
+        frameRecords[frameSlot[record.nodeId]] = record;
+      }
+    });
+
+    if (SDL_GetTicks() - lastFrame < framePeriod) {
+      continue;
+    }
+    lastFrame = SDL_GetTicks();
+
     now = Scheduler::now();
     if (now != before) {
-      multimap<simulationTime_t, PointInfo>::iterator first;
       SDL_SetRenderDrawColor( DisplayProperties::renderer, 0, 0, 0, 255 );
       SDL_RenderClear( DisplayProperties::renderer );
 
-      //         while ( (first=world->toDrawPointInfoMap.begin()) != world->toDrawPointInfoMap.end() && first->first < (now - 10000)) {
-      //          world->toDrawPointInfoMap.erase(first);
-      //         }
-      world->toDrawPointInfoMap.clear();
-
-      world->mutexVisualization.lock();
-
-      for (auto it=world->vectPointInfo.begin(); it!=world->vectPointInfo.end(); it++) {
-        //if (it->date >= (now-10000)) {
-        world->toDrawPointInfoMap.insert(pair<simulationTime_t, PointInfo>(it->date, *it));
-        //}
-      }
-      world->vectPointInfo.clear();
-      world->mutexVisualization.unlock();
-
-      //         while ( (first=world->toDrawPointInfoMap.begin()) != world->toDrawPointInfoMap.end() && first->first < (now - 10000)) {
-      //          world->toDrawPointInfoMap.erase(first);
-      //         }
-
-      for (auto it=world->toDrawPointInfoMap.begin(); it!=world->toDrawPointInfoMap.end(); it++ ) {
-        // //SDL_SetRenderDrawColor(DisplayProperties::renderer, r, g, b, 255);
-        // //SDL_RenderDrawPoint(DisplayProperties::renderer,x,y);
-        filledCircleRGBA(DisplayProperties::renderer, it->second.x, it->second.y, (short int)(1*DisplayProperties::nodeZoom), it->second.r, it->second.g, it->second.b, 255);
+      for (auto it=frameRecords.begin(); it!=frameRecords.end(); it++ ) {
+        unsigned char r,g,b;
+        switch (it->type) {
+        case DrawingType::SEND:
+          r=0;
+          g=0;
+          b=255;
+          break;
+        case DrawingType::RECEIVE:
+          r=255;
+          g=0;
+          b=0;
+          break;
+        case DrawingType::COLLISION:
+          r=0;
+          g=255;
+          b=0;
+          break;
+        case DrawingType::IGNORE:
+          r=255;
+          g=255;
+          b=0;
+          break;
+        default:  // OTHER
+          r=255;
+          g=255;
+          b=255;
+          break;
+        }
+        filledCircleRGBA(DisplayProperties::renderer, it->x, it->y, (short int)(1*DisplayProperties::nodeZoom), r, g, b, 255);
+        frameSlot[it->nodeId] = -1;
       }
+      frameRecords.clear();
 
       SDL_RenderPresent(DisplayProperties::renderer);
     }
     before = now;
   }
+  if (world->drawRing.getDropped() > 0) {
+    cout << "*** WARNING *** " << world->drawRing.getDropped() << " draw events dropped, the display could not keep up with the simulation" << endl;
+  }
   Scheduler::endSimulation();
 }
 
 
+// called on the simulation thread: only computes the position and queues it
 void World::drawNode(int _id,  DrawingType _type) {
   //if ( Scheduler::now() < 100000000000000 ) return;
-  unsigned char r,g,b;
-  switch (_type) {
-  case DrawingType::SEND:
-    r=0;
-    g=0;
-    b=255;
-    break;
-  case DrawingType::RECEIVE:
-    r=255;
-    g=0;
-    b=0;
-    break;
-  case DrawingType::COLLISION:
-    r=0;
-    g=255;
-    b=0;
-    break;
-  case DrawingType::IGNORE:
-    r=255;
-    g=255;
-    b=0;
-    break;
-  default:  // OTHER
-    r=255;
-    g=255;
-    b=255;
-    break;
-  }
-  short int x = (short int)((double)myWorld->vectNodes[_id]->getXPos() / DisplayProperties::zoom);
-  short int y = (short int)((double)myWorld->vectNodes[_id]->getZPos() / DisplayProperties::zoom);
-
-  myWorld->mutexVisualization.lock();
-  myWorld->vectPointInfo.push_back(PointInfo(x, y, r, g, b,Scheduler::now()));
-  myWorld->mutexVisualization.unlock();
+  drawRecord_t record;
+  record.nodeId = _id;
+  record.x = (short int)((double)myWorld->vectNodes[_id]->getXPos() / DisplayProperties::zoom);
+  record.y = (short int)((double)myWorld->vectNodes[_id]->getZPos() / DisplayProperties::zoom);
+  record.type = _type;
+  myWorld->drawRing.push(record);
 }
 
 void World::sendPacketToNeighbours(Node *_srcNode, PacketPtr _p, simulationTime_t _delayBeforeTransmission) {
-  distance_t distance;
   simulationTime_t receptionTime;
 
   distance_t communicationRange, effectiveCommunicationRange;
@@ -565,6 +642,57 @@ void World::sendPacketToNeighbours(Node *_srcNode, PacketPtr _p, simulationTime_
   }
 
   distance_t standardDeviation = ScenarioParameters::getCommunicationRangeStandardDeviation();
+  CounterRNG shadowingRNG = _srcNode->getShadowingRNG(shadowingRNGSeed);
+  bool linkShadowing = ScenarioParameters::getLinkShadowing();
+  long epoch = getShadowingEpoch();
+
+  // sleeping nodes, see Node::processStartSendEvent
+  bool sleeping = SleepingNode::hasAwakeWindows();
+  simulationTime_t ts = 0, sendPhase = 0;
+  if (sleeping) {
+    ts = SleepingNode::getPeriod();
+    sendPhase = (Scheduler::now() + _delayBeforeTransmission) % ts;
+  }
+
+  auto reach = [&](Node *_other, distance_t _distance) {
+    if (standardDeviation == 0)
+      effectiveCommunicationRange = communicationRange;
+    else if (linkShadowing) {
+      // only the links between range - 6 sigma and range depend on the deviation
+      if (_distance <= communicationRange - standardDeviation*6 || _distance > communicationRange)
+        effectiveCommunicationRange = communicationRange;
+      else
+        effectiveCommunicationRange = communicationRange + drawLinkShadowing(_srcNode->getId(), _other->getId(), epoch);
+      if (effectiveCommunicationRange < 0) effectiveCommunicationRange = 0;
+    } else {
+      // no value cached by the distribution from another node stream
+      shadowingCommunicationRangeDistribution.reset();
+      distance_t shadowingRange = shadowingCommunicationRangeDistribution(shadowingRNG);
+      if ( shadowingRange > standardDeviation*3 ) shadowingRange=standardDeviation*3;
+      if ( shadowingRange < -standardDeviation*3 ) shadowingRange=-standardDeviation*3;
+      effectiveCommunicationRange = communicationRange - standardDeviation*3 + shadowingRange;
+      if (effectiveCommunicationRange < 0) effectiveCommunicationRange = 0;
+    }
+
+    if ((_p->type != PacketType::SLR_BEACON &&_srcNode->getId() != _other->getId() && _distance <= effectiveCommunicationRange)
+        || (_p->type == PacketType::SLR_BEACON && _distance <= ScenarioParameters::getCommunicationRangeSmall())) {
+      receptionTime = Scheduler::now() + _delayBeforeTransmission + _distance/PROPAGATIONSPEED;
+      simulationTime_t phase = sendPhase + _distance/PROPAGATIONSPEED;
+      if (sleeping && phase >= ts) phase %= ts;
+      if (!sleeping || SleepingNode::isAwakeInPhase(_other->getId(), phase)) {
+        //PacketPtr packetClone = PacketPtr(new Packet(_p));
+        PacketPtr packetClone = PacketPtr(_p->clone());
+        Scheduler::getScheduler().schedule(new StartReceivePacketEvent(receptionTime, _other, packetClone));
+      }
+    }
+  };
+
+  // moving nodes leave their cell of the grid, the spatial index follows them
+  if (mobility != nullptr) {
+    distance_t radius = (_p->type == PacketType::SLR_BEACON) ? ScenarioParameters::getCommunicationRangeSmall() : communicationRange;
+    spatialIndex.forEachInRadius(_srcNode->getXPos(), _srcNode->getYPos(), _srcNode->getZPos(), radius, reach);
+    return;
+  }
 
   int xn, yn, zn;
   xn = (int)floor(_srcNode->getXPos() / (ScenarioParameters::getCommunicationRange()) );
@@ -576,27 +704,7 @@ void World::sendPacketToNeighbours(Node *_srcNode, PacketPtr _p, simulationTime_
       for (int f=zn-1; f<=zn+1; f++) {
         if (d >= 0 && d < gridXSize && e >= 0 && e < gridYSize && f >= 0 && f < gridZSize) {
           for (auto it = ptrNodes3D[d][e][f].begin(); it != ptrNodes3D[d][e][f].end(); it++) {
-            distance = _srcNode->distance(*it);
-
-            if (standardDeviation == 0)
-              effectiveCommunicationRange = communicationRange;
-            else {
-              distance_t shadowingRange = shadowingCommunicationRangeDistribution(*shadowingCommunicationRangeRandomGenerator);
-              if ( shadowingRange > standardDeviation*3 ) shadowingRange=standardDeviation*3;
-              if ( shadowingRange < -standardDeviation*3 ) shadowingRange=-standardDeviation*3;
-              effectiveCommunicationRange = communicationRange - standardDeviation*3 + shadowingRange;
-              if (effectiveCommunicationRange < 0) effectiveCommunicationRange = 0;
-            }
-
-            if ((_p->type != PacketType::SLR_BEACON &&_srcNode->getId() != (*it)->getId() && distance <= effectiveCommunicationRange)
-                || (_p->type == PacketType::SLR_BEACON && distance <= ScenarioParameters::getCommunicationRangeSmall())) {
-              receptionTime = Scheduler::now() + _delayBeforeTransmission + distance/PROPAGATIONSPEED;
-              if ((*it)->isAwake (receptionTime)) {
-                //PacketPtr packetClone = PacketPtr(new Packet(_p));
-                PacketPtr packetClone = PacketPtr(_p->clone());
-                Scheduler::getScheduler().schedule(new StartReceivePacketEvent(receptionTime, *it, packetClone));
-              }
-            }
+            reach(*it, _srcNode->distance(*it));
           }
         }
       }
@@ -604,48 +712,80 @@ void World::sendPacketToNeighbours(Node *_srcNode, PacketPtr _p, simulationTime_
   }
 }
 
-void World::foreachNodeNear(distance_t fx, distance_t fy, distance_t fz,
-  distance_t distance, std::function<void(Node*)> operation) {
+// Moves the nodes to their positions at the start of the current update
+// interval of the mobility.  The spatial index and the neighbours lists are
+// not rebuilt at each move: the lists hold the nodes closer than the range
+// plus a skin, and the index widens its queries by the drift of the nodes,
+// so both remain valid until a node has moved more than half the skin since
+// they were built (Verlet lists).
+void World::updatePositions() {
+  if (mobility == nullptr) return;
+  simulationTime_t interval = mobility->getUpdateInterval();
+  simulationTime_t date = Scheduler::now() / interval * interval;
+  if (date == positionsDate) return;
+  positionsDate = date;
+
+  mobility->moveTo(date);
+  if (spatialIndex.update() > mobility->getSkin() / 2) {
+    spatialIndex.build(vectNodes, ScenarioParameters::getCommunicationRange());
+    if (!ScenarioParameters::getDoNotUseNeighboursList())
+      buildNeighboursLists(nullptr, ScenarioParameters::getCommunicationRange() + mobility->getSkin());
+  }
+}
+
+// the nodes currently in range of _node, when the nodes move
+int World::countNeighbours(Node *_node) {
+  updatePositions();
+  int count = 0;
+  spatialIndex.forEachInRadius(_node->getXPos(), _node->getYPos(), _node->getZPos(), _node->getCommunicationRange(),
+    [&](Node *_other, distance_t) { if (_other != _node) count++; });
+  return count;
+}
 
-  // okay, we can't use the lookup
-  if (ptrNodes3D == nullptr) {
-    // well, test each node separately
-    for (Node* node : vectNodes) {
-      if (node->distance(fx, fy, fz) <= distance) {
-        operation(node);
-      }
+long World::getShadowingEpoch() {
+  simulationTime_t coherenceTime = ScenarioParameters::getShadowingCoherenceTime();
+  return coherenceTime > 0 ? Scheduler::now() / coherenceTime : 0;
+}
+
+// Deviation of the communication range of the link between _a and _b during
+// _epoch, in [-6 sigma, 0] like the per transmission draw.  It comes from the
+// counter of the link, so both ends get the same value, in any draw order.
+distance_t World::drawLinkShadowing(int _a, int _b, long _epoch) {
+  distance_t standardDeviation = ScenarioParameters::getCommunicationRangeStandardDeviation();
+  uint64_t draws = 2 * (uint64_t)max(_a, _b);
+  CounterRNG linkRNG(((uint64_t)_epoch << 32) | (uint32_t)shadowingRNGSeed, min(_a, _b), RNGPurpose::LINK_SHADOWING, draws);
+
+  // Box-Muller, which uses exactly the two draws of the link
+  double u1 = ((linkRNG() >> 11) + 0.5) / 9007199254740992.0;
+  double u2 = (linkRNG() >> 11) / 9007199254740992.0;
+  distance_t shadowingRange = sqrt(-2 * log(u1)) * cos(2 * M_PI * u2) * standardDeviation;
+  if ( shadowingRange > standardDeviation*3 ) shadowingRange=standardDeviation*3;
+  if ( shadowingRange < -standardDeviation*3 ) shadowingRange=-standardDeviation*3;
+  return shadowingRange - standardDeviation*3;
+}
+
+// the deviations of the neighbours of _node, drawn again if its coherence time elapsed
+const distance_t *World::getLinkShadowing(Node *_node, const neighbour_t *_neighbours, int _count) {
+  size_t first = _neighbours - neighbourTable.data();
+  long epoch = getShadowingEpoch();
+  if (linkShadowingEpochs[_node->getId()] != epoch) {
+    for (int i = 0; i < _count; i++) {
+      linkShadowingTable[first + i] = drawLinkShadowing(_node->getId(), _neighbours[i].node->getId(), epoch);
     }
-  } else{
-    // each grid cell is ScenarioParam
-    double cellSize = ScenarioParameters::getCommunicationRange();
-
-    int xs = (int)ceil(ScenarioParameters::getWorldXSize() / ScenarioParameters::getCommunicationRange() ) + 1;
-    int ys = (int)ceil(ScenarioParameters::getWorldYSize() / ScenarioParameters::getCommunicationRange() ) + 1;
-    int zs = (int)ceil(ScenarioParameters::getWorldZSize() / ScenarioParameters::getCommunicationRange() ) + 1;
-
-    // get the number of cells to check.
-    int length = std::ceil(distance / cellSize);
-
-    int xStart = std::max(std::floor(fx / cellSize) - length, 0.0);
-    int xEnd = std::min(xStart + 2 * length + 1, xs);
-    int yStart = std::max(std::floor(fy / cellSize) - length, 0.0);
-    int yEnd = std::min(yStart + 2 * length + 1, ys);
-    int zStart = std::max(std::floor(fz / cellSize) - length, 0.0);
-    int zEnd = std::min(zStart + 2 * length + 1, zs);
-
-    for (int x = xStart; x <= xEnd; x++)
-      for (int y = yStart; y <= yEnd; y++)
-        for (int z = zStart; z <= zEnd; z++)
-          for (Node* node : ptrNodes3D[x][y][z])
-            if (node->distance(fx, fy, fz) <= distance)
-              operation(node);
+    linkShadowingEpochs[_node->getId()] = epoch;
   }
+  return linkShadowingTable.data() + first;
 }
 
 void World::destroyWorld() {
   cout << "Destroying World ..." << endl;
+  if (Node::getOverflowDrops() > 0)
+    cout << "  " << Node::getOverflowDrops() << " packets dropped by full output buffers" << endl;
   for (auto it=vectNodes.begin(); it!=vectNodes.end(); it++)
     delete *it;
+  IntervalLog::close();
+  LogSystem::closeLogSystem();
+  SLRCoordinatesCache::save();
   if (ScenarioParameters::getGraphicMode() )
     endVisualization = true;
 }
@@ -26,8 +26,13 @@
 
 #include <functional>
 #include <mutex>
+#include <thread>
+#include <atomic>
 #include "utils.h"
 #include "node.h"
+#include "spsc-ring.h"
+#include "spatial-index.h"
+#include "mobility.h"
 
 enum class DrawingType {
   RECEIVE,
@@ -37,21 +42,12 @@ enum class DrawingType {
   OTHER
 };
 
-class PointInfo {
-public:
-  short int x,y;
-  unsigned char r,g,b;
-  simulationTime_t date;
-
-  PointInfo(short int _x, short int _y, unsigned char _r, unsigned char _g, unsigned char _b, simulationTime_t _date) {
-    x = _x;
-    y = _y;
-    r = _r;
-    g = _g;
-    b = _b;
-    date = _date;
-  }
-};
+// one event to draw, handed from the simulation thread to the SDL thread
+typedef struct {
+  int nodeId;
+  short int x, y;
+  DrawingType type;
+} drawRecord_t;
 
 //==============================================================================
 //
@@ -65,19 +61,34 @@ private:
   distance_t sizeX, sizeY, sizeZ;
 
   vector<Node*> vectNodes;
+  // neighbours lists of all the nodes, one slice per node
+  vector<neighbour_t> neighbourTable;
+  // --linkShadowing: deviation of the communication range of each entry of
+  // the neighbour table, redrawn when the coherence time of its node elapses
+  vector<distance_t> linkShadowingTable;
+  vector<long> linkShadowingEpochs;  // per node, -1 before the first draw
 
   // grid that can be used instead of neighbours list in each Node
   vector<Node*> ***ptrNodes3D;
   int gridXSize, gridYSize, gridZSize;
 
-  multimap<simulationTime_t, PointInfo> pointInfoMap;
-  vector<PointInfo> vectPointInfo;
-  vector<PointInfo> toDrawVectPointInfo;
-  multimap<simulationTime_t, PointInfo> toDrawPointInfoMap;
-  mutex mutexVisualization;
+  // positions of all the nodes, for the spatial queries, whatever the neighbours mode
+  SpatialIndex spatialIndex;
+
+  // nullptr when the nodes do not move
+  MobilityModel *mobility;
+  simulationTime_t positionsDate;  // date of the current positions, -1 before the first update
+
+  // graphic mode: the simulation thread never waits for the SDL thread, a
+  // draw event is dropped when the ring is full
+  static const size_t drawRingCapacity = 1 << 16;
+  SPSCRing<drawRecord_t> drawRing;
   bool endVisualization;
 
-  static mt19937_64 *shadowingCommunicationRangeRandomGenerator;
+  void buildNeighboursLists(FILE *_neighboursFile, distance_t _radius);
+
+  // shadowing draws come from the stream of the sending node
+  static const int shadowingRNGSeed = 42;
   static normal_distribution<double> shadowingCommunicationRangeDistribution;
   World();
 
@@ -97,8 +108,21 @@ public:
   void visualizationLoop(World *_world);
   void sendPacketToNeighbours(Node *_srcNode, PacketPtr _p, simulationTime_t _delayBeforeTransmission);
 
-  void foreachNodeNear(distance_t x, distance_t y, distance_t z,
-    distance_t distance, std::function<void(Node*)> operation);
+  bool isMobile() { return mobility != nullptr; }
+  void updatePositions();
+  // margin of the neighbours lists beyond the communication range
+  distance_t getNeighboursSkin() { return mobility != nullptr ? mobility->getSkin() : 0; }
+  int countNeighbours(Node *_node);
+
+  static long getShadowingEpoch();
+  static distance_t drawLinkShadowing(int _a, int _b, long _epoch);
+  const distance_t *getLinkShadowing(Node *_node, const neighbour_t *_neighbours, int _count);
+
+  static const SpatialIndex &getSpatialIndex() { return myWorld->spatialIndex; }
+  template<typename Operation>
+  void foreachNodeNear(distance_t x, distance_t y, distance_t z, distance_t distance, Operation &&operation) {
+    spatialIndex.forEachInRadius(x, y, z, distance, [&](Node *node, distance_t) { operation(node); });
+  }
 
   void destroyWorld();
 };
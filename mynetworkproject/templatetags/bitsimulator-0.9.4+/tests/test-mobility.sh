@@ -0,0 +1,17 @@
+# same events with and without the neighbours lists when the nodes move;
+# simultaneous events may be logged in another order, hence the sort
+mkdir tests/test-mobility
+cd tests/test-mobility
+cp ../../$srcdir/tests/mobility/scenario.xml .
+../../bitsimulator
+LC_ALL=C sort results-events.log > list-events.log
+rm results-*.log
+../../bitsimulator --doNotUseNeighboursList
+LC_ALL=C sort results-events.log > nolist-events.log
+cmp list-events.log nolist-events.log
+ret=$?
+rm results-*.log list-events.log nolist-events.log
+rm -f scenario.xml
+cd ..
+rmdir test-mobility
+exit $ret